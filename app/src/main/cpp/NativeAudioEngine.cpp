@@ -1,13 +1,21 @@
 #include "NativeAudioEngine.h"
+#include "AnalysisWorkerPool.h"
+#include "CaptureFile.h"
+#include "EngineMetrics.h"
+#include "RealtimeAllocationGuard.h"
+#include "ResultMailbox.h"
+#include "TunerEngine.h"
 #include <oboe/Oboe.h>
 #include <android/log.h>
 #include <jni.h>
 #include <cmath>
-#include <limits>
-#include <numeric>
-#include <vector>
 #include <atomic>
 #include <algorithm> // Needed for std::min
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
 
 // --- Logging ---
 #define LOG_TAG "NativeAudioEngine"
@@ -16,422 +24,637 @@
 #define ALOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
 
 // --- Constants ---
-constexpr float MIN_VALID_FREQUENCY = 20.0f; // Hertz
-constexpr float MAX_EXPECTED_FREQUENCY = 2000.0f; // Hertz, upper bound for tauMin optimization
-// Further lowered RMS threshold to hold decaying notes longer
-constexpr float MIN_RMS_THRESHOLD = 0.004f; // Adjusted from 0.006f
-constexpr float CENTS_NOT_AVAILABLE = -1000.0f;
-constexpr int NOTE_INDEX_NOT_AVAILABLE = -1;
-constexpr int OCTAVE_NOT_AVAILABLE = -1;
-constexpr int MIDI_NOTE_A4 = 69;
-const float TWELFTH_ROOT_OF_TWO = powf(2.0f, 1.0f / 12.0f);
-// YIN Constants
-constexpr float YIN_DEFAULT_THRESHOLD = 0.15f;
+// Detection constants and the DSP pipeline live in dsp/ (afinador_dsp), shared with the host tools.
+
+// The capture is sized, locked and pre-faulted up front: 15 s of 48 kHz stereo plus its records is
+// about 6.4 MB, inside the usual 8 MB RLIMIT_MEMLOCK
+constexpr float MAX_CAPTURE_SECONDS = 15.0f;
+constexpr jsize MAX_MAILBOX_PAYLOAD_BYTES = 256;  // Largest payload readMailboxNative copies
+
+// Result delivery modes, selected at engine start (values mirror TunerViewModel)
+enum class ResultDelivery : int {
+    Callback = 0, // TunerViewModel.onNativeResult through JNI for every analysed window
+    Mailbox = 1   // Seqlock-protected ResultMailbox in a DirectByteBuffer, polled by the UI
+};
 
 // --- Global Variables ---
+// Only what every engine instance shares: the JVM and the analysis worker pool. Everything else
+// (stream, channel selection, A4, detector config, result sinks) belongs to a NativeEngine.
 using namespace oboe;
-static std::shared_ptr<oboe::AudioStream> gStream = nullptr;
-static std::atomic<float> gA4Freq(440.0f);
-static std::atomic<bool> isEngineRunning(false);
-
 static JavaVM* gJvm = nullptr;
-static jobject gJavaInstance = nullptr;
-
-
-// --- YIN Algorithm Implementation ---
-static void difference(const float* buffer, int size, int tau, std::vector<float>& yinBuffer) {
-    yinBuffer[tau] = 0;
-    for (int j = 0; j < size - tau; ++j) {
-        float delta = buffer[j] - buffer[j + tau];
-        yinBuffer[tau] += delta * delta;
-    }
-}
-static void cumulativeMeanNormalizedDifference(std::vector<float>& yinBuffer, int size) {
-    yinBuffer[0] = 1.0f;
-    float runningSum = 0.0f;
-    for (int tau = 1; tau < yinBuffer.size(); ++tau) {
-        runningSum += yinBuffer[tau];
-        // Avoid division by zero or very small numbers
-        yinBuffer[tau] = (runningSum > std::numeric_limits<float>::epsilon()) ?
-                         (yinBuffer[tau] * tau / runningSum) : 1.0f;
-    }
-}
-static int absoluteThreshold(const std::vector<float>& yinBuffer, float threshold, int tauMin) {
-    // Start search from tauMin
-    for (int tau = tauMin; tau < yinBuffer.size(); ++tau) {
-        if (yinBuffer[tau] < threshold) {
-            // Find the local minimum within this dip
-            while (tau + 1 < yinBuffer.size() && yinBuffer[tau + 1] < yinBuffer[tau]) {
-                tau++;
-            }
-            // Ensure the minimum is actually below the threshold
-            if(yinBuffer[tau] < threshold) return tau;
-            // If the minimum wasn't below threshold, continue searching for the next dip
-        }
+static std::mutex gPoolMutex; // Guards the two below, JNI threads only
+static std::unique_ptr<AnalysisWorkerPool> gWorkerPool; // Created with the first instance, joined with the last
+static int gEngineCount = 0;
+
+// Pool workers attach to the JVM once for their whole lifetime, so callback delivery never
+// attaches per result.
+static thread_local JNIEnv* tWorkerEnv = nullptr;
+
+static void attachWorkerToJvm() {
+    if (gJvm && gJvm->AttachCurrentThread(&tWorkerEnv, nullptr) != JNI_OK) {
+        ALOGE("Analysis worker failed to attach to the JVM."); // Keep error logs
+        tWorkerEnv = nullptr;
     }
-    return -1; // No pitch detected below the threshold within the valid range
 }
-static float parabolicInterpolation(const std::vector<float>& yinBuffer, int tauEstimate) {
-    if (tauEstimate <= 0 || tauEstimate >= yinBuffer.size() - 1) {
-        // Cannot interpolate at the edges
-        return static_cast<float>(tauEstimate);
-    }
-    float yMinus = yinBuffer[tauEstimate - 1];
-    float yCenter = yinBuffer[tauEstimate];
-    float yPlus = yinBuffer[tauEstimate + 1];
-    float denominator = yMinus + yPlus - 2.0f * yCenter;
-    if (std::abs(denominator) > std::numeric_limits<float>::epsilon()) {
-        // Corrected numerator (yMinus - yPlus)
-        float peakShift = (yMinus - yPlus) / (2.0f * denominator);
-        return tauEstimate + peakShift;
-    } else {
-        // Denominator is too small, return original estimate
-        return static_cast<float>(tauEstimate);
+
+static void detachWorkerFromJvm() {
+    if (tWorkerEnv) {
+        gJvm->DetachCurrentThread();
+        tWorkerEnv = nullptr;
     }
 }
-static float computeYIN(const float* audioBuffer, int bufferSize, int sampleRate) {
-    if (bufferSize <= 0 || sampleRate <= 0 || MIN_VALID_FREQUENCY <= 0) return 0.0f;
 
-    // Calculate tauMax based on the lowest frequency we want to detect
-    int calculatedTauMax = static_cast<int>(std::floor(static_cast<float>(sampleRate) / MIN_VALID_FREQUENCY));
-    // Ensure tauMax does not exceed buffer bounds
-    int practicalTauMax = std::min(calculatedTauMax, bufferSize / 2 - 1);
+static int64_t monotonicNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
 
-    // Minimum tau (period) corresponds to the highest frequency we might expect
-    int tauMin = static_cast<int>(std::floor(static_cast<float>(sampleRate) / MAX_EXPECTED_FREQUENCY));
-    tauMin = std::max(2, tauMin); // Ensure tau is at least 2
 
-    if (practicalTauMax <= tauMin) {
-        ALOGW("computeYIN: practicalTauMax (%d) <= tauMin (%d). Buffer might be too small for min freq. BufferSize: %d, SampleRate: %d",
-              practicalTauMax, tauMin, bufferSize, sampleRate);
-        return 0.0f; // Cannot perform YIN with this range
+// --- Engine Instance ---
+// One per handle (a jlong in Kotlin): its own Oboe stream, a TunerEngine with one lane per
+// analysed channel, and the sinks its lanes publish to. Lane i uses the i-th mailbox of each
+// mailbox buffer. The audio callback only splits the frames into the lanes' rings; the shared
+// worker pool does the analysis.
+class NativeEngine : public AudioStreamCallback, public AnalysisSink {
+public:
+    TunerEngine core;
+    std::shared_ptr<AudioStream> stream;
+    std::atomic<bool> running{false};
+    std::atomic<int32_t> streamError{0}; // Oboe Result of a stream error not yet handled, 0 = none
+    std::mutex analysisMutex; // Guards core.start/stop only, never taken on the audio thread
+
+    // Input capture for replays on a host: requested any time, opened when the stream starts and
+    // closed once it is closed, so the callback never sees it change
+    std::mutex captureMutex;          // Guards the two below, JNI threads only
+    std::string capturePath;          // Empty = no capture
+    float captureSeconds = 0.0f;
+    std::unique_ptr<CaptureWriter> capture;
+
+    jobject javaInstance = nullptr;
+    jmethodID onNativeResultMethod = nullptr; // Cached at start, valid while javaInstance is
+    ResultDelivery resultDelivery = ResultDelivery::Callback;
+    jobject resultBufferRef = nullptr;        // Keeps the mailbox DirectByteBuffer alive
+    ResultMailbox* resultMailboxes = nullptr; // One per lane
+    jobject strumBufferRef = nullptr;         // Keeps the strum mailbox DirectByteBuffer alive
+    StrumMailbox* strumMailboxes = nullptr;
+    jobject strobeBufferRef = nullptr;        // Keeps the strobe mailbox DirectByteBuffer alive
+    StrobeMailbox* strobeMailboxes = nullptr;
+
+    void startAnalysis() {
+        std::lock_guard<std::mutex> lock(analysisMutex);
+        core.start(*gWorkerPool, *this);
     }
 
-    std::vector<float> yinBuffer(practicalTauMax, 0.0f); // Use practicalTauMax for buffer size
-
-    // Step 2: Autocorrelation using difference function
-    for (int tau = tauMin; tau < practicalTauMax; ++tau) { // Start loop from tauMin
-        difference(audioBuffer, bufferSize, tau, yinBuffer);
+    // Must finish before the JNI references and mailboxes are released.
+    void stopAnalysis() {
+        std::lock_guard<std::mutex> lock(analysisMutex);
+        core.stop();
     }
 
-    // Step 3: Cumulative mean normalized difference (Apply only from tauMin)
-    yinBuffer[0] = 1.0f; // Should not be used, but initialize
-    float runningSum = 0.0f;
-    // Start normalization sum from the first calculated difference value (at tauMin)
-    for(int tau = tauMin; tau < practicalTauMax; ++tau) {
-        runningSum += yinBuffer[tau];
-        yinBuffer[tau] = (runningSum > std::numeric_limits<float>::epsilon()) ?
-                         (yinBuffer[tau] * tau / runningSum) : 1.0f;
-    }
-    // Values before tauMin are invalid, set to 1 (no dip)
-    for(int tau = 1; tau < tauMin; ++tau) {
-        if (tau < yinBuffer.size()) yinBuffer[tau] = 1.0f;
+    // --- Result Sinks (pool workers) ---
+    // Mailbox mode never touches JNI; callback mode goes through the worker's env and the cached
+    // method ID.
+    void onPitchResult(int lane, const PitchResult& result) override {
+        if (resultDelivery == ResultDelivery::Mailbox) {
+            if (resultMailboxes) {
+                resultMailboxes[lane].publish({result.noteIndex, result.octave, result.frequency, result.centsOffset,
+                                               result.confidence, result.rms, monotonicNanos()});
+            }
+        } else {
+            notifyNativeResult(lane, result.noteIndex, result.octave, result.centsOffset);
+        }
     }
 
-    // Step 4: Absolute thresholding (Search starts from tauMin)
-    int tauEstimate = absoluteThreshold(yinBuffer, YIN_DEFAULT_THRESHOLD, tauMin);
-
-    // Step 5 & 6: Parabolic interpolation (if threshold found)
-    float refinedTau = (tauEstimate != -1) ?
-                       parabolicInterpolation(yinBuffer, tauEstimate) : -1.0f;
-
-    if (refinedTau > 0.0f) {
-        float frequency = static_cast<float>(sampleRate) / refinedTau;
-        // Extra check: ensure the detected frequency is within our valid range
-        return (frequency >= MIN_VALID_FREQUENCY) ? frequency : 0.0f;
-    } else {
-        return 0.0f; // No reliable pitch detected
+    void onStrumResult(int lane, const StrumResult& result) override {
+        if (strumMailboxes) publishStrumToMailbox(strumMailboxes + lane, result, monotonicNanos());
     }
-}
-// --- End YIN ---
 
-// --- Helper: Calculate Frequency for MIDI Note ---
-static float calculateFrequencyForMidiNote(int midiNote, float a4Frequency) {
-    return a4Frequency * powf(TWELFTH_ROOT_OF_TWO, static_cast<float>(midiNote - MIDI_NOTE_A4));
-}
+    void onStrobeResult(int lane, const StrobeResult& result) override {
+        if (strobeMailboxes) publishStrobeToMailbox(strobeMailboxes + lane, result, monotonicNanos());
+    }
 
-// --- Helper: Get Note Info from Frequency ---
-struct DetectedNoteInfo {
-    int noteIndex = NOTE_INDEX_NOT_AVAILABLE;
-    int octave = OCTAVE_NOT_AVAILABLE;
-    int midiNote = -1;
-};
-static DetectedNoteInfo getNoteInfoFromFrequency(float frequency) {
-    DetectedNoteInfo info;
-    if (frequency < MIN_VALID_FREQUENCY) {
-        return info; // Below valid range
-    }
-    float a4 = gA4Freq.load(); // Use the current A4 reference
-    // Calculate the floating-point MIDI note number
-    float midiNoteFloat = 12.0f * log2f(frequency / a4) + static_cast<float>(MIDI_NOTE_A4);
-    int roundedMidiNote = static_cast<int>(roundf(midiNoteFloat));
-
-    if (roundedMidiNote >= 0) { // Basic validity check for MIDI note number
-        info.noteIndex = roundedMidiNote % 12;
-        info.octave = (roundedMidiNote / 12) - 1; // Standard octave calculation
-        info.midiNote = roundedMidiNote;
-    }
-    return info;
-}
+    // --- Oboe Audio Callback ---
+    DataCallbackResult onAudioReady(AudioStream* audioStream, void* audioData, int32_t numFrames) override {
+        ScopedRealtimeSection realtimeSection; // Debug builds count any allocation made below
 
-// --- JNI Callback Function ---
-static void notifyNativeResult(int noteIndex, int octave, float centsOffsetVsDetected) {
-    if (!gJvm || !gJavaInstance) {
-        // ALOGE removed for clean code, but keep in mind this is a potential issue point
-        return;
+        if (!audioStream || !running.load() || numFrames <= 0) {
+            return running.load() ? DataCallbackResult::Continue : DataCallbackResult::Stop;
+        }
+        // AAudio reads a counter here; OpenSL ES reports Unimplemented and leaves it unknown
+        ResultWithValue<int32_t> xRuns = audioStream->getXRunCount();
+        // Shared with capture replays: capture, hand-over to the lanes and timing
+        core.processCallback(static_cast<const float*>(audioData), numFrames, xRuns ? xRuns.value() : -1);
+        return DataCallbackResult::Continue;
     }
-    JNIEnv* env = nullptr;
-    jint attachResult = gJvm->AttachCurrentThread(&env, nullptr);
-    if (attachResult != JNI_OK || env == nullptr) {
-        // ALOGE removed
-        return;
+
+    // --- Error Callbacks ---
+    // Oboe's error thread only stops the callback and records the error: the stream, the analysis
+    // and the JNI references are released by the next stop, start or destroy, on the thread that
+    // makes every other call on this engine.
+    void onErrorBeforeClose(AudioStream* /*audioStream*/, Result error) override {
+        ALOGE("onErrorBeforeClose: %s", convertToText(error)); // Keep error logs
+        handleStreamError(error);
     }
 
-    jclass clazz = env->GetObjectClass(gJavaInstance);
-    if (!clazz) {
-        // ALOGE removed
-        if (env->ExceptionCheck()) { env->ExceptionDescribe(); env->ExceptionClear(); }
-        gJvm->DetachCurrentThread();
-        return;
+    void onErrorAfterClose(AudioStream* /*audioStream*/, Result error) override {
+        ALOGE("onErrorAfterClose: %s", convertToText(error)); // Keep error logs
+        handleStreamError(error);
     }
 
-    // Find the method ID for the callback in TunerViewModel
-    jmethodID methodId = env->GetMethodID(clazz, "onNativeResult", "(IIF)V");
-    if (methodId) {
-        env->CallVoidMethod(gJavaInstance, methodId, noteIndex, octave, centsOffsetVsDetected);
+private:
+    // --- JNI Callback Function ---
+    void notifyNativeResult(int lane, int noteIndex, int octave, float centsOffsetVsDetected) {
+        JNIEnv* env = tWorkerEnv;
+        if (!env || !javaInstance || !onNativeResultMethod) {
+            return;
+        }
+        env->CallVoidMethod(javaInstance, onNativeResultMethod, lane, noteIndex, octave, centsOffsetVsDetected);
         if (env->ExceptionCheck()) {
             ALOGE("notifyNativeResult: JNI Exception occurred calling onNativeResult"); // Keep critical error logs
             env->ExceptionDescribe();
             env->ExceptionClear();
         }
-    } else {
-        // ALOGE removed
-        if (env->ExceptionCheck()) { env->ExceptionDescribe(); env->ExceptionClear(); }
     }
 
-    env->DeleteLocalRef(clazz); // Clean up local reference
-    gJvm->DetachCurrentThread();
+    void handleStreamError(Result error) {
+        running = false; // Later callbacks return Stop
+        int32_t none = 0;
+        streamError.compare_exchange_strong(none, static_cast<int32_t>(error)); // Keep the first one
+    }
+};
+
+static_assert(sizeof(MailboxResult) <= MAX_MAILBOX_PAYLOAD_BYTES && sizeof(StrumPayload) <= MAX_MAILBOX_PAYLOAD_BYTES &&
+              sizeof(StrobePayload) <= MAX_MAILBOX_PAYLOAD_BYTES, "Raise MAX_MAILBOX_PAYLOAD_BYTES");
+
+static NativeEngine* engineFromHandle(jlong handle) {
+    return reinterpret_cast<NativeEngine*>(handle);
 }
 
+// Settings may target any lane an instance can run, before or during a run. Returns the engine if
+// 'lane' is one of them.
+static NativeEngine* engineForLane(jlong handle, jint lane) {
+    NativeEngine* engine = engineFromHandle(handle);
+    if (!engine) return nullptr;
+    if (lane < 0 || lane >= MAX_ENGINE_LANES) {
+        ALOGW("Invalid lane %d (at most %d per engine). Request ignored.", lane, MAX_ENGINE_LANES); // Keep warnings
+        return nullptr;
+    }
+    return engine;
+}
 
-// --- Oboe Audio Callback Implementation ---
-class AudioCallback : public AudioStreamCallback {
-public:
-    DataCallbackResult onAudioReady(AudioStream* stream, void* audioData, int32_t numFrames) override {
-        if (!stream || !isEngineRunning.load() || numFrames <= 0) {
-            return isEngineRunning.load() ? DataCallbackResult::Continue : DataCallbackResult::Stop;
-        }
+// --- Result Sink Setup (JNI thread only) ---
+// Constructs 'count' mailboxes back to back in a direct buffer, lane i at i * sizeof(Mailbox), and
+// keeps the buffer alive through 'bufferRef'. Returns null if the buffer cannot hold them.
+template <typename Mailbox>
+static Mailbox* constructMailboxes(JNIEnv* env, jobject buffer, int count, jobject& bufferRef) {
+    void* address = buffer ? env->GetDirectBufferAddress(buffer) : nullptr;
+    if (!address || env->GetDirectBufferCapacity(buffer) < static_cast<jlong>(count * sizeof(Mailbox)) ||
+        reinterpret_cast<uintptr_t>(address) % alignof(Mailbox) != 0) {
+        return nullptr;
+    }
+    bufferRef = env->NewGlobalRef(buffer);
+    auto* mailboxes = static_cast<Mailbox*>(address);
+    for (int i = 0; i < count; ++i) {
+        new (mailboxes + i) Mailbox(); // Starts at sequence 0, no result yet
+    }
+    return mailboxes;
+}
 
-        const auto* input = static_cast<const float*>(audioData);
-        // 1. Calculate RMS to check for silence/noise
-        float sumOfSquares = 0.0f;
-        for (int i = 0; i < numFrames; ++i) {
-            sumOfSquares += input[i] * input[i];
-        }
-        float rms = sqrtf(sumOfSquares / numFrames);
+// Strum and strobe results always go through their own mailboxes; without them that mode
+// publishes nothing.
+template <typename Mailbox>
+static Mailbox* setUpModeMailboxes(JNIEnv* env, jobject buffer, int laneCount, jobject& bufferRef, const char* modeName) {
+    if (!buffer) return nullptr;
+    Mailbox* mailboxes = constructMailboxes<Mailbox>(env, buffer, laneCount, bufferRef);
+    if (!mailboxes) {
+        ALOGW("%s mailbox must be an aligned direct buffer of at least %zu bytes; %s mode disabled.",
+              modeName, laneCount * sizeof(Mailbox), modeName); // Keep warnings
+    }
+    return mailboxes;
+}
 
-        // 2. Check RMS against threshold (Now using 0.004f)
-        if (rms < MIN_RMS_THRESHOLD) {
-            // Below threshold, likely silence or noise, notify with invalid data
-            notifyNativeResult(NOTE_INDEX_NOT_AVAILABLE, OCTAVE_NOT_AVAILABLE, CENTS_NOT_AVAILABLE);
-            return DataCallbackResult::Continue; // Keep stream running
+static bool setUpResultDelivery(JNIEnv* env, NativeEngine* engine, jobject instance, jint resultDelivery,
+                                jobject resultBuffer, int laneCount) {
+    engine->onNativeResultMethod = nullptr;
+    engine->resultMailboxes = nullptr;
+    if (resultDelivery == static_cast<int>(ResultDelivery::Mailbox)) {
+        engine->resultMailboxes = constructMailboxes<ResultMailbox>(env, resultBuffer, laneCount, engine->resultBufferRef);
+        if (!engine->resultMailboxes) {
+            ALOGE("Result mailbox must be an aligned direct buffer of at least %zu bytes.", // Keep error logs
+                  laneCount * sizeof(ResultMailbox));
+            return false;
         }
+        engine->resultDelivery = ResultDelivery::Mailbox;
+        return true;
+    }
 
-        // 3. Process audio if above threshold
-        int currentSampleRate = stream->getSampleRate();
-        float detectedFreq = computeYIN(input, numFrames, currentSampleRate);
-
-        float centsOffset = CENTS_NOT_AVAILABLE; // Default if frequency is invalid
-        DetectedNoteInfo detectedNote = getNoteInfoFromFrequency(detectedFreq);
+    jclass clazz = env->GetObjectClass(instance);
+    if (clazz) {
+        engine->onNativeResultMethod = env->GetMethodID(clazz, "onNativeResult", "(IIIF)V");
+        env->DeleteLocalRef(clazz);
+    }
+    if (!engine->onNativeResultMethod) {
+        ALOGE("onNativeResult(IIIF)V not found."); // Keep error logs
+        if (env->ExceptionCheck()) { env->ExceptionDescribe(); env->ExceptionClear(); }
+        return false;
+    }
+    engine->resultDelivery = ResultDelivery::Callback;
+    return true;
+}
 
-        // Calculate cents offset relative to the CLOSEST CHROMATIC note if frequency is valid
-        if (detectedNote.noteIndex != NOTE_INDEX_NOT_AVAILABLE && detectedFreq >= MIN_VALID_FREQUENCY) {
-            float theoreticalFreq = calculateFrequencyForMidiNote(detectedNote.midiNote, gA4Freq.load());
-            if (theoreticalFreq > std::numeric_limits<float>::epsilon()) { // Avoid division by zero
-                centsOffset = 1200.0f * log2f(detectedFreq / theoreticalFreq);
-            } else {
-                centsOffset = 0.0f; // Should not happen if detectedFreq is valid
-            }
+// Must only run once the engine's lanes are detached from the pool.
+static void releaseResultDelivery(JNIEnv* env, NativeEngine* engine) {
+    engine->resultMailboxes = nullptr;
+    engine->strumMailboxes = nullptr;
+    engine->strobeMailboxes = nullptr;
+    engine->onNativeResultMethod = nullptr;
+    for (jobject* ref : {&engine->resultBufferRef, &engine->strumBufferRef, &engine->strobeBufferRef,
+                         &engine->javaInstance}) {
+        if (*ref && env) {
+            env->DeleteGlobalRef(*ref);
         }
+        *ref = nullptr;
+    }
+}
 
-        // Notify Kotlin with the detected note index, octave, and cents offset (or invalid values)
-        notifyNativeResult(detectedNote.noteIndex, detectedNote.octave, centsOffset);
-        return DataCallbackResult::Continue;
+// --- Input Capture (JNI thread only) ---
+// Opens the requested capture for the negotiated stream; the engine runs without one on failure.
+static void openCapture(NativeEngine* engine, const AnalysisConfig& config) {
+    std::lock_guard<std::mutex> lock(engine->captureMutex);
+    if (engine->capturePath.empty()) return;
+    AudioStream* stream = engine->stream.get();
+    auto capture = std::make_unique<CaptureWriter>();
+    if (!capture->open(engine->capturePath.c_str(), stream->getSampleRate(), stream->getChannelCount(),
+                       engine->captureSeconds, config, stream->getFramesPerBurst(),
+                       static_cast<int>(stream->getAudioApi()))) {
+        ALOGW("Input capture to %s failed; running without it.", engine->capturePath.c_str()); // Keep warnings
+        return;
     }
+    engine->capture = std::move(capture);
+    engine->core.setCapture(engine->capture.get());
+    ALOGI("Capturing the last %.0f s of input to %s.", engine->captureSeconds, engine->capturePath.c_str());
+}
 
-    // --- Error Callbacks ---
-    void onErrorBeforeClose(AudioStream *stream, Result error) override {
-        ALOGE("onErrorBeforeClose: %s", convertToText(error)); // Keep error logs
-        isEngineRunning = false;
-        // Clean up JNI reference ONLY if it hasn't been cleaned elsewhere
-        if (gJavaInstance && gJvm) {
-            JNIEnv* env = nullptr;
-            jint attachResult = gJvm->AttachCurrentThread(&env, nullptr);
-            if (attachResult == JNI_OK && env != nullptr) {
-                //ALOGW("Cleaning JNI global ref in onErrorBeforeClose");
-                env->DeleteGlobalRef(gJavaInstance);
-                gJavaInstance = nullptr; // Mark as cleaned
-                gJvm->DetachCurrentThread();
-            } else { ALOGE("Failed to attach thread in onErrorBeforeClose"); } // Keep error logs
-        }
-        if (gStream.get() == stream) { gStream.reset(); } // Prevent use after error
+// Only once no callback can run any more.
+static void closeCapture(NativeEngine* engine) {
+    engine->core.setCapture(nullptr);
+    engine->capture.reset(); // Flushes the file
+}
+
+// A stream Oboe already closed after an error reports ErrorClosed, which is expected here.
+static void closeStream(NativeEngine* engine) {
+    Result stopResult = engine->stream->requestStop();
+    if (stopResult != Result::OK && stopResult != Result::ErrorClosed) {
+        ALOGE("requestStop failed: %s", convertToText(stopResult)); // Keep error logs
     }
+    Result closeResult = engine->stream->close();
+    if (closeResult != Result::OK && closeResult != Result::ErrorClosed) {
+        ALOGE("Stream close failed: %s", convertToText(closeResult)); // Keep error logs
+    }
+    engine->stream.reset(); // Release the stream pointer
+}
 
-    void onErrorAfterClose(AudioStream *stream, Result error) override {
-        ALOGE("onErrorAfterClose: %s", convertToText(error)); // Keep error logs
-        isEngineRunning = false;
-        // Double-check and clean up JNI reference if needed
-        if (gJavaInstance && gJvm) {
-            JNIEnv* env = nullptr;
-            jint attachResult = gJvm->AttachCurrentThread(&env, nullptr);
-            if (attachResult == JNI_OK && env != nullptr) {
-                //ALOGW("Cleaning JNI global ref in onErrorAfterClose");
-                env->DeleteGlobalRef(gJavaInstance);
-                gJavaInstance = nullptr; // Mark as cleaned
-                gJvm->DetachCurrentThread();
-            } else { ALOGE("Failed to attach thread in onErrorAfterClose"); } // Keep error logs
-        }
-        if (gStream.get() == stream) { gStream.reset(); } // Prevent use after error
+// Also cleans up after a stream error, which only cleared 'running'.
+static void stopEngine(JNIEnv* env, NativeEngine* engine) {
+    bool wasRunning = engine->running.exchange(false); // Atomically set to false and get previous value
+    const auto streamError = static_cast<Result>(engine->streamError.exchange(0));
+    if (streamError != Result::OK) {
+        ALOGE("The input stream failed (%s); engine stopped.", convertToText(streamError)); // Keep error logs
+    }
+    if (engine->stream) {
+        closeStream(engine);
+    }
+    closeCapture(engine);
+    engine->stopAnalysis(); // Still attached after a stream error
+    if (!wasRunning && streamError == Result::OK) {
+        releaseResultDelivery(env, engine);
+        return;
     }
-};
 
-static AudioCallback audioCallbackInstance; // Single instance
+    const EngineMetrics& metrics = engine->core.metrics();
+    uint64_t droppedFrames = metrics.droppedInputFrames.load();
+    if (droppedFrames > 0) {
+        ALOGW("Input rings overflowed, %llu frame(s) dropped.", static_cast<unsigned long long>(droppedFrames));
+    }
+    int32_t xRunCount = metrics.xRunCount.load();
+    if (xRunCount > 0) {
+        ALOGW("Input stream reported %d xrun(s).", xRunCount); // Keep warnings
+    }
+    uint64_t realtimeAllocations = realtimeAllocationCount();
+    if (realtimeAllocations > 0) {
+        ALOGE("%llu heap allocation(s) were made from the audio callback.", // Debug builds only
+              static_cast<unsigned long long>(realtimeAllocations));
+    }
+    releaseResultDelivery(env, engine);
+}
 
 
 // --- JNI Exported Functions ---
 extern "C" {
 
+JNIEXPORT jlong JNICALL
+Java_com_isaacbegue_afinador_viewmodel_TunerViewModel_createNativeEngine(
+        JNIEnv* env, jobject /*instance*/) {
+    std::lock_guard<std::mutex> lock(gPoolMutex);
+    if (!gJvm) env->GetJavaVM(&gJvm);
+    if (!gJvm) { ALOGE("Failed to get JVM."); return 0; } // Keep error logs
+    if (!gWorkerPool) {
+        gWorkerPool = std::make_unique<AnalysisWorkerPool>(AnalysisWorkerPool::defaultThreadCount(),
+                                                           attachWorkerToJvm, detachWorkerFromJvm);
+    }
+    ++gEngineCount;
+    return reinterpret_cast<jlong>(new NativeEngine());
+}
+
+JNIEXPORT void JNICALL
+Java_com_isaacbegue_afinador_viewmodel_TunerViewModel_destroyNativeEngine(
+        JNIEnv* env, jobject /*instance*/, jlong handle) {
+    NativeEngine* engine = engineFromHandle(handle);
+    if (!engine) return;
+    stopEngine(env, engine);
+    delete engine;
+    std::lock_guard<std::mutex> lock(gPoolMutex);
+    if (--gEngineCount == 0) {
+        gWorkerPool.reset(); // Joins the workers, which detach from the JVM on their way out
+    }
+}
+
 JNIEXPORT jboolean JNICALL
 Java_com_isaacbegue_afinador_viewmodel_TunerViewModel_startNativeAudioEngine(
-        JNIEnv* env, jobject instance, jint sampleRate, jint bufferSize) {
+        JNIEnv* env, jobject instance, jlong handle, jint deviceId, jint sampleRate, jint bufferSize,
+        jint differenceMethod, jint windowSize, jint hopSize, jint lowRegisterDecimation,
+        jint lowRegisterWindowSize, jint channelCount, jintArray channels, jint resultDelivery,
+        jobject resultBuffer, jobject strumBuffer, jobject strobeBuffer) {
+
+    NativeEngine* engine = engineFromHandle(handle);
+    if (!engine || engine->running.load()) { return JNI_FALSE; }
+    if (engine->stream) {
+        stopEngine(env, engine); // The previous run ended with a stream error
+    }
+    if (windowSize < 256 || hopSize <= 0 || hopSize > windowSize) {
+        ALOGE("Invalid analysis window %d / hop %d.", windowSize, hopSize); // Keep error logs
+        return JNI_FALSE;
+    }
+
+    // One lane per selected channel; null or empty analyses channel 0 alone
+    EngineConfig engineConfig;
+    engineConfig.channelCount = channelCount;
+    jsize laneCount = channels ? env->GetArrayLength(channels) : 0;
+    if (laneCount > MAX_ENGINE_LANES) {
+        ALOGE("At most %d channels per engine, got %d.", MAX_ENGINE_LANES, laneCount); // Keep error logs
+        return JNI_FALSE;
+    }
+    if (laneCount > 0) {
+        env->GetIntArrayRegion(channels, 0, laneCount, engineConfig.laneChannels);
+    }
+    engineConfig.laneCount = std::max(1, static_cast<int>(laneCount));
+
+    // Select the difference function backend; the detector itself is sized once the stream is open
+    DifferenceMethod method = DifferenceMethod::Direct;
+    if (differenceMethod == static_cast<int>(DifferenceMethod::Fft)) {
+        method = DifferenceMethod::Fft;
+    } else if (differenceMethod == static_cast<int>(DifferenceMethod::Sliding)) {
+        method = DifferenceMethod::Sliding;
+    } else if (differenceMethod != static_cast<int>(DifferenceMethod::Direct)) {
+        ALOGW("Unknown difference method %d, using direct loop.", differenceMethod); // Keep warnings
+    }
 
-    if (isEngineRunning.load()) { /* ALOGW removed */ return JNI_FALSE; }
+    // Create a global reference to the TunerViewModel instance (dropping any left from an earlier start)
+    releaseResultDelivery(env, engine);
+    engine->javaInstance = env->NewGlobalRef(instance);
+    if (!engine->javaInstance) { ALOGE("Failed to create JNI global ref."); return JNI_FALSE; } // Keep error logs
 
-    // Store JVM and create a global reference to the TunerViewModel instance
-    env->GetJavaVM(&gJvm);
-    if (!gJvm) { ALOGE("Failed to get JVM."); return JNI_FALSE; } // Keep error logs
-    // Clean up any previous instance before creating a new one
-    if (gJavaInstance) {
-        //ALOGW("Existing JNI global ref found on start, deleting old one.");
-        env->DeleteGlobalRef(gJavaInstance);
-        gJavaInstance = nullptr;
+    // Resolve the result sinks once, so the workers never look anything up per result
+    if (!setUpResultDelivery(env, engine, instance, resultDelivery, resultBuffer, engineConfig.laneCount)) {
+        releaseResultDelivery(env, engine);
+        return JNI_FALSE;
     }
-    gJavaInstance = env->NewGlobalRef(instance);
-    if (!gJavaInstance) { ALOGE("Failed to create JNI global ref."); return JNI_FALSE; } // Keep error logs
+    engine->strumMailboxes = setUpModeMailboxes<StrumMailbox>(env, strumBuffer, engineConfig.laneCount,
+                                                              engine->strumBufferRef, "strum");
+    engine->strobeMailboxes = setUpModeMailboxes<StrobeMailbox>(env, strobeBuffer, engineConfig.laneCount,
+                                                                engine->strobeBufferRef, "strobe");
 
-    //ALOGI("Attempting to start native audio engine: %d Hz, %d frames buffer requested.", sampleRate, bufferSize);
     AudioStreamBuilder builder;
     builder.setDirection(Direction::Input)
             ->setPerformanceMode(PerformanceMode::LowLatency)
             ->setSharingMode(SharingMode::Exclusive) // Try exclusive first
             ->setSampleRate(sampleRate)
-            ->setChannelCount(1) // Mono input
+            ->setChannelCount(channelCount)
             ->setFormat(AudioFormat::Float)
-            ->setFramesPerCallback(bufferSize) // Set initial desired buffer size
-            ->setDataCallback(&audioCallbackInstance)
-            ->setErrorCallback(&audioCallbackInstance);
+            ->setDataCallback(engine)
+            ->setErrorCallback(engine);
+    if (deviceId > 0) {
+        builder.setDeviceId(deviceId); // Otherwise the default input, e.g. the built-in microphone
+    }
+    if (bufferSize > 0) {
+        builder.setFramesPerCallback(bufferSize); // Otherwise the device burst size is used
+    }
 
-    Result result = builder.openStream(gStream);
+    Result result = builder.openStream(engine->stream);
     if (result != Result::OK) {
-        //ALOGW("Exclusive stream failed (%s), trying Shared mode...", convertToText(result));
         builder.setSharingMode(SharingMode::Shared); // Fallback to shared
-        result = builder.openStream(gStream);
+        result = builder.openStream(engine->stream);
         if (result != Result::OK) {
             ALOGE("Shared stream also failed: %s", convertToText(result)); // Keep error logs
-            env->DeleteGlobalRef(gJavaInstance); gJavaInstance = nullptr; // Cleanup ref on failure
-            gStream.reset();
+            releaseResultDelivery(env, engine);
+            engine->stream.reset();
             return JNI_FALSE;
-        } //else { ALOGI("Opened stream successfully in Shared mode."); }
-    } //else { ALOGI("Opened stream successfully in Exclusive mode."); }
+        }
+    }
 
-    //ALOGI("Actual Stream Params: Rate=%d, Format=%s, Ch=%d, PerfMode=%s, Sharing=%s, BufferSize=%d, Burst=%d", /* ... */);
-    result = gStream->requestStart();
+    // Size the lanes from the negotiated stream, so the callback never allocates
+    AudioStream* stream = engine->stream.get();
+    const int actualSampleRate = stream->getSampleRate();
+    AnalysisConfig& analysisConfig = engineConfig.analysis;
+    analysisConfig.sampleRate = actualSampleRate;
+    analysisConfig.windowSize = windowSize;
+    analysisConfig.hopSize = hopSize;
+    analysisConfig.method = method;
+    analysisConfig.lowRegisterDecimation = lowRegisterDecimation;
+    analysisConfig.lowRegisterWindowSize = lowRegisterWindowSize;
+    engineConfig.channelCount = stream->getChannelCount();
+    engineConfig.ringCapacity = std::max({4 * static_cast<size_t>(windowSize), static_cast<size_t>(actualSampleRate / 2),
+                                          4 * static_cast<size_t>(std::max(stream->getFramesPerBurst(),
+                                                                           stream->getFramesPerDataCallback()))});
+    if (!engine->core.configure(engineConfig)) {
+        closeStream(engine);
+        releaseResultDelivery(env, engine);
+        return JNI_FALSE;
+    }
+    resetRealtimeAllocationCount();
+
+    EngineMetrics& metrics = engine->core.metrics();
+    metrics.framesPerBurst.store(stream->getFramesPerBurst(), std::memory_order_relaxed);
+    metrics.framesPerCallback.store(stream->getFramesPerDataCallback(), std::memory_order_relaxed);
+    metrics.bufferSizeFrames.store(stream->getBufferSizeInFrames(), std::memory_order_relaxed);
+    metrics.sharingMode.store(static_cast<int32_t>(stream->getSharingMode()), std::memory_order_relaxed);
+    metrics.audioApi.store(static_cast<int32_t>(stream->getAudioApi()), std::memory_order_relaxed);
+    openCapture(engine, analysisConfig);
+
+    engine->running = true;
+    engine->startAnalysis();
+    result = stream->requestStart();
     if (result != Result::OK) {
         ALOGE("requestStart failed: %s", convertToText(result)); // Keep error logs
-        gStream->close(); // Close the stream on failure
-        gStream.reset();
-        env->DeleteGlobalRef(gJavaInstance); gJavaInstance = nullptr; // Cleanup ref
+        engine->running = false;
+        engine->stopAnalysis();
+        engine->stream->close(); // Close the stream on failure
+        engine->stream.reset();
+        closeCapture(engine);
+        releaseResultDelivery(env, engine);
         return JNI_FALSE;
     }
-
-    //ALOGI("Native audio engine started successfully!");
-    isEngineRunning = true;
     return JNI_TRUE;
 }
 
 JNIEXPORT void JNICALL
 Java_com_isaacbegue_afinador_viewmodel_TunerViewModel_stopNativeAudioEngine(
-        JNIEnv* env, jobject /*instance*/) {
+        JNIEnv* env, jobject /*instance*/, jlong handle) {
+    NativeEngine* engine = engineFromHandle(handle);
+    if (engine) stopEngine(env, engine);
+}
 
-    bool wasRunning = isEngineRunning.exchange(false); // Atomically set to false and get previous value
-
-    if (!wasRunning || !gStream) {
-        //ALOGW("Engine not running or stream null, stop request ignored/already stopped.");
-        // Attempt cleanup JNI ref just in case it was left hanging
-        if (gJavaInstance && gJvm) {
-            JNIEnv* currentEnv = nullptr;
-            jint getEnvResult = gJvm->GetEnv(reinterpret_cast<void**>(&currentEnv), JNI_VERSION_1_6);
-            bool attached = false;
-            if (getEnvResult == JNI_EDETACHED) { getEnvResult = gJvm->AttachCurrentThread(&currentEnv, nullptr); attached = (getEnvResult == JNI_OK); }
-            if (getEnvResult == JNI_OK && currentEnv) {
-                //ALOGW("Cleaning up potentially dangling JNI ref during stop (engine wasn't running).");
-                currentEnv->DeleteGlobalRef(gJavaInstance);
-                gJavaInstance = nullptr; // Mark as cleaned
-            }
-            if (attached) { gJvm->DetachCurrentThread(); }
-        }
-        gStream.reset(); // Ensure stream pointer is null
-        return;
+JNIEXPORT void JNICALL
+Java_com_isaacbegue_afinador_viewmodel_TunerViewModel_setA4Native(
+        JNIEnv* /*env*/, jobject /*instance*/, jlong handle, jfloat frequency) {
+    NativeEngine* engine = engineFromHandle(handle);
+    if (!engine) return;
+    // Basic validation for plausible A4 range
+    if (frequency >= 300.0f && frequency <= 600.0f) {
+        engine->core.setA4(frequency);
+    } else {
+        ALOGW("Invalid A4 frequency received: %.2f Hz. Request ignored.", frequency); // Keep warnings
     }
+}
 
-    //ALOGI("Stopping native audio engine requested...");
-
-    Result stopResult = gStream->requestStop();
-    if (stopResult != Result::OK) { ALOGE("requestStop failed: %s", convertToText(stopResult)); } // Keep error logs
-    //else { ALOGI("Stream stop requested successfully."); }
-
-    Result closeResult = gStream->close();
-    if (closeResult != Result::OK) { ALOGE("Stream close failed: %s", convertToText(closeResult)); } // Keep error logs
-    //else { ALOGI("Stream closed successfully."); }
+JNIEXPORT void JNICALL
+Java_com_isaacbegue_afinador_viewmodel_TunerViewModel_setCandidateRangesNative(
+        JNIEnv* env, jobject /*instance*/, jlong handle, jint lane, jfloatArray ranges) {
+    NativeEngine* engine = engineForLane(handle, lane);
+    if (!engine) return;
+    jsize length = ranges ? env->GetArrayLength(ranges) : 0;
+    if (length % 2 != 0) {
+        ALOGW("Candidate ranges need min/max pairs, got %d values. Request ignored.", length); // Keep warnings
+        return;
+    }
+    int count = std::min(static_cast<int>(length / 2), MAX_CANDIDATE_RANGES);
+    float values[2 * MAX_CANDIDATE_RANGES];
+    if (count > 0) {
+        env->GetFloatArrayRegion(ranges, 0, 2 * count, values);
+    }
+    FrequencyRange candidates[MAX_CANDIDATE_RANGES];
+    for (int i = 0; i < count; ++i) {
+        candidates[i] = {values[2 * i], values[2 * i + 1]};
+    }
+    engine->core.setCandidateRanges(lane, candidates, count);
+}
 
-    gStream.reset(); // Release the stream pointer
+JNIEXPORT void JNICALL
+Java_com_isaacbegue_afinador_viewmodel_TunerViewModel_setStrumStringsNative(
+        JNIEnv* env, jobject /*instance*/, jlong handle, jint lane, jfloatArray frequencies) {
+    NativeEngine* engine = engineForLane(handle, lane);
+    if (!engine) return;
+    jsize length = frequencies ? env->GetArrayLength(frequencies) : 0;
+    if (length > MAX_STRUM_STRINGS) {
+        ALOGW("Strum mode takes at most %d strings, got %d; extra strings ignored.", MAX_STRUM_STRINGS, length); // Keep warnings
+    }
+    int count = std::min(static_cast<int>(length), MAX_STRUM_STRINGS);
+    float values[MAX_STRUM_STRINGS];
+    if (count > 0) {
+        env->GetFloatArrayRegion(frequencies, 0, count, values);
+    }
+    engine->core.setStrumStrings(lane, values, count);
+}
 
-    // Clean up JNI global reference
-    if (gJavaInstance && gJvm) {
-        JNIEnv* currentEnv = nullptr;
-        jint getEnvResult = gJvm->GetEnv(reinterpret_cast<void**>(&currentEnv), JNI_VERSION_1_6);
-        bool attached = false;
-        // Attach if not already attached
-        if (getEnvResult == JNI_EDETACHED) {
-            getEnvResult = gJvm->AttachCurrentThread(&currentEnv, nullptr);
-            attached = (getEnvResult == JNI_OK);
-        }
-        if (getEnvResult == JNI_OK && currentEnv) {
-            //ALOGI("Deleting JNI global ref during stop...");
-            currentEnv->DeleteGlobalRef(gJavaInstance);
-            gJavaInstance = nullptr; // Nullify after deletion
-        } else {
-            ALOGE("Could not get/attach JNIEnv to delete global ref during stop. Result: %d", getEnvResult); // Keep error logs
-        }
-        // Detach only if we attached it here
-        if (attached) {
-            gJvm->DetachCurrentThread();
-        }
-    } //else { ALOGW("JNI global ref was already null or JVM null during stop."); }
-    gJavaInstance = nullptr; // Ensure it's null
+JNIEXPORT void JNICALL
+Java_com_isaacbegue_afinador_viewmodel_TunerViewModel_setStrobeTargetNative(
+        JNIEnv* /*env*/, jobject /*instance*/, jlong handle, jint lane, jfloat frequency) {
+    NativeEngine* engine = engineForLane(handle, lane);
+    if (!engine) return;
+    if (frequency != 0.0f && (frequency < MIN_VALID_FREQUENCY || !std::isfinite(frequency))) {
+        ALOGW("Invalid strobe target %.2f Hz. Request ignored.", frequency); // Keep warnings
+        return;
+    }
+    engine->core.setStrobeTarget(lane, frequency);
+}
 
-    //ALOGI("Native audio engine stopped.");
+JNIEXPORT void JNICALL
+Java_com_isaacbegue_afinador_viewmodel_TunerViewModel_setDutyCycleNative(
+        JNIEnv* /*env*/, jobject /*instance*/, jlong handle, jint lane, jboolean enabled, jint silentInterval,
+        jint heldInterval, jfloat heldCents, jfloat settleSeconds) {
+    NativeEngine* engine = engineForLane(handle, lane);
+    if (!engine) return;
+    if (enabled && (silentInterval < 1 || heldInterval < 1 || !(heldCents > 0.0f) || !(settleSeconds >= 0.0f))) {
+        ALOGW("Invalid duty cycle: intervals %d/%d, %.2f cents, %.2f s. Request ignored.", silentInterval,
+              heldInterval, heldCents, settleSeconds); // Keep warnings
+        return;
+    }
+    DutyCyclePolicy policy;
+    policy.enabled = enabled == JNI_TRUE;
+    policy.silentInterval = silentInterval;
+    policy.heldInterval = heldInterval;
+    policy.heldCents = heldCents;
+    policy.settleSeconds = settleSeconds;
+    engine->core.setDutyCycle(lane, policy);
 }
 
 JNIEXPORT void JNICALL
-Java_com_isaacbegue_afinador_viewmodel_TunerViewModel_setA4Native(
-        JNIEnv* /*env*/, jobject /*instance*/, jfloat frequency) {
-    // Basic validation for plausible A4 range
-    if (frequency >= 300.0f && frequency <= 600.0f) {
-        gA4Freq.store(frequency);
-    } else {
-        ALOGW("Invalid A4 frequency received: %.2f Hz. Request ignored.", frequency); // Keep warnings
+Java_com_isaacbegue_afinador_viewmodel_TunerViewModel_setInputCaptureNative(
+        JNIEnv* env, jobject /*instance*/, jlong handle, jstring path, jfloat seconds) {
+    NativeEngine* engine = engineFromHandle(handle);
+    if (!engine) return;
+    std::string capturePath;
+    if (path) {
+        const char* chars = env->GetStringUTFChars(path, nullptr);
+        if (!chars) return; // OutOfMemoryError is pending
+        capturePath = chars;
+        env->ReleaseStringUTFChars(path, chars);
+    }
+    if (!capturePath.empty() && !(seconds > 0.0f && seconds <= MAX_CAPTURE_SECONDS)) {
+        ALOGW("Invalid capture length %.1f s. Request ignored.", seconds); // Keep warnings
+        return;
     }
+    std::lock_guard<std::mutex> lock(engine->captureMutex);
+    engine->capturePath = capturePath;
+    engine->captureSeconds = seconds;
+}
+
+JNIEXPORT jint JNICALL
+Java_com_isaacbegue_afinador_viewmodel_TunerViewModel_readMailboxNative(
+        JNIEnv* env, jobject /*instance*/, jobject mailboxBuffer, jint lane, jint lastSequence, jbyteArray payload) {
+    const jsize payloadBytes = payload ? env->GetArrayLength(payload) : 0;
+    void* address = mailboxBuffer ? env->GetDirectBufferAddress(mailboxBuffer) : nullptr;
+    const size_t stride = MAILBOX_PAYLOAD_OFFSET + payloadBytes;
+    if (!address || lane < 0 || payloadBytes <= 0 || payloadBytes % sizeof(uint32_t) != 0 ||
+        payloadBytes > MAX_MAILBOX_PAYLOAD_BYTES ||
+        env->GetDirectBufferCapacity(mailboxBuffer) < static_cast<jlong>((lane + 1) * stride)) {
+        return lastSequence;
+    }
+    // The buffer holds Mailbox<Payload> objects constructed at start; only their layout is needed here
+    auto* mailbox = static_cast<unsigned char*>(address) + lane * stride;
+    uint32_t words[MAX_MAILBOX_PAYLOAD_BYTES / sizeof(uint32_t)];
+    const uint32_t sequence = readMailboxWords(*reinterpret_cast<const std::atomic<uint32_t>*>(mailbox),
+                                               reinterpret_cast<const std::atomic<uint32_t>*>(mailbox + MAILBOX_PAYLOAD_OFFSET),
+                                               payloadBytes / sizeof(uint32_t), static_cast<uint32_t>(lastSequence), words);
+    if (sequence != static_cast<uint32_t>(lastSequence)) {
+        env->SetByteArrayRegion(payload, 0, payloadBytes, reinterpret_cast<const jbyte*>(words));
+    }
+    return static_cast<jint>(sequence);
+}
+
+JNIEXPORT jlongArray JNICALL
+Java_com_isaacbegue_afinador_viewmodel_TunerViewModel_getEngineMetricsNative(
+        JNIEnv* env, jobject /*instance*/, jlong handle, jint lane) {
+    NativeEngine* engine = engineForLane(handle, lane);
+    if (!engine) return nullptr;
+    int64_t snapshot[METRICS_FIELD_COUNT];
+    // Values stay readable after the engine stops
+    writeMetricsSnapshot(engine->core.metrics(), engine->core.lane(lane).metrics(), snapshot);
+    jlongArray array = env->NewLongArray(METRICS_FIELD_COUNT);
+    if (!array) return nullptr; // OutOfMemoryError is pending
+    static_assert(sizeof(jlong) == sizeof(int64_t), "jlong must be 64-bit");
+    env->SetLongArrayRegion(array, 0, METRICS_FIELD_COUNT, reinterpret_cast<const jlong*>(snapshot));
+    return array;
 }
 
-} // extern "C"
\ No newline at end of file
+} // extern "C"
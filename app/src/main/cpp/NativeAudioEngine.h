@@ -7,31 +7,168 @@
 extern "C" {
 #endif
 
-// Starts the audio engine with the specified sample rate and buffer size.
+// Engines are instances behind a handle: each has its own input stream, analysed channels,
+// reference A4, detector config and result sinks, so several can run at once (e.g. one per
+// instrument on a multichannel interface). Their analysis runs on one worker pool shared by all
+// instances. Every call below takes the handle returned by createNativeEngine; settings may be
+// made before start and persist across runs.
+
+// Creates an engine instance. Returns its handle, or 0 on failure.
+JNIEXPORT jlong JNICALL
+Java_com_isaacbegue_afinador_viewmodel_TunerViewModel_createNativeEngine(
+        JNIEnv* env,
+        jobject instance);
+
+// Stops the engine if it is running and frees it. The handle is invalid afterwards. Must not
+// overlap any other call on the same handle: TunerViewModel makes its start, stop, settings and
+// destroy calls from one thread, in order.
+JNIEXPORT void JNICALL
+Java_com_isaacbegue_afinador_viewmodel_TunerViewModel_destroyNativeEngine(
+        JNIEnv* env,
+        jobject instance,
+        jlong handle);
+
+// Starts the engine on input device deviceId (0 = default input) with the specified sample rate,
+// channelCount interleaved channels and buffer size (frames per callback, 0 = device burst).
+// channels lists the input channels to analyse, one lane each (at most MAX_ENGINE_LANES; null
+// analyses channel 0): lane i is the i-th entry. differenceMethod selects the YIN difference
+// backend: 0 = direct lag loop, 1 = FFT, 2 = sliding (d(tau) updated per hop). Every lane analyses
+// windowSize samples every hopSize samples on the shared worker pool.
+// lowRegisterDecimation > 1 adds the low-register path: YIN over lowRegisterWindowSize samples of
+// the input decimated by that factor, for pitches below the reach of windowSize.
+// resultDelivery 0 calls onNativeResult(lane, noteIndex, octave, cents) for every window; 1
+// publishes into the seqlock mailboxes held by resultBuffer (a DirectByteBuffer with one
+// ResultMailbox per lane, see ResultMailbox.h, read with readMailboxNative) and makes no JNI calls.
+// strumBuffer (a DirectByteBuffer holding one StrumMailbox per lane, or null) receives the strum
+// mode's per-string results whatever the delivery mode; strobeBuffer (StrobeMailboxes, or null)
+// likewise receives the strobe mode's readings.
 JNIEXPORT jboolean JNICALL
 Java_com_isaacbegue_afinador_viewmodel_TunerViewModel_startNativeAudioEngine(
         JNIEnv* env,
         jobject instance,
+        jlong handle,
+        jint deviceId,
         jint sampleRate,
-        jint bufferSize);
+        jint bufferSize,
+        jint differenceMethod,
+        jint windowSize,
+        jint hopSize,
+        jint lowRegisterDecimation,
+        jint lowRegisterWindowSize,
+        jint channelCount,
+        jintArray channels,
+        jint resultDelivery,
+        jobject resultBuffer,
+        jobject strumBuffer,
+        jobject strobeBuffer);
 
-// Stops the audio engine.
+// Stops the engine's stream and analysis.
 JNIEXPORT void JNICALL
 Java_com_isaacbegue_afinador_viewmodel_TunerViewModel_stopNativeAudioEngine(
         JNIEnv* env,
-        jobject instance);
+        jobject instance,
+        jlong handle);
 
-// Sets the reference frequency for A4.
+// Sets the reference frequency for A4, for every lane of the engine.
 JNIEXPORT void JNICALL
 Java_com_isaacbegue_afinador_viewmodel_TunerViewModel_setA4Native(
         JNIEnv* env,
         jobject instance,
+        jlong handle,
+        jfloat frequency);
+
+// Sets the expected pitch ranges of a lane as [min0, max0, min1, max1, ...] in Hz (at most
+// MAX_CANDIDATE_RANGES pairs). The detector searches only those lags and falls back to the full
+// range when they hold no clear pitch. An empty or null array restores full scans.
+JNIEXPORT void JNICALL
+Java_com_isaacbegue_afinador_viewmodel_TunerViewModel_setCandidateRangesNative(
+        JNIEnv* env,
+        jobject instance,
+        jlong handle,
+        jint lane,
+        jfloatArray ranges);
+
+// Switches a lane to the strum mode: every string of the instrument is tuned at once from a
+// strummed chord, given their target frequencies in Hz (at most MAX_STRUM_STRINGS). Results are
+// published to the lane's strum mailbox instead of the single-note ones. An empty or null array
+// switches back.
+JNIEXPORT void JNICALL
+Java_com_isaacbegue_afinador_viewmodel_TunerViewModel_setStrumStringsNative(
+        JNIEnv* env,
+        jobject instance,
+        jlong handle,
+        jint lane,
+        jfloatArray frequencies);
+
+// Switches a lane to the strobe mode at the given target fundamental in Hz: instead of YIN, the
+// phase of the target's first partials is tracked for a sub-cent reading and a strobe position,
+// published to the lane's strobe mailbox every hop. 0 switches back. The strum mode takes
+// precedence while set.
+JNIEXPORT void JNICALL
+Java_com_isaacbegue_afinador_viewmodel_TunerViewModel_setStrobeTargetNative(
+        JNIEnv* env,
+        jobject instance,
+        jlong handle,
+        jint lane,
         jfloat frequency);
 
-// Removed: Declaration for setTargetFrequencyNative as it's no longer needed in C++
+// Sets a lane's duty cycle (see AnalysisScheduler.h): when enabled, the single-note pipeline
+// analyses only every silentInterval-th hop during silence and every heldInterval-th hop while a
+// note has stayed within heldCents for settleSeconds, and returns to every hop on an onset. Any
+// time; the metrics report the resulting rate and the CPU time saved.
+JNIEXPORT void JNICALL
+Java_com_isaacbegue_afinador_viewmodel_TunerViewModel_setDutyCycleNative(
+        JNIEnv* env,
+        jobject instance,
+        jlong handle,
+        jint lane,
+        jboolean enabled,
+        jint silentInterval,
+        jint heldInterval,
+        jfloat heldCents,
+        jfloat settleSeconds);
+
+// Captures the engine's raw input from the next start on: the newest 'seconds' (at most 15, fewer
+// if the memory lock limit is lower) of interleaved float frames plus every callback's size, time
+// and xrun count go to a memory-mapped ring file at 'path' (see CaptureFile.h), closed when the
+// engine stops. The engine runs without it if the disk cannot hold it. The file also records each
+// lane's channel and settings (A4, candidate ranges, strum strings, strobe target, duty cycle)
+// when it opens, and every change made through the setters above while it is open, at the frame
+// it was made. Replay it on a host with afinador_replay. A null or empty path turns capturing off.
+JNIEXPORT void JNICALL
+Java_com_isaacbegue_afinador_viewmodel_TunerViewModel_setInputCaptureNative(
+        JNIEnv* env,
+        jobject instance,
+        jlong handle,
+        jstring path,
+        jfloat seconds);
+
+// Copies the payload of lane 'lane's mailbox in mailboxBuffer (a result, strum or strobe mailbox
+// buffer passed to startNativeAudioEngine) into 'payload', whose length is the payload size, if
+// its sequence has moved on from lastSequence. Returns the sequence of the copy, or lastSequence
+// when nothing new was published. The seqlock read is done here, with the fences the JVM cannot
+// express on every API level; takes no engine handle and never blocks.
+JNIEXPORT jint JNICALL
+Java_com_isaacbegue_afinador_viewmodel_TunerViewModel_readMailboxNative(
+        JNIEnv* env,
+        jobject instance,
+        jobject mailboxBuffer,
+        jint lane,
+        jint lastSequence,
+        jbyteArray payload);
+
+// Returns a snapshot of the runtime metrics of one lane and its engine's stream (see
+// EngineMetrics.h for the layout, mirrored by the METRICS_* constants in TunerViewModel).
+// Lock-free, callable from any thread, before, during or after a run.
+JNIEXPORT jlongArray JNICALL
+Java_com_isaacbegue_afinador_viewmodel_TunerViewModel_getEngineMetricsNative(
+        JNIEnv* env,
+        jobject instance,
+        jlong handle,
+        jint lane);
 
 #ifdef __cplusplus
 }
 #endif
 
-#endif // NATIVE_AUDIO_ENGINE_H
\ No newline at end of file
+#endif // NATIVE_AUDIO_ENGINE_H
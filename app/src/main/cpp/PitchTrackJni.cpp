@@ -0,0 +1,80 @@
+#include "PitchTrackJni.h"
+#include "PitchTrack.h"
+#include <android/log.h>
+#include <jni.h>
+#include <cstdint>
+
+// --- Logging ---
+#define LOG_TAG "PitchTrack"
+#define ALOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+#define ALOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+
+static AnalysisConfig makeAnalysisConfig(jint sampleRate, jint differenceMethod, jint windowSize, jint hopSize,
+                                         jint lowRegisterDecimation, jint lowRegisterWindowSize) {
+    AnalysisConfig config;
+    config.sampleRate = sampleRate;
+    config.windowSize = windowSize;
+    config.hopSize = hopSize;
+    config.lowRegisterDecimation = lowRegisterDecimation;
+    config.lowRegisterWindowSize = lowRegisterWindowSize;
+    config.method = DifferenceMethod::Direct;
+    if (differenceMethod == static_cast<int>(DifferenceMethod::Fft)) {
+        config.method = DifferenceMethod::Fft;
+    } else if (differenceMethod == static_cast<int>(DifferenceMethod::Sliding)) {
+        config.method = DifferenceMethod::Sliding;
+    }
+    return config;
+}
+
+extern "C" {
+
+JNIEXPORT jlong JNICALL
+Java_com_isaacbegue_afinador_analysis_PitchTracker_pitchTrackRecordCountNative(
+        JNIEnv* /*env*/, jobject /*instance*/, jlong sampleCount, jint windowSize, jint hopSize) {
+    if (sampleCount <= 0) return 0;
+    AnalysisConfig config;
+    config.windowSize = windowSize;
+    config.hopSize = hopSize;
+    return static_cast<jlong>(pitchTrackRecordCount(static_cast<size_t>(sampleCount), config));
+}
+
+JNIEXPORT jlong JNICALL
+Java_com_isaacbegue_afinador_analysis_PitchTracker_computePitchTrackNative(
+        JNIEnv* env, jobject /*instance*/, jobject pcm, jlong sampleCount, jint sampleRate,
+        jint differenceMethod, jint windowSize, jint hopSize, jint lowRegisterDecimation,
+        jint lowRegisterWindowSize, jfloat a4Frequency, jint threadCount, jobject output) {
+    PitchTrackConfig config;
+    config.analysis = makeAnalysisConfig(sampleRate, differenceMethod, windowSize, hopSize,
+                                         lowRegisterDecimation, lowRegisterWindowSize);
+    config.a4Frequency = a4Frequency;
+    config.threadCount = threadCount;
+
+    // Both buffers are used in place: no copy of the take or of the track crosses JNI
+    const void* input = pcm ? env->GetDirectBufferAddress(pcm) : nullptr;
+    void* records = output ? env->GetDirectBufferAddress(output) : nullptr;
+    if (!input || sampleCount < 0 ||
+        env->GetDirectBufferCapacity(pcm) < static_cast<jlong>(sampleCount * sizeof(float)) ||
+        reinterpret_cast<uintptr_t>(input) % alignof(float) != 0) {
+        ALOGE("PCM must be an aligned direct buffer of %lld floats.", static_cast<long long>(sampleCount)); // Keep error logs
+        return -1;
+    }
+    const size_t count = pitchTrackRecordCount(static_cast<size_t>(sampleCount), config.analysis);
+    if (!records || env->GetDirectBufferCapacity(output) < static_cast<jlong>(count * sizeof(PitchTrackRecord)) ||
+        reinterpret_cast<uintptr_t>(records) % alignof(PitchTrackRecord) != 0) {
+        ALOGE("Pitch track output must be an aligned direct buffer of at least %zu bytes.", // Keep error logs
+              count * sizeof(PitchTrackRecord));
+        return -1;
+    }
+
+    PitchTrackStats stats;
+    if (!computePitchTrack(static_cast<const float*>(input), static_cast<size_t>(sampleCount), config,
+                           static_cast<PitchTrackRecord*>(records), &stats)) {
+        return -1;
+    }
+    ALOGI("Pitch track: %zu windows of %.1f s in %.2f s on %d threads (%d segments, %d stolen).", count,
+          static_cast<double>(sampleCount) / sampleRate, stats.seconds, stats.threads, stats.segments,
+          stats.stolenSegments);
+    return static_cast<jlong>(count);
+}
+
+} // extern "C"
@@ -0,0 +1,45 @@
+#ifndef PITCH_TRACK_JNI_H
+#define PITCH_TRACK_JNI_H
+
+#include <jni.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Number of PitchTrackRecords computePitchTrackNative writes for sampleCount samples.
+JNIEXPORT jlong JNICALL
+Java_com_isaacbegue_afinador_analysis_PitchTracker_pitchTrackRecordCountNative(
+        JNIEnv* env,
+        jobject instance,
+        jlong sampleCount,
+        jint windowSize,
+        jint hopSize);
+
+// Pitch track of a recorded take: pcm is a direct buffer (e.g. a read-only file mapping) of
+// sampleCount mono floats in native byte order, analysed like the live engine (differenceMethod
+// and the window, hop and low-register parameters as in startNativeAudioEngine) on threadCount
+// threads (0 = all cores). output is a direct buffer that receives the records (see
+// PitchTrack.h), read in place by Kotlin. Blocks until done; returns the number of records
+// written, or -1 if a buffer or the config is invalid.
+JNIEXPORT jlong JNICALL
+Java_com_isaacbegue_afinador_analysis_PitchTracker_computePitchTrackNative(
+        JNIEnv* env,
+        jobject instance,
+        jobject pcm,
+        jlong sampleCount,
+        jint sampleRate,
+        jint differenceMethod,
+        jint windowSize,
+        jint hopSize,
+        jint lowRegisterDecimation,
+        jint lowRegisterWindowSize,
+        jfloat a4Frequency,
+        jint threadCount,
+        jobject output);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PITCH_TRACK_JNI_H
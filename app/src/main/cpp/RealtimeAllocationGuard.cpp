@@ -0,0 +1,45 @@
+#include "RealtimeAllocationGuard.h"
+
+#ifndef NDEBUG
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Replaces the global allocation functions of this library in debug builds only.
+// Deallocation goes straight to free(), matching the malloc() used below.
+
+static thread_local int tRealtimeDepth = 0;
+static std::atomic<uint64_t> gRealtimeAllocations(0);
+
+void enterRealtimeSection() { ++tRealtimeDepth; }
+void leaveRealtimeSection() { --tRealtimeDepth; }
+uint64_t realtimeAllocationCount() { return gRealtimeAllocations.load(std::memory_order_relaxed); }
+void resetRealtimeAllocationCount() { gRealtimeAllocations.store(0, std::memory_order_relaxed); }
+
+static void* trackedAllocate(std::size_t size) {
+    if (tRealtimeDepth > 0) {
+        gRealtimeAllocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void* operator new(std::size_t size) {
+    void* p = trackedAllocate(size);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void* operator new[](std::size_t size) {
+    void* p = trackedAllocate(size);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return trackedAllocate(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return trackedAllocate(size); }
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+#endif // NDEBUG
@@ -0,0 +1,30 @@
+#ifndef AFINADOR_REALTIME_ALLOCATION_GUARD_H
+#define AFINADOR_REALTIME_ALLOCATION_GUARD_H
+
+#include <cstdint>
+
+// Debug-build check that the real-time audio path never touches the heap.
+// While a ScopedRealtimeSection is alive on a thread, every global operator new issued from that
+// thread is counted. Release builds (NDEBUG) compile all of this down to no-ops.
+
+#ifndef NDEBUG
+void enterRealtimeSection();
+void leaveRealtimeSection();
+uint64_t realtimeAllocationCount();
+void resetRealtimeAllocationCount();
+#else
+inline void enterRealtimeSection() {}
+inline void leaveRealtimeSection() {}
+inline uint64_t realtimeAllocationCount() { return 0; }
+inline void resetRealtimeAllocationCount() {}
+#endif
+
+class ScopedRealtimeSection {
+public:
+    ScopedRealtimeSection() { enterRealtimeSection(); }
+    ~ScopedRealtimeSection() { leaveRealtimeSection(); }
+    ScopedRealtimeSection(const ScopedRealtimeSection&) = delete;
+    ScopedRealtimeSection& operator=(const ScopedRealtimeSection&) = delete;
+};
+
+#endif // AFINADOR_REALTIME_ALLOCATION_GUARD_H
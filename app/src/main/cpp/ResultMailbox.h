@@ -0,0 +1,179 @@
+#ifndef AFINADOR_RESULT_MAILBOX_H
+#define AFINADOR_RESULT_MAILBOX_H
+
+#include "StrobeAnalyzer.h"
+#include "StrumAnalyzer.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// --- Seqlock Mailbox ---
+// The latest Payload published by one writer thread, shared with Kotlin through a DirectByteBuffer
+// (native byte order). The writer makes 'sequence' odd while it updates the payload and even again
+// when done; a reader copies the payload and accepts it only if it saw the same even sequence
+// before and after. The payload is held as relaxed 32-bit atomics, so a copy that overlaps an
+// update is well defined (and then thrown away), and the fences order it against the sequence.
+// Kotlin does not read the buffer itself: readMailboxNative makes the copy.
+constexpr size_t MAILBOX_PAYLOAD_OFFSET = 8; // Keeps 64-bit payload fields aligned
+constexpr int MAILBOX_READ_ATTEMPTS = 4;     // Then the reader waits for its next frame
+
+template <typename Payload>
+struct Mailbox {
+    static_assert(std::is_trivially_copyable<Payload>::value && sizeof(Payload) % sizeof(uint32_t) == 0,
+                  "Mailbox payloads are copied as 32-bit words");
+    static constexpr size_t WORDS = sizeof(Payload) / sizeof(uint32_t);
+
+    std::atomic<uint32_t> sequence;
+    uint32_t reserved;
+    std::atomic<uint32_t> words[WORDS];
+
+    // Single writer only. Never blocks, so it is safe on real-time threads.
+    void publish(const Payload& payload) {
+        uint32_t source[WORDS];
+        std::memcpy(source, &payload, sizeof(Payload));
+        const uint32_t current = sequence.load(std::memory_order_relaxed);
+        sequence.store(current + 1, std::memory_order_relaxed); // Odd: update in progress
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < WORDS; ++i) words[i].store(source[i], std::memory_order_relaxed);
+        sequence.store(current + 2, std::memory_order_release); // Even: consistent again
+    }
+};
+
+// Any thread. Copies 'count' payload words into 'out' if the sequence has moved on from
+// 'lastSequence'. Returns the sequence of a consistent copy, or lastSequence when nothing new was
+// published or the writer kept updating.
+inline uint32_t readMailboxWords(const std::atomic<uint32_t>& sequence, const std::atomic<uint32_t>* words,
+                                 size_t count, uint32_t lastSequence, uint32_t* out) {
+    for (int attempt = 0; attempt < MAILBOX_READ_ATTEMPTS; ++attempt) {
+        const uint32_t before = sequence.load(std::memory_order_acquire);
+        if (before == lastSequence) return lastSequence;
+        if (before & 1u) continue; // The writer is mid-update
+        for (size_t i = 0; i < count; ++i) out[i] = words[i].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) == before) return before;
+    }
+    return lastSequence;
+}
+
+// --- Result Mailbox ---
+// Latest single-note detection result. Payload offsets must match the RESULT_PAYLOAD_* constants in
+// TunerViewModel.
+struct MailboxResult {
+    int32_t noteIndex;
+    int32_t octave;
+    float frequency;        // Hz, 0 when nothing was detected
+    float centsOffset;      // Versus the closest chromatic note
+    float confidence;       // 0..1
+    float rms;
+    int64_t timestampNanos; // CLOCK_MONOTONIC, same base as System.nanoTime()
+};
+
+using ResultMailbox = Mailbox<MailboxResult>;
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "Mailbox words must be plain 32-bit words");
+static_assert(offsetof(ResultMailbox, words) == MAILBOX_PAYLOAD_OFFSET, "Mailbox layout mismatch");
+static_assert(sizeof(ResultMailbox) == MAILBOX_PAYLOAD_OFFSET + sizeof(MailboxResult), "Mailbox layout mismatch");
+static_assert(offsetof(MailboxResult, frequency) == 8, "Result payload layout mismatch");
+static_assert(offsetof(MailboxResult, timestampNanos) == 24, "Result payload layout mismatch");
+static_assert(sizeof(MailboxResult) == 32, "Result payload layout mismatch");
+
+// --- Strum Mailbox ---
+// Every string of the latest strum analysis, published as one payload. Payload offsets must match
+// the STRUM_PAYLOAD_* constants in TunerViewModel.
+constexpr uint32_t STRUM_MAILBOX_GATED = 1u;   // StrumPayload::flags: window below the RMS gate
+constexpr uint32_t STRUM_STRING_DETECTED = 1u; // StrumMailboxString::flags
+constexpr uint32_t STRUM_STRING_SHARED = 2u;
+
+struct StrumMailboxString {
+    float frequency;   // Hz, 0 when the string was not found
+    float centsOffset; // Versus the string's target
+    float confidence;  // 0..1
+    uint32_t flags;    // STRUM_STRING_*
+};
+
+struct StrumPayload {
+    int32_t stringCount;
+    float rms;
+    uint32_t flags;         // STRUM_MAILBOX_GATED
+    uint32_t reserved;
+    int64_t timestampNanos; // CLOCK_MONOTONIC
+    StrumMailboxString strings[MAX_STRUM_STRINGS]; // In the order the targets were set
+};
+
+using StrumMailbox = Mailbox<StrumPayload>;
+
+static_assert(sizeof(StrumMailbox) == MAILBOX_PAYLOAD_OFFSET + sizeof(StrumPayload), "Mailbox layout mismatch");
+static_assert(offsetof(StrumPayload, timestampNanos) == 16, "Strum payload layout mismatch");
+static_assert(offsetof(StrumPayload, strings) == 24, "Strum payload layout mismatch");
+static_assert(sizeof(StrumMailboxString) == 16, "Strum payload layout mismatch");
+static_assert(sizeof(StrumPayload) == 24 + 16 * MAX_STRUM_STRINGS, "Strum payload layout mismatch");
+
+// Single writer only. Never blocks.
+inline void publishStrumToMailbox(StrumMailbox* box, const StrumResult& result, int64_t timestampNanos) {
+    StrumPayload payload{};
+    payload.stringCount = result.stringCount;
+    payload.rms = result.rms;
+    payload.flags = result.gated ? STRUM_MAILBOX_GATED : 0u;
+    payload.timestampNanos = timestampNanos;
+    for (int s = 0; s < result.stringCount; ++s) {
+        const StringEstimate& estimate = result.strings[s];
+        StrumMailboxString& out = payload.strings[s];
+        out.frequency = estimate.frequency;
+        out.centsOffset = estimate.centsOffset;
+        out.confidence = estimate.confidence;
+        out.flags = (estimate.frequency > 0.0f ? STRUM_STRING_DETECTED : 0u) |
+                    (estimate.shared ? STRUM_STRING_SHARED : 0u);
+    }
+    box->publish(payload);
+}
+
+// --- Strobe Mailbox ---
+// Latest strobe reading at the selected target. The UI turns the strobe pattern by 'phase' and
+// extrapolates it with 'phaseVelocity' between frames. Payload offsets must match the
+// STROBE_PAYLOAD_* constants in TunerViewModel.
+constexpr uint32_t STROBE_MAILBOX_GATED = 1u;  // StrobePayload::flags: input below the RMS gate
+constexpr uint32_t STROBE_MAILBOX_LOCKED = 2u; // Cents, frequency and phaseVelocity are valid
+
+struct StrobePayload {
+    uint32_t flags;        // STROBE_MAILBOX_*
+    float targetFrequency; // Hz
+    float frequency;       // Hz, 0 until locked
+    float centsOffset;     // Versus targetFrequency
+    float phase;           // radians in [0, 2pi)
+    float phaseVelocity;   // radians/s of the fundamental
+    float confidence;      // 0..1
+    float rms;
+    int32_t bandCount;
+    uint32_t reserved;
+    int64_t timestampNanos; // CLOCK_MONOTONIC
+    float bandLevels[STROBE_MAX_HARMONICS]; // Band h + 1 amplitude over the input RMS
+};
+
+using StrobeMailbox = Mailbox<StrobePayload>;
+
+static_assert(sizeof(StrobeMailbox) == MAILBOX_PAYLOAD_OFFSET + sizeof(StrobePayload), "Mailbox layout mismatch");
+static_assert(offsetof(StrobePayload, phase) == 16, "Strobe payload layout mismatch");
+static_assert(offsetof(StrobePayload, bandCount) == 32, "Strobe payload layout mismatch");
+static_assert(offsetof(StrobePayload, timestampNanos) == 40, "Strobe payload layout mismatch");
+static_assert(sizeof(StrobePayload) == 48 + 4 * STROBE_MAX_HARMONICS, "Strobe payload layout mismatch");
+
+// Single writer only. Never blocks.
+inline void publishStrobeToMailbox(StrobeMailbox* box, const StrobeResult& result, int64_t timestampNanos) {
+    StrobePayload payload{};
+    payload.flags = (result.gated ? STROBE_MAILBOX_GATED : 0u) | (result.locked ? STROBE_MAILBOX_LOCKED : 0u);
+    payload.targetFrequency = result.targetFrequency;
+    payload.frequency = result.frequency;
+    payload.centsOffset = result.centsOffset;
+    payload.phase = result.phase;
+    payload.phaseVelocity = result.phaseVelocity;
+    payload.confidence = result.confidence;
+    payload.rms = result.rms;
+    payload.bandCount = result.bandCount;
+    payload.timestampNanos = timestampNanos;
+    for (int b = 0; b < result.bandCount && b < STROBE_MAX_HARMONICS; ++b) payload.bandLevels[b] = result.bandLevels[b];
+    box->publish(payload);
+}
+
+#endif // AFINADOR_RESULT_MAILBOX_H
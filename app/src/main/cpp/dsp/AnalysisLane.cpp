@@ -0,0 +1,250 @@
+#include "AnalysisLane.h"
+#include "DspLog.h"
+#include <algorithm>
+
+namespace {
+constexpr float STATE_COST_SMOOTHING = 0.05f; // Weight of the latest window in stateCostNanos_
+
+int64_t monotonicNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+}
+
+bool AnalysisLane::configure(int index, const AnalysisConfig& config, size_t ringCapacity) {
+    StrumConfig strumConfig;
+    strumConfig.sampleRate = config.sampleRate;
+    StrobeConfig strobeConfig;
+    strobeConfig.sampleRate = config.sampleRate;
+    strobeConfig.hopSize = config.hopSize; // One strobe reading per worker hop
+    if (!analyzer_.configure(config) || !strumAnalyzer_.configure(strumConfig) ||
+        !strobeAnalyzer_.configure(strobeConfig)) {
+        return false;
+    }
+    index_ = index;
+    input_ = std::make_unique<SpscRingBuffer<float>>(std::max(ringCapacity, 2 * static_cast<size_t>(config.windowSize)));
+    scratch_.assign(config.windowSize, 0.0f);
+    activeMode_ = AnalysisMode::Pitch; // configure() reset the pitch analyzer
+    hopBudgetNanos_ = static_cast<uint64_t>(1e9 * config.hopSize / config.sampleRate);
+    std::fill(std::begin(stateCostNanos_), std::end(stateCostNanos_), 0.0f);
+    metrics_.reset();
+    metrics_.fullAnalysisRateMilliHz.store(static_cast<int32_t>(1000LL * config.sampleRate / config.hopSize),
+                                           std::memory_order_relaxed);
+    publishSchedulerState();
+    // configure() cleared the settings; reapply the latest ones
+    candidatesChanged_ = true;
+    strumStringsChanged_ = true;
+    strobeTargetChanged_ = true;
+    dutyCycleChanged_ = true;
+    return true;
+}
+
+size_t AnalysisLane::write(const float* input, size_t count, size_t stride) {
+    return stride == 1 ? input_->write(input, count) : input_->writeStrided(input, count, stride);
+}
+
+void AnalysisLane::setCandidateRanges(const FrequencyRange* ranges, int count) {
+    count = std::max(0, std::min(count, MAX_CANDIDATE_RANGES));
+    {
+        std::lock_guard<std::mutex> lock(settingsMutex_);
+        std::copy(ranges, ranges + count, pendingCandidates_);
+        pendingCandidateCount_ = count;
+    }
+    candidatesChanged_ = true;
+}
+
+void AnalysisLane::setStrumStrings(const float* frequencies, int count) {
+    count = std::max(0, std::min(count, MAX_STRUM_STRINGS));
+    {
+        std::lock_guard<std::mutex> lock(settingsMutex_);
+        std::copy(frequencies, frequencies + count, pendingStrumStrings_);
+        pendingStrumStringCount_ = count;
+    }
+    strumStringsChanged_ = true;
+}
+
+void AnalysisLane::setStrobeTarget(float frequency) {
+    pendingStrobeTarget_.store(frequency);
+    strobeTargetChanged_ = true;
+}
+
+void AnalysisLane::setDutyCycle(const DutyCyclePolicy& policy) {
+    {
+        std::lock_guard<std::mutex> lock(settingsMutex_);
+        pendingDutyCycle_ = policy;
+    }
+    dutyCycleChanged_ = true;
+}
+
+LaneSettings AnalysisLane::settings() const {
+    LaneSettings settings;
+    settings.a4Frequency = a4Frequency_.load();
+    settings.strobeTarget = pendingStrobeTarget_.load();
+    std::lock_guard<std::mutex> lock(settingsMutex_);
+    std::copy(pendingCandidates_, pendingCandidates_ + pendingCandidateCount_, settings.candidates);
+    settings.candidateCount = pendingCandidateCount_;
+    std::copy(pendingStrumStrings_, pendingStrumStrings_ + pendingStrumStringCount_, settings.strumStrings);
+    settings.strumStringCount = pendingStrumStringCount_;
+    settings.dutyCycle = pendingDutyCycle_;
+    return settings;
+}
+
+void AnalysisLane::setSettings(const LaneSettings& settings) {
+    const LaneSettings current = this->settings();
+    if (settings.a4Frequency != current.a4Frequency) setA4(settings.a4Frequency);
+    if (settings.candidateCount != current.candidateCount ||
+        !std::equal(settings.candidates, settings.candidates + settings.candidateCount, current.candidates,
+                    [](const FrequencyRange& a, const FrequencyRange& b) {
+                        return a.minFrequency == b.minFrequency && a.maxFrequency == b.maxFrequency;
+                    })) {
+        setCandidateRanges(settings.candidates, settings.candidateCount);
+    }
+    if (settings.strumStringCount != current.strumStringCount ||
+        !std::equal(settings.strumStrings, settings.strumStrings + settings.strumStringCount, current.strumStrings)) {
+        setStrumStrings(settings.strumStrings, settings.strumStringCount);
+    }
+    if (settings.strobeTarget != current.strobeTarget) setStrobeTarget(settings.strobeTarget);
+    const DutyCyclePolicy& policy = settings.dutyCycle;
+    const DutyCyclePolicy& previous = current.dutyCycle;
+    if (policy.enabled != previous.enabled || policy.silentInterval != previous.silentInterval ||
+        policy.heldInterval != previous.heldInterval || policy.heldCents != previous.heldCents ||
+        policy.settleSeconds != previous.settleSeconds) {
+        setDutyCycle(policy);
+    }
+}
+
+std::chrono::nanoseconds AnalysisLane::hopDuration() const {
+    return std::chrono::nanoseconds(hopBudgetNanos_);
+}
+
+void AnalysisLane::applyPendingSettings() {
+    if (candidatesChanged_.exchange(false)) {
+        std::lock_guard<std::mutex> lock(settingsMutex_);
+        analyzer_.setCandidateRanges(pendingCandidates_, pendingCandidateCount_);
+    }
+    if (strumStringsChanged_.exchange(false)) {
+        std::lock_guard<std::mutex> lock(settingsMutex_);
+        strumAnalyzer_.setStrings(pendingStrumStrings_, pendingStrumStringCount_);
+    }
+    if (strobeTargetChanged_.exchange(false)) {
+        strobeAnalyzer_.setTarget(pendingStrobeTarget_.load());
+    }
+    if (dutyCycleChanged_.exchange(false)) {
+        std::lock_guard<std::mutex> lock(settingsMutex_);
+        scheduler_.configure(analyzer_.config(), pendingDutyCycle_);
+    }
+}
+
+AnalysisMode AnalysisLane::currentMode() const {
+    if (strumAnalyzer_.stringCount() > 0) return AnalysisMode::Strum;
+    if (strobeAnalyzer_.target() > 0.0f) return AnalysisMode::Strobe;
+    return AnalysisMode::Pitch;
+}
+
+// The analyzers of inactive modes stop advancing, so the one taking over starts afresh.
+void AnalysisLane::resetMode(AnalysisMode mode) {
+    switch (mode) {
+        case AnalysisMode::Strum: strumAnalyzer_.reset(); break;
+        case AnalysisMode::Strobe: strobeAnalyzer_.reset(); break;
+        default:
+            analyzer_.reset();
+            scheduler_.reset();
+            break;
+    }
+}
+
+// The other modes analyse every hop.
+void AnalysisLane::publishSchedulerState() {
+    const bool pitch = activeMode_ == AnalysisMode::Pitch;
+    const int32_t fullRate = metrics_.fullAnalysisRateMilliHz.load(std::memory_order_relaxed);
+    metrics_.schedulerState.store(static_cast<int32_t>(pitch ? scheduler_.state() : SchedulerState::Full),
+                                  std::memory_order_relaxed);
+    metrics_.analysisRateMilliHz.store(pitch ? fullRate / scheduler_.interval() : fullRate, std::memory_order_relaxed);
+}
+
+void AnalysisLane::countPitchResult(const PitchResult& result) {
+    if (result.gated) {
+        relaxedAdd(metrics_.gatedWindows, 1);
+    } else if (result.stage == AnalysisStage::Periodicity) {
+        relaxedAdd(metrics_.aperiodicWindows, 1);
+    } else if (result.noteIndex != NOTE_INDEX_NOT_AVAILABLE) {
+        relaxedAdd(metrics_.detectedWindows, 1);
+        if (result.stage == AnalysisStage::LocalSearch) relaxedAdd(metrics_.localSearchWindows, 1);
+    } else {
+        relaxedAdd(metrics_.rejectedWindows, 1);
+    }
+}
+
+bool AnalysisLane::analyseNext(AnalysisSink& sink) {
+    const AnalysisConfig& config = analyzer_.config();
+    const size_t windowSize = static_cast<size_t>(config.windowSize);
+    const size_t hopSize = static_cast<size_t>(config.hopSize);
+    const size_t available = input_->availableToRead();
+    if (available < hopSize) return false;
+
+    applyPendingSettings();
+    const AnalysisMode mode = currentMode();
+    if (mode != activeMode_) {
+        resetMode(mode);
+        activeMode_ = mode;
+        publishSchedulerState();
+    }
+    const int64_t analysisStart = monotonicNanos();
+    const float a4 = a4Frequency_.load();
+    bool produced = true;
+    const float* input = scratch_.data();
+    const SchedulerState state = scheduler_.state();
+    SchedulerState costState = state; // Where this window's analysis time is averaged in
+    if (available >= windowSize + hopSize) {
+        // Fell behind by more than a window: drop stale audio and analyse the newest window
+        relaxedAdd(metrics_.skippedBacklogs, 1);
+        input_->skip(available - windowSize);
+        input_->read(scratch_.data(), windowSize);
+        const int count = static_cast<int>(windowSize);
+        switch (mode) {
+            case AnalysisMode::Strum: produced = strumAnalyzer_.process(input, count, strumResult_); break;
+            case AnalysisMode::Strobe:
+                strobeAnalyzer_.reset(); // The skipped audio broke the phase history
+                produced = strobeAnalyzer_.process(input, count, strobeResult_);
+                break;
+            default: analyzer_.processWindow(input, a4, result_); break;
+        }
+    } else {
+        input_->read(scratch_.data(), hopSize);
+        const int count = static_cast<int>(hopSize);
+        switch (mode) {
+            case AnalysisMode::Strum: produced = strumAnalyzer_.process(input, count, strumResult_); break;
+            case AnalysisMode::Strobe: produced = strobeAnalyzer_.process(input, count, strobeResult_); break;
+            default:
+                if (!scheduler_.shouldAnalyse(input, count, analyzer_.gateThreshold())) {
+                    // Duty cycle: the hop only enters the window
+                    analyzer_.appendHop(input);
+                    const float skipNanos = static_cast<float>(monotonicNanos() - analysisStart);
+                    relaxedAdd(metrics_.dutyCycledHops, 1);
+                    const float saved = stateCostNanos_[static_cast<int>(state)] - skipNanos;
+                    if (saved > 0.0f) relaxedAdd(metrics_.cpuSavedNanos, static_cast<uint64_t>(saved));
+                    return true;
+                }
+                costState = scheduler_.state(); // An onset has already brought the full rate back
+                produced = analyzer_.processHop(input, a4, result_);
+                break;
+        }
+    }
+    const int64_t analysisNanos = monotonicNanos() - analysisStart;
+    metrics_.analysis.record(static_cast<uint64_t>(analysisNanos), hopBudgetNanos_);
+    if (!produced) return true;
+    switch (mode) {
+        case AnalysisMode::Strum: sink.onStrumResult(index_, strumResult_); break;
+        case AnalysisMode::Strobe: sink.onStrobeResult(index_, strobeResult_); break;
+        default: {
+            float& cost = stateCostNanos_[static_cast<int>(costState)];
+            cost = cost > 0.0f ? cost + STATE_COST_SMOOTHING * (analysisNanos - cost) : static_cast<float>(analysisNanos);
+            countPitchResult(result_);
+            scheduler_.onResult(result_);
+            if (scheduler_.state() != state) publishSchedulerState();
+            sink.onPitchResult(index_, result_);
+            break;
+        }
+    }
+    return true;
+}
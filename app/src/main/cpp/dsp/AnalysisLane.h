@@ -0,0 +1,120 @@
+#ifndef AFINADOR_ANALYSIS_LANE_H
+#define AFINADOR_ANALYSIS_LANE_H
+
+#include "AnalysisScheduler.h"
+#include "EngineMetrics.h"
+#include "PitchAnalyzer.h"
+#include "SpscRingBuffer.h"
+#include "StrobeAnalyzer.h"
+#include "StrumAnalyzer.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Receives a lane's results on the pool worker that analysed them. Implementations must not
+// block: the other lanes of that worker wait meanwhile.
+class AnalysisSink {
+public:
+    virtual ~AnalysisSink() = default;
+    virtual void onPitchResult(int lane, const PitchResult& result) = 0;
+    virtual void onStrumResult(int lane, const StrumResult& result) = 0;
+    virtual void onStrobeResult(int lane, const StrobeResult& result) = 0;
+};
+
+// Strum takes precedence over strobe; the single-note pipeline runs when neither is set.
+enum class AnalysisMode { Pitch, Strum, Strobe };
+
+// Everything a lane is told besides its AnalysisConfig, as last set
+struct LaneSettings {
+    float a4Frequency = 440.0f;
+    FrequencyRange candidates[MAX_CANDIDATE_RANGES] = {};
+    int candidateCount = 0;
+    float strumStrings[MAX_STRUM_STRINGS] = {};
+    int strumStringCount = 0; // 0: strum mode off
+    float strobeTarget = 0.0f; // 0: strobe mode off
+    DutyCyclePolicy dutyCycle;
+};
+
+// --- Analysis Lane ---
+// One analysed input channel: its input ring, the three analyzers and the settings handed over
+// to them. The audio callback only writes into the ring; the worker that owns the lane feeds the
+// analyzers one hop at a time, so window length and update rate do not depend on the device burst
+// size. In the single-note mode an AnalysisScheduler may skip the analysis of some hops. Settings
+// may be changed from any thread at any time, and survive configure(): the next run starts with
+// the latest ones.
+class AnalysisLane {
+public:
+    // Allocates the analyzers and an input ring of at least ringCapacity samples, and clears the
+    // metrics. 'index' is the lane number reported to the sink. Not while the lane is attached.
+    bool configure(int index, const AnalysisConfig& config, size_t ringCapacity);
+    int index() const { return index_; }
+    const AnalysisConfig& config() const { return analyzer_.config(); }
+
+    // --- Producer (audio callback) ---
+    // Appends 'count' samples taken every 'stride' values of 'input'. Returns how many fit; never
+    // blocks or allocates.
+    size_t write(const float* input, size_t count, size_t stride);
+    size_t queuedSamples() const { return input_ ? input_->availableToRead() : 0; }
+
+    // --- Settings (any thread, picked up by the worker before its next hop) ---
+    void setA4(float frequency) { a4Frequency_.store(frequency); }
+    float a4() const { return a4Frequency_.load(); }
+    void setCandidateRanges(const FrequencyRange* ranges, int count); // At most MAX_CANDIDATE_RANGES
+    void setStrumStrings(const float* frequencies, int count);        // At most MAX_STRUM_STRINGS
+    void setStrobeTarget(float frequency);
+    void setDutyCycle(const DutyCyclePolicy& policy);
+    LaneSettings settings() const;
+    // Applies every setting of 'settings' that differs from the current one; the others, and the
+    // analyzer state they hold, are left alone.
+    void setSettings(const LaneSettings& settings);
+
+    // --- Worker ---
+    // Analyses one hop (or the newest window after a backlog) if a hop is waiting and hands its
+    // result to 'sink'. Returns false when less than a hop was queued.
+    bool analyseNext(AnalysisSink& sink);
+    // Audio time of one hop: the owning worker polls about twice per hop
+    std::chrono::nanoseconds hopDuration() const;
+
+    LaneMetrics& metrics() { return metrics_; }
+    const LaneMetrics& metrics() const { return metrics_; }
+
+private:
+    void applyPendingSettings();
+    AnalysisMode currentMode() const;
+    void resetMode(AnalysisMode mode);
+    void countPitchResult(const PitchResult& result);
+    void publishSchedulerState();
+
+    int index_ = 0;
+    PitchAnalyzer analyzer_;
+    StrumAnalyzer strumAnalyzer_;
+    StrobeAnalyzer strobeAnalyzer_;
+    AnalysisScheduler scheduler_;
+    float stateCostNanos_[3] = {}; // Mean analysis time of a window in each SchedulerState
+    std::unique_ptr<SpscRingBuffer<float>> input_;
+    std::vector<float> scratch_; // One window, for reads from the ring
+    AnalysisMode activeMode_ = AnalysisMode::Pitch;
+    PitchResult result_;
+    StrumResult strumResult_;
+    StrobeResult strobeResult_;
+    uint64_t hopBudgetNanos_ = 0; // Each hop has to be analysed before the next one arrives
+    LaneMetrics metrics_;
+
+    // --- Pending settings ---
+    std::atomic<float> a4Frequency_{440.0f};
+    mutable std::mutex settingsMutex_; // Never taken on the audio thread
+    FrequencyRange pendingCandidates_[MAX_CANDIDATE_RANGES];
+    int pendingCandidateCount_ = 0;
+    std::atomic<bool> candidatesChanged_{false};
+    float pendingStrumStrings_[MAX_STRUM_STRINGS] = {};
+    int pendingStrumStringCount_ = 0;
+    std::atomic<bool> strumStringsChanged_{false};
+    std::atomic<float> pendingStrobeTarget_{0.0f};
+    std::atomic<bool> strobeTargetChanged_{false};
+    DutyCyclePolicy pendingDutyCycle_;
+    std::atomic<bool> dutyCycleChanged_{false};
+};
+
+#endif // AFINADOR_ANALYSIS_LANE_H
@@ -0,0 +1,78 @@
+#include "AnalysisScheduler.h"
+#include "SimdKernels.h"
+#include <algorithm>
+#include <cmath>
+
+void AnalysisScheduler::configure(const AnalysisConfig& config, const DutyCyclePolicy& policy) {
+    policy_ = policy;
+    policy_.silentInterval = std::max(1, policy.silentInterval);
+    policy_.heldInterval = std::max(1, policy.heldInterval);
+    const double hopsPerSecond = static_cast<double>(config.sampleRate) / config.hopSize;
+    settleWindows_ = std::max(1, static_cast<int>(std::lround(policy.settleSeconds * hopsPerSecond)));
+    maxInterval_ = std::max(1, static_cast<int>(DUTY_CYCLE_MAX_INTERVAL_SECONDS * hopsPerSecond));
+    envelopeRelease_ = std::pow(10.0f, -DUTY_CYCLE_ENVELOPE_RELEASE_DB_PER_SECOND / 20.0f /
+                                       static_cast<float>(hopsPerSecond));
+    reset();
+}
+
+void AnalysisScheduler::reset() {
+    state_ = SchedulerState::Full;
+    envelope_ = 0.0f;
+    hopsSinceAnalysis_ = 0;
+    quietWindows_ = 0;
+    heldFrequency_ = 0.0f;
+    steadyWindows_ = 0;
+}
+
+int AnalysisScheduler::interval() const {
+    switch (state_) {
+        case SchedulerState::Silent: return std::min(policy_.silentInterval, maxInterval_);
+        case SchedulerState::Held: return std::min(policy_.heldInterval, maxInterval_);
+        default: return 1;
+    }
+}
+
+void AnalysisScheduler::enter(SchedulerState state) {
+    state_ = state;
+    hopsSinceAnalysis_ = 0;
+}
+
+bool AnalysisScheduler::shouldAnalyse(const float* hop, int count, float gateThreshold) {
+    if (!policy_.enabled) return true;
+    const float rms = std::sqrt(dspKernels().sumOfSquares(hop, count) / count);
+    const bool onset = state_ == SchedulerState::Silent ? rms >= gateThreshold
+                                                        : rms > DUTY_CYCLE_ONSET_RATIO * envelope_;
+    envelope_ = std::max(rms, envelope_ * envelopeRelease_);
+    if (state_ == SchedulerState::Full) return true;
+    if (onset) {
+        enter(SchedulerState::Full);
+        quietWindows_ = 0;
+        steadyWindows_ = 0;
+        return true;
+    }
+    if (++hopsSinceAnalysis_ < interval()) return false;
+    hopsSinceAnalysis_ = 0;
+    return true;
+}
+
+void AnalysisScheduler::onResult(const PitchResult& result) {
+    if (!policy_.enabled) return;
+    if (result.noteIndex == NOTE_INDEX_NOT_AVAILABLE) {
+        heldFrequency_ = 0.0f;
+        steadyWindows_ = 0;
+        if (state_ == SchedulerState::Held) enter(SchedulerState::Full); // The note ended
+        if (state_ == SchedulerState::Full && ++quietWindows_ >= settleWindows_) enter(SchedulerState::Silent);
+        return;
+    }
+    quietWindows_ = 0;
+    const bool steady = heldFrequency_ > 0.0f &&
+                        std::fabs(1200.0f * std::log2(result.frequency / heldFrequency_)) <= policy_.heldCents;
+    if (!steady) {
+        // A new note, or the held one moved (e.g. the peg is being turned)
+        heldFrequency_ = result.frequency;
+        steadyWindows_ = 1;
+        if (state_ != SchedulerState::Full) enter(SchedulerState::Full);
+        return;
+    }
+    if (state_ == SchedulerState::Full && ++steadyWindows_ >= settleWindows_) enter(SchedulerState::Held);
+}
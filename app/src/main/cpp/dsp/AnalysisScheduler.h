@@ -0,0 +1,63 @@
+#ifndef AFINADOR_ANALYSIS_SCHEDULER_H
+#define AFINADOR_ANALYSIS_SCHEDULER_H
+
+#include "PitchAnalyzer.h"
+
+// --- Duty Cycle ---
+// While the input is silent or a note has been held steady, the pitch pipeline only analyses every
+// few hops; the skipped hops still enter the window. A cheap energy check on every hop brings the
+// full rate back at once on an onset: above the noise gate out of silence, or a jump of
+// DUTY_CYCLE_ONSET_RATIO over the input's peak envelope during a held note (a new pluck).
+constexpr float DUTY_CYCLE_ONSET_RATIO = 2.0f;               // 6 dB
+constexpr float DUTY_CYCLE_ENVELOPE_RELEASE_DB_PER_SECOND = 20.0f;
+constexpr float DUTY_CYCLE_MAX_INTERVAL_SECONDS = 0.05f;     // Results keep coming well within the UI's timeout
+
+struct DutyCyclePolicy {
+    bool enabled = false;
+    int silentInterval = 8;      // Hops per analysed window while silent
+    int heldInterval = 4;        // Hops per analysed window while a note is held
+    float heldCents = 1.0f;      // A held note stays within this of where it settled
+    float settleSeconds = 0.25f; // Silence, or a steady note, this long before the rate drops
+};
+
+enum class SchedulerState : int {
+    Full = 0, // Every hop analysed
+    Silent,   // No pitch for settleSeconds
+    Held      // The same pitch, within heldCents, for settleSeconds
+};
+
+// --- Analysis Scheduler ---
+// Decides, hop by hop, whether a lane's pitch pipeline analyses its window. Owned by the lane's
+// worker; never allocates.
+class AnalysisScheduler {
+public:
+    // Sizes the intervals for config's hop rate and goes back to the full rate.
+    void configure(const AnalysisConfig& config, const DutyCyclePolicy& policy);
+    void reset();
+
+    // Energy path, once per hop before it is analysed or only appended: false when the window
+    // may be skipped. 'gateThreshold' is the analyzer's current noise gate.
+    bool shouldAnalyse(const float* hop, int count, float gateThreshold);
+    // Every analysed window's result.
+    void onResult(const PitchResult& result);
+
+    SchedulerState state() const { return state_; }
+    // Hops per analysed window in the current state
+    int interval() const;
+
+private:
+    void enter(SchedulerState state);
+
+    DutyCyclePolicy policy_;
+    int settleWindows_ = 1;
+    int maxInterval_ = 1;
+    float envelopeRelease_ = 1.0f; // Peak envelope decay per hop
+    SchedulerState state_ = SchedulerState::Full;
+    float envelope_ = 0.0f;
+    int hopsSinceAnalysis_ = 0;
+    int quietWindows_ = 0;        // Analysed windows in a row without a pitch
+    float heldFrequency_ = 0.0f;  // Where the current steady stretch started
+    int steadyWindows_ = 0;
+};
+
+#endif // AFINADOR_ANALYSIS_SCHEDULER_H
@@ -0,0 +1,103 @@
+#include "AnalysisWorkerPool.h"
+#include <algorithm>
+
+namespace {
+constexpr std::chrono::nanoseconds MIN_POLL_INTERVAL = std::chrono::milliseconds(1);
+}
+
+AnalysisWorkerPool::AnalysisWorkerPool(int threadCount, ThreadHook onStart, ThreadHook onStop)
+    : onStart_(onStart), onStop_(onStop) {
+    threadCount = std::max(1, std::min(threadCount, MAX_POOL_THREADS));
+    for (int i = 0; i < threadCount; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    for (auto& worker : workers_) {
+        Worker* w = worker.get();
+        w->thread = std::thread([this, w] { run(*w); });
+    }
+}
+
+AnalysisWorkerPool::~AnalysisWorkerPool() {
+    for (auto& worker : workers_) {
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        worker->stopping = true;
+        worker->wake.notify_one();
+    }
+    for (auto& worker : workers_) {
+        if (worker->thread.joinable()) worker->thread.join();
+    }
+}
+
+int AnalysisWorkerPool::defaultThreadCount() {
+    const unsigned hardwareThreads = std::thread::hardware_concurrency();
+    return std::max(1, std::min(static_cast<int>(hardwareThreads), MAX_POOL_THREADS));
+}
+
+void AnalysisWorkerPool::attach(AnalysisLane& lane, AnalysisSink& sink) {
+    std::lock_guard<std::mutex> assignLock(assignMutex_);
+    Worker* target = nullptr;
+    size_t fewest = 0;
+    for (auto& worker : workers_) {
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        if (!target || worker->lanes.size() < fewest) {
+            target = worker.get();
+            fewest = worker->lanes.size();
+        }
+    }
+    std::lock_guard<std::mutex> lock(target->mutex);
+    target->lanes.push_back({&lane, &sink});
+    updatePollInterval(*target);
+    target->wake.notify_one();
+}
+
+void AnalysisWorkerPool::detach(AnalysisLane& lane) {
+    std::lock_guard<std::mutex> assignLock(assignMutex_);
+    for (auto& worker : workers_) {
+        std::unique_lock<std::mutex> lock(worker->mutex);
+        auto found = std::find_if(worker->lanes.begin(), worker->lanes.end(),
+                                  [&lane](const Assignment& a) { return a.lane == &lane; });
+        if (found == worker->lanes.end()) continue;
+        worker->lanes.erase(found);
+        updatePollInterval(*worker);
+        // A pass that started before the erase may still be analysing the lane
+        worker->passDone.wait(lock, [&worker] { return !worker->inPass; });
+        return;
+    }
+}
+
+// Twice per hop of the shortest-hop lane, so a hop never waits more than half its own duration.
+void AnalysisWorkerPool::updatePollInterval(Worker& worker) {
+    std::chrono::nanoseconds interval = std::chrono::nanoseconds::max();
+    for (const Assignment& a : worker.lanes) {
+        interval = std::min(interval, a.lane->hopDuration() / 2);
+    }
+    worker.pollInterval = std::max(interval, MIN_POLL_INTERVAL);
+}
+
+void AnalysisWorkerPool::run(Worker& worker) {
+    if (onStart_) onStart_();
+    std::vector<Assignment> pass; // The lanes of the current pass, analysed without the lock
+    std::unique_lock<std::mutex> lock(worker.mutex);
+    while (!worker.stopping) {
+        if (worker.lanes.empty()) {
+            worker.wake.wait(lock);
+            continue;
+        }
+        pass.assign(worker.lanes.begin(), worker.lanes.end());
+        worker.inPass = true;
+        lock.unlock();
+        // One hop per lane and pass, so a lane with a backlog cannot starve the others
+        bool analysed = false;
+        for (const Assignment& a : pass) {
+            analysed |= a.lane->analyseNext(*a.sink);
+        }
+        lock.lock();
+        worker.inPass = false;
+        worker.passDone.notify_all();
+        if (!analysed) {
+            worker.wake.wait_for(lock, worker.pollInterval);
+        }
+    }
+    lock.unlock();
+    if (onStop_) onStop_();
+}
@@ -0,0 +1,65 @@
+#ifndef AFINADOR_ANALYSIS_WORKER_POOL_H
+#define AFINADOR_ANALYSIS_WORKER_POOL_H
+
+#include "AnalysisLane.h"
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+constexpr int MAX_POOL_THREADS = 8;
+
+// --- Analysis Worker Pool ---
+// Threads that run the lanes of every engine instance. Each lane belongs to one worker, the one
+// with the fewest lanes when it was attached, so its analyzers stay single-threaded and, up to the
+// thread count, every lane gets a thread (and the scheduler a core) of its own. A worker polls its
+// lanes about twice per hop, since the audio callback never signals and stays lock-free, and
+// sleeps on a condition variable while it has none.
+class AnalysisWorkerPool {
+public:
+    // Run on every worker as it starts and before it exits (e.g. to attach it to a JVM).
+    using ThreadHook = void (*)();
+
+    explicit AnalysisWorkerPool(int threadCount, ThreadHook onStart = nullptr, ThreadHook onStop = nullptr);
+    ~AnalysisWorkerPool(); // Joins the workers; every lane must be detached by then
+    AnalysisWorkerPool(const AnalysisWorkerPool&) = delete;
+    AnalysisWorkerPool& operator=(const AnalysisWorkerPool&) = delete;
+
+    // One per hardware thread, at most MAX_POOL_THREADS.
+    static int defaultThreadCount();
+    int threadCount() const { return static_cast<int>(workers_.size()); }
+
+    // Starts analysing a configured lane, delivering its results to 'sink' until detach().
+    void attach(AnalysisLane& lane, AnalysisSink& sink);
+    // Returns once the lane's worker has left it. Never call it from a sink.
+    void detach(AnalysisLane& lane);
+
+private:
+    struct Assignment {
+        AnalysisLane* lane;
+        AnalysisSink* sink;
+    };
+
+    struct Worker {
+        std::thread thread;
+        std::mutex mutex; // Guards the fields below, released while the worker analyses
+        std::condition_variable wake;     // Lanes changed or the pool is stopping
+        std::condition_variable passDone; // The worker let go of the lanes of its last pass
+        std::vector<Assignment> lanes;
+        std::chrono::nanoseconds pollInterval{0};
+        bool inPass = false;
+        bool stopping = false;
+    };
+
+    void run(Worker& worker);
+    static void updatePollInterval(Worker& worker);
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::mutex assignMutex_; // Serialises attach/detach
+    ThreadHook onStart_;
+    ThreadHook onStop_;
+};
+
+#endif // AFINADOR_ANALYSIS_WORKER_POOL_H
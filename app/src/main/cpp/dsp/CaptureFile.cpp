@@ -0,0 +1,391 @@
+#include "CaptureFile.h"
+#include "DspLog.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <new>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+constexpr uint64_t FRAMES_PER_CALLBACK_RECORD = 32; // Smallest callback the records cover the sample ring for
+constexpr uint64_t MIN_CALLBACK_CAPACITY = 256;
+constexpr uint64_t SETTINGS_CAPACITY = 256; // Settings changes held, about 60 KB
+constexpr size_t SECTION_ALIGNMENT = 64;
+constexpr int MAX_CAPTURE_CHANNELS = 32;
+constexpr float MIN_LOCKED_CAPTURE_SECONDS = 1.0f; // Shorter than this, a capture runs unlocked instead
+
+size_t alignUp(size_t value) {
+    return (value + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+}
+
+// Byte offsets of the sections of a capture holding 'frameCapacity' frames.
+struct CaptureLayout {
+    uint64_t callbackCapacity;
+    size_t headerSize;
+    size_t settingsOffset;
+    size_t sampleOffset;
+    size_t size;
+};
+
+CaptureLayout captureLayout(uint64_t frameCapacity, int channelCount) {
+    CaptureLayout layout;
+    layout.callbackCapacity = std::max(MIN_CALLBACK_CAPACITY, frameCapacity / FRAMES_PER_CALLBACK_RECORD);
+    layout.headerSize = alignUp(sizeof(CaptureHeader));
+    layout.settingsOffset = layout.headerSize + alignUp(layout.callbackCapacity * sizeof(CaptureCallback));
+    layout.sampleOffset = layout.settingsOffset + alignUp(SETTINGS_CAPACITY * sizeof(CaptureSettingsChange));
+    layout.size = layout.sampleOffset + frameCapacity * channelCount * sizeof(float);
+    return layout;
+}
+
+// Bytes this process may lock, or SIZE_MAX without a limit.
+size_t lockableBytes() {
+    struct rlimit limit;
+    if (::getrlimit(RLIMIT_MEMLOCK, &limit) != 0 || limit.rlim_cur == RLIM_INFINITY) return SIZE_MAX;
+    return static_cast<size_t>(limit.rlim_cur);
+}
+
+// Frames [first, first + count) of the ring, split where it wraps.
+template <typename Sample, typename Copy>
+void forEachRingSpan(Sample* ring, uint64_t capacity, int channels, uint64_t first, uint64_t count, Copy copy) {
+    const uint64_t start = first % capacity;
+    const uint64_t head = std::min(count, capacity - start);
+    copy(ring + start * channels, 0, head);
+    if (head < count) copy(ring, head, count - head);
+}
+}
+
+// --- Lane Settings ---
+
+CaptureLaneSettings toCaptureSettings(const LaneSettings& settings) {
+    CaptureLaneSettings out{};
+    out.a4Frequency = settings.a4Frequency;
+    out.candidateCount = std::max(0, std::min(settings.candidateCount, MAX_CANDIDATE_RANGES));
+    for (int i = 0; i < out.candidateCount; ++i) {
+        out.candidates[2 * i] = settings.candidates[i].minFrequency;
+        out.candidates[2 * i + 1] = settings.candidates[i].maxFrequency;
+    }
+    out.strumStringCount = std::max(0, std::min(settings.strumStringCount, MAX_STRUM_STRINGS));
+    std::copy(settings.strumStrings, settings.strumStrings + out.strumStringCount, out.strumStrings);
+    out.strobeTarget = settings.strobeTarget;
+    out.dutyCycleEnabled = settings.dutyCycle.enabled ? 1 : 0;
+    out.silentInterval = settings.dutyCycle.silentInterval;
+    out.heldInterval = settings.dutyCycle.heldInterval;
+    out.heldCents = settings.dutyCycle.heldCents;
+    out.settleSeconds = settings.dutyCycle.settleSeconds;
+    return out;
+}
+
+LaneSettings fromCaptureSettings(const CaptureLaneSettings& settings) {
+    LaneSettings out;
+    out.a4Frequency = settings.a4Frequency;
+    out.candidateCount = std::max(0, std::min<int>(settings.candidateCount, MAX_CANDIDATE_RANGES));
+    for (int i = 0; i < out.candidateCount; ++i) {
+        out.candidates[i] = {settings.candidates[2 * i], settings.candidates[2 * i + 1]};
+    }
+    out.strumStringCount = std::max(0, std::min<int>(settings.strumStringCount, MAX_STRUM_STRINGS));
+    std::copy(settings.strumStrings, settings.strumStrings + out.strumStringCount, out.strumStrings);
+    out.strobeTarget = settings.strobeTarget;
+    out.dutyCycle.enabled = settings.dutyCycleEnabled != 0;
+    out.dutyCycle.silentInterval = settings.silentInterval;
+    out.dutyCycle.heldInterval = settings.heldInterval;
+    out.dutyCycle.heldCents = settings.heldCents;
+    out.dutyCycle.settleSeconds = settings.settleSeconds;
+    return out;
+}
+
+// --- Capture Writer ---
+
+bool CaptureWriter::open(const char* path, int sampleRate, int channelCount, float seconds,
+                         const AnalysisConfig& config, int framesPerBurst, int audioApi) {
+    close();
+    if (!path || sampleRate <= 0 || channelCount < 1 || channelCount > MAX_CAPTURE_CHANNELS ||
+        !(seconds > 0.0f) || !std::isfinite(seconds)) {
+        DSP_LOGE("Invalid capture: %d Hz, %d channel(s), %.1f s.", sampleRate, channelCount, seconds);
+        return false;
+    }
+    uint64_t frameCapacity = static_cast<uint64_t>(std::ceil(seconds * sampleRate));
+    CaptureLayout layout = captureLayout(frameCapacity, channelCount);
+    // Shorten the capture to what RLIMIT_MEMLOCK lets this process lock, unless that leaves too little
+    const size_t lockable = lockableBytes();
+    if (layout.size > lockable) {
+        // Past its minimum the callback ring adds 24 / FRAMES_PER_CALLBACK_RECORD (< 1) bytes per frame
+        const size_t fixed = captureLayout(0, channelCount).size + SECTION_ALIGNMENT;
+        const uint64_t frameBytes = static_cast<uint64_t>(channelCount) * sizeof(float) + 1;
+        const uint64_t lockableFrames = lockable > fixed ? (lockable - fixed) / frameBytes : 0;
+        if (lockableFrames >= static_cast<uint64_t>(MIN_LOCKED_CAPTURE_SECONDS * sampleRate)) {
+            frameCapacity = lockableFrames;
+            layout = captureLayout(frameCapacity, channelCount);
+            DSP_LOGW("Capture shortened to %.1f s to fit the %zu-byte memory lock limit.",
+                     static_cast<double>(frameCapacity) / sampleRate, lockable);
+        }
+    }
+    const size_t size = layout.size;
+
+    fd_ = ::open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        DSP_LOGE("Cannot create capture %s: %s.", path, std::strerror(errno));
+        return false;
+    }
+    // Reserve the blocks: writes into a sparse mapping raise SIGBUS when the disk fills up
+    const int allocated = ::posix_fallocate(fd_, 0, static_cast<off_t>(size));
+    if (allocated != 0) {
+        DSP_LOGE("Cannot reserve %zu bytes for capture %s: %s.", size, path, std::strerror(allocated));
+        close();
+        ::unlink(path);
+        return false;
+    }
+    void* mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (mapping == MAP_FAILED) {
+        DSP_LOGE("Cannot map capture %s: %s.", path, std::strerror(errno));
+        close();
+        ::unlink(path);
+        return false;
+    }
+    mapping_ = mapping;
+    mappingSize_ = size;
+    // Keep every page resident and touch it now, so the audio thread never faults one in
+    if (::mlock(mapping_, mappingSize_) != 0) {
+        DSP_LOGW("Cannot lock the %zu-byte capture in memory (%s); the audio thread may take page faults.",
+                 mappingSize_, std::strerror(errno));
+    }
+    std::memset(mapping_, 0, mappingSize_);
+    const uint64_t callbackCapacity = layout.callbackCapacity;
+    const size_t headerSize = layout.headerSize;
+    const size_t settingsOffset = layout.settingsOffset;
+    const size_t sampleOffset = layout.sampleOffset;
+
+    auto* bytes = static_cast<char*>(mapping_);
+    header_ = new (mapping_) CaptureHeader{};
+    callbacks_ = reinterpret_cast<CaptureCallback*>(bytes + headerSize);
+    settingsChanges_ = reinterpret_cast<CaptureSettingsChange*>(bytes + settingsOffset);
+    samples_ = reinterpret_cast<float*>(bytes + sampleOffset);
+    header_->version = CAPTURE_VERSION;
+    header_->headerSize = static_cast<uint32_t>(headerSize);
+    header_->sampleRate = sampleRate;
+    header_->channelCount = channelCount;
+    header_->frameCapacity = frameCapacity;
+    header_->callbackCapacity = callbackCapacity;
+    header_->callbackOffset = headerSize;
+    header_->sampleOffset = sampleOffset;
+    header_->settingsCapacity = SETTINGS_CAPACITY;
+    header_->settingsOffset = settingsOffset;
+    header_->framesPerBurst = framesPerBurst;
+    header_->audioApi = audioApi;
+    header_->windowSize = config.windowSize;
+    header_->hopSize = config.hopSize;
+    header_->differenceMethod = static_cast<int32_t>(config.method);
+    header_->lowRegisterDecimation = config.lowRegisterDecimation;
+    header_->lowRegisterWindowSize = config.lowRegisterWindowSize;
+    header_->gatingCascade = config.gatingCascade ? 1 : 0;
+    std::memcpy(header_->magic, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC)); // Last: a valid magic means a complete header
+    return true;
+}
+
+void CaptureWriter::close() {
+    if (mapping_) {
+        // Only schedules the writeback: the page cache keeps the data after munmap, and stopping
+        // the engine does not wait for the disk
+        ::msync(mapping_, mappingSize_, MS_ASYNC);
+        ::munmap(mapping_, mappingSize_); // Also unlocks the pages
+    }
+    if (fd_ >= 0) ::close(fd_);
+    fd_ = -1;
+    mapping_ = nullptr;
+    mappingSize_ = 0;
+    header_ = nullptr;
+    callbacks_ = nullptr;
+    settingsChanges_ = nullptr;
+    samples_ = nullptr;
+}
+
+void CaptureWriter::setLanes(int laneCount, const int* laneChannels, const LaneSettings* settings) {
+    if (!header_) return;
+    header_->laneCount = std::max(0, std::min(laneCount, CAPTURE_MAX_LANES));
+    for (int i = 0; i < header_->laneCount; ++i) {
+        header_->laneChannels[i] = laneChannels[i];
+        header_->laneSettings[i] = toCaptureSettings(settings[i]);
+    }
+}
+
+void CaptureWriter::recordSettings(int lane, const LaneSettings& settings) {
+    if (!header_ || lane < 0 || lane >= header_->laneCount) return;
+    const uint64_t index = header_->settingsWritten.load(std::memory_order_relaxed); // One writer at a time
+    CaptureSettingsChange& change = settingsChanges_[index % header_->settingsCapacity];
+    change.frame = header_->framesWritten.load(std::memory_order_acquire);
+    change.lane = lane;
+    change.settings = toCaptureSettings(settings);
+    header_->settingsWritten.store(index + 1, std::memory_order_release);
+}
+
+void CaptureWriter::append(const float* frames, int frameCount, int64_t timeNanos, int32_t xRunCount) {
+    if (!header_ || frameCount <= 0) return;
+    const uint64_t capacity = header_->frameCapacity;
+    if (static_cast<uint64_t>(frameCount) > capacity) {
+        header_->rejectedCallbacks.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    const int channels = header_->channelCount;
+    const uint64_t first = header_->framesWritten.load(std::memory_order_relaxed); // This thread is the only writer
+    forEachRingSpan(samples_, capacity, channels, first, static_cast<uint64_t>(frameCount),
+                    [&](float* span, uint64_t offset, uint64_t count) {
+                        std::memcpy(span, frames + offset * channels, count * channels * sizeof(float));
+                    });
+    const uint64_t index = header_->callbacksWritten.load(std::memory_order_relaxed);
+    callbacks_[index % header_->callbackCapacity] = {timeNanos, first, frameCount, xRunCount};
+    header_->framesWritten.store(first + frameCount, std::memory_order_release);
+    header_->callbacksWritten.store(index + 1, std::memory_order_release);
+}
+
+// --- Capture Reader ---
+
+bool CaptureReader::open(const char* path) {
+    close();
+    const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        DSP_LOGE("Cannot open capture %s: %s.", path, std::strerror(errno));
+        return false;
+    }
+    struct stat info;
+    void* mapping = MAP_FAILED;
+    if (::fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= sizeof(CaptureHeader)) {
+        mapping = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    ::close(fd); // The mapping keeps the file
+    if (mapping == MAP_FAILED) {
+        DSP_LOGE("Cannot map capture %s.", path);
+        return false;
+    }
+    mapping_ = mapping;
+    mappingSize_ = static_cast<size_t>(info.st_size);
+
+    const auto* header = static_cast<const CaptureHeader*>(mapping_);
+    const uint64_t channels = static_cast<uint64_t>(std::max(header->channelCount, 0));
+    const bool valid = std::memcmp(header->magic, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC)) == 0 &&
+                       header->version == CAPTURE_VERSION && header->sampleRate > 0 && channels >= 1 &&
+                       channels <= MAX_CAPTURE_CHANNELS && header->frameCapacity > 0 && header->callbackCapacity > 0 &&
+                       header->callbackOffset >= sizeof(CaptureHeader) &&
+                       header->callbackOffset % alignof(CaptureCallback) == 0 &&
+                       header->callbackCapacity <= (mappingSize_ - header->callbackOffset) / sizeof(CaptureCallback) &&
+                       header->settingsOffset >= header->callbackOffset + header->callbackCapacity * sizeof(CaptureCallback) &&
+                       header->settingsOffset % alignof(CaptureSettingsChange) == 0 && header->settingsCapacity > 0 &&
+                       header->settingsOffset <= mappingSize_ &&
+                       header->settingsCapacity <= (mappingSize_ - header->settingsOffset) / sizeof(CaptureSettingsChange) &&
+                       header->sampleOffset >= header->settingsOffset + header->settingsCapacity * sizeof(CaptureSettingsChange) &&
+                       header->sampleOffset % alignof(float) == 0 && header->sampleOffset <= mappingSize_ &&
+                       header->frameCapacity <= (mappingSize_ - header->sampleOffset) / (channels * sizeof(float)) &&
+                       header->laneCount >= 0 && header->laneCount <= CAPTURE_MAX_LANES &&
+                       std::all_of(header->laneChannels, header->laneChannels + header->laneCount,
+                                   [&](int32_t channel) { return channel >= 0 && channel < header->channelCount; });
+    if (!valid) {
+        DSP_LOGE("%s is not a version %u capture file.", path, CAPTURE_VERSION);
+        close();
+        return false;
+    }
+    header_ = header;
+    const auto* bytes = static_cast<const char*>(mapping_);
+    callbacks_ = reinterpret_cast<const CaptureCallback*>(bytes + header->callbackOffset);
+    settingsChanges_ = reinterpret_cast<const CaptureSettingsChange*>(bytes + header->settingsOffset);
+    samples_ = reinterpret_cast<const float*>(bytes + header->sampleOffset);
+
+    // Oldest callback whose record and frames have both survived the wrap
+    const uint64_t callbacks = header->callbacksWritten.load(std::memory_order_acquire);
+    const uint64_t frames = header->framesWritten.load(std::memory_order_acquire);
+    const uint64_t oldestFrame = frames > header->frameCapacity ? frames - header->frameCapacity : 0;
+    firstCallback_ = callbacks > header->callbackCapacity ? callbacks - header->callbackCapacity : 0;
+    while (firstCallback_ < callbacks &&
+           callbacks_[firstCallback_ % header->callbackCapacity].firstFrame < oldestFrame) {
+        ++firstCallback_;
+    }
+    callbackCount_ = static_cast<size_t>(callbacks - firstCallback_);
+    for (size_t i = 0; i < callbackCount_; ++i) {
+        const CaptureCallback& record = callback(i);
+        if (record.frameCount <= 0 || record.firstFrame + record.frameCount > frames) {
+            DSP_LOGE("Capture %s has a corrupt callback record at %zu.", path, i);
+            close();
+            return false;
+        }
+        maxFrameCount_ = std::max(maxFrameCount_, record.frameCount);
+    }
+
+    const uint64_t changes = header->settingsWritten.load(std::memory_order_acquire);
+    firstSettingsChange_ = changes > header->settingsCapacity ? changes - header->settingsCapacity : 0;
+    settingsChangeCount_ = static_cast<size_t>(changes - firstSettingsChange_);
+    for (size_t i = 0; i < settingsChangeCount_; ++i) {
+        const CaptureSettingsChange& change = settingsChange(i);
+        if (change.lane < 0 || change.lane >= header->laneCount || change.frame > frames ||
+            (i > 0 && change.frame < settingsChange(i - 1).frame)) {
+            DSP_LOGE("Capture %s has a corrupt settings change at %zu.", path, i);
+            close();
+            return false;
+        }
+    }
+    if (firstSettingsChange_ > 0) {
+        DSP_LOGW("Capture %s lost its %llu oldest settings change(s).", path,
+                 static_cast<unsigned long long>(firstSettingsChange_));
+    }
+    return true;
+}
+
+void CaptureReader::close() {
+    if (mapping_) ::munmap(mapping_, mappingSize_);
+    mapping_ = nullptr;
+    mappingSize_ = 0;
+    header_ = nullptr;
+    callbacks_ = nullptr;
+    settingsChanges_ = nullptr;
+    samples_ = nullptr;
+    firstCallback_ = 0;
+    callbackCount_ = 0;
+    maxFrameCount_ = 0;
+    firstSettingsChange_ = 0;
+    settingsChangeCount_ = 0;
+}
+
+AnalysisConfig CaptureReader::analysisConfig() const {
+    AnalysisConfig config;
+    config.sampleRate = header_->sampleRate;
+    config.windowSize = header_->windowSize;
+    config.hopSize = header_->hopSize;
+    config.lowRegisterDecimation = header_->lowRegisterDecimation;
+    config.lowRegisterWindowSize = header_->lowRegisterWindowSize;
+    config.gatingCascade = header_->gatingCascade != 0;
+    if (header_->differenceMethod == static_cast<int32_t>(DifferenceMethod::Fft)) {
+        config.method = DifferenceMethod::Fft;
+    } else if (header_->differenceMethod == static_cast<int32_t>(DifferenceMethod::Sliding)) {
+        config.method = DifferenceMethod::Sliding;
+    } else {
+        config.method = DifferenceMethod::Direct;
+    }
+    return config;
+}
+
+LaneSettings CaptureReader::laneSettings(int lane, uint64_t frame) const {
+    LaneSettings settings = fromCaptureSettings(header_->laneSettings[lane]);
+    for (size_t i = 0; i < settingsChangeCount_ && settingsChange(i).frame <= frame; ++i) {
+        if (settingsChange(i).lane == lane) settings = fromCaptureSettings(settingsChange(i).settings);
+    }
+    return settings;
+}
+
+const CaptureSettingsChange& CaptureReader::settingsChange(size_t index) const {
+    return settingsChanges_[(firstSettingsChange_ + index) % header_->settingsCapacity];
+}
+
+const CaptureCallback& CaptureReader::callback(size_t index) const {
+    return callbacks_[(firstCallback_ + index) % header_->callbackCapacity];
+}
+
+void CaptureReader::readFrames(size_t index, float* out) const {
+    const CaptureCallback& record = callback(index);
+    const int channels = header_->channelCount;
+    forEachRingSpan(samples_, header_->frameCapacity, channels, record.firstFrame,
+                    static_cast<uint64_t>(record.frameCount),
+                    [&](const float* span, uint64_t offset, uint64_t count) {
+                        std::memcpy(out + offset * channels, span, count * channels * sizeof(float));
+                    });
+}
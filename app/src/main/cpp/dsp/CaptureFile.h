@@ -0,0 +1,179 @@
+#ifndef AFINADOR_CAPTURE_FILE_H
+#define AFINADOR_CAPTURE_FILE_H
+
+#include "AnalysisLane.h"
+#include "PitchAnalyzer.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// --- Capture File Layout ---
+// Raw engine input as the audio callback saw it, for replaying field reports on a host. The file
+// is a header, a ring of per-callback records, a ring of lane settings changes and a ring of
+// interleaved float frames, all in native byte order (little-endian on every supported ABI). The
+// rings wrap: a capture keeps the newest frameCapacity frames.
+constexpr char CAPTURE_MAGIC[8] = {'A', 'F', 'C', 'A', 'P', 'T', 'R', '1'};
+constexpr uint32_t CAPTURE_VERSION = 2;
+constexpr int CAPTURE_MAX_LANES = 8; // At least MAX_ENGINE_LANES
+
+// A lane's LaneSettings in fixed-size fields
+struct CaptureLaneSettings {
+    float a4Frequency;
+    int32_t candidateCount;
+    float candidates[2 * MAX_CANDIDATE_RANGES]; // Min, max pairs in Hz
+    int32_t strumStringCount;
+    float strumStrings[MAX_STRUM_STRINGS];
+    float strobeTarget;
+    int32_t dutyCycleEnabled;
+    int32_t silentInterval;
+    int32_t heldInterval;
+    float heldCents;
+    float settleSeconds;
+};
+
+// Lane 'lane' was given 'settings' once 'frame' frames had been captured
+struct CaptureSettingsChange {
+    uint64_t frame;
+    int32_t lane;
+    int32_t reserved;
+    CaptureLaneSettings settings;
+};
+
+CaptureLaneSettings toCaptureSettings(const LaneSettings& settings);
+LaneSettings fromCaptureSettings(const CaptureLaneSettings& settings);
+
+struct CaptureHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    int32_t sampleRate;
+    int32_t channelCount;
+    uint64_t frameCapacity;      // Frames in the sample ring
+    uint64_t callbackCapacity;   // Records in the callback ring
+    uint64_t callbackOffset;     // Byte offsets from the start of the file
+    uint64_t sampleOffset;
+    uint64_t settingsCapacity;   // Records in the settings ring
+    uint64_t settingsOffset;
+    // Stream, detector and lanes at the start of the capture; replays default to them
+    int32_t framesPerBurst;
+    int32_t audioApi;
+    int32_t windowSize;
+    int32_t hopSize;
+    int32_t differenceMethod;
+    int32_t lowRegisterDecimation;
+    int32_t lowRegisterWindowSize;
+    int32_t gatingCascade;
+    int32_t laneCount; // 0: no lanes recorded
+    int32_t laneChannels[CAPTURE_MAX_LANES];
+    CaptureLaneSettings laneSettings[CAPTURE_MAX_LANES]; // Later changes are in the settings ring
+    // Advanced by the audio thread after each callback's frames and record are in place
+    std::atomic<uint64_t> framesWritten;
+    std::atomic<uint64_t> callbacksWritten;
+    std::atomic<uint64_t> rejectedCallbacks; // Larger than the whole sample ring, not captured
+    std::atomic<uint64_t> settingsWritten;   // Advanced by the thread changing the settings
+};
+
+struct CaptureCallback {
+    int64_t timeNanos;   // Steady clock at callback start
+    uint64_t firstFrame; // Frames captured before this callback
+    int32_t frameCount;
+    int32_t xRunCount;   // As reported by the stream, -1 if unknown
+};
+
+static_assert(sizeof(CaptureCallback) == 24, "Capture callback record layout mismatch");
+static_assert(sizeof(CaptureLaneSettings) == 212, "Capture settings layout mismatch");
+static_assert(sizeof(CaptureSettingsChange) == 232, "Capture settings layout mismatch");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Capture counters live in shared memory");
+
+// --- Capture Writer ---
+// Appends callbacks to a memory-mapped capture file. open() reserves the file's blocks, so a full
+// disk fails open() instead of raising SIGBUS in a later write, then mlocks and pre-faults the
+// mapping: append() is two memcpys into resident memory and a few stores, with no syscalls, locks
+// or disk reads on the audio thread. That holds only while the pages stay locked, so open()
+// shortens the capture to what RLIMIT_MEMLOCK allows. If that is under a second it keeps the
+// requested length unlocked and logs a warning: memory pressure may then evict pages and the
+// callback faults them back in. Even locked, a page the kernel has just written back costs a
+// minor fault, without I/O, on its next write. The kernel writes the pages back on its own;
+// close() schedules the rest without waiting for it.
+class CaptureWriter {
+public:
+    CaptureWriter() = default;
+    ~CaptureWriter() { close(); }
+    CaptureWriter(const CaptureWriter&) = delete;
+    CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+    // Creates (or truncates) 'path' for 'seconds' of 'channelCount'-channel input, or less to stay
+    // lockable (see above). 'config' is recorded for replays. Not on the audio thread. Returns false,
+    // leaving no file behind, if the disk cannot hold it.
+    bool open(const char* path, int sampleRate, int channelCount, float seconds, const AnalysisConfig& config,
+              int framesPerBurst = 0, int audioApi = 0);
+    void close();
+    bool isOpen() const { return header_ != nullptr; }
+
+    // Records the lanes analysing the input and their settings. Before the first append().
+    void setLanes(int laneCount, const int* laneChannels, const LaneSettings* settings);
+    // Records that lane 'lane' was given 'settings' at the current end of the capture. Not on the
+    // audio thread; one thread at a time.
+    void recordSettings(int lane, const LaneSettings& settings);
+
+    // Audio thread: records one callback of 'frameCount' interleaved frames.
+    void append(const float* frames, int frameCount, int64_t timeNanos, int32_t xRunCount);
+
+private:
+    int fd_ = -1;
+    void* mapping_ = nullptr;
+    size_t mappingSize_ = 0;
+    CaptureHeader* header_ = nullptr;
+    CaptureCallback* callbacks_ = nullptr;
+    CaptureSettingsChange* settingsChanges_ = nullptr;
+    float* samples_ = nullptr;
+};
+
+// --- Capture Reader ---
+// Read-only mapping of a capture file: the callbacks still held by both rings and the settings
+// changes still held by theirs, oldest first.
+class CaptureReader {
+public:
+    CaptureReader() = default;
+    ~CaptureReader() { close(); }
+    CaptureReader(const CaptureReader&) = delete;
+    CaptureReader& operator=(const CaptureReader&) = delete;
+
+    bool open(const char* path);
+    void close();
+
+    const CaptureHeader& header() const { return *header_; }
+    // Detector settings recorded with the capture
+    AnalysisConfig analysisConfig() const;
+    size_t callbackCount() const { return callbackCount_; }
+    int maxFrameCount() const { return maxFrameCount_; }
+    const CaptureCallback& callback(size_t index) const;
+    // Copies the frames of callback 'index' (frameCount * channelCount floats) into 'out'.
+    void readFrames(size_t index, float* out) const;
+
+    // Lanes recorded with the capture, and the input channel each analysed
+    int laneCount() const { return header_->laneCount; }
+    int laneChannel(int lane) const { return header_->laneChannels[lane]; }
+    // Settings of lane 'lane' once 'frame' frames had been captured: those of the latest change held
+    // up to then, or those at the start of the capture.
+    LaneSettings laneSettings(int lane, uint64_t frame) const;
+    size_t settingsChangeCount() const { return settingsChangeCount_; }
+    const CaptureSettingsChange& settingsChange(size_t index) const;
+    // Changes overwritten in the settings ring; lanes they changed may replay from stale settings
+    uint64_t lostSettingsChanges() const { return firstSettingsChange_; }
+
+private:
+    void* mapping_ = nullptr;
+    size_t mappingSize_ = 0;
+    const CaptureHeader* header_ = nullptr;
+    const CaptureCallback* callbacks_ = nullptr;
+    const CaptureSettingsChange* settingsChanges_ = nullptr;
+    const float* samples_ = nullptr;
+    uint64_t firstCallback_ = 0; // Absolute index of the oldest callback still held
+    size_t callbackCount_ = 0;
+    int maxFrameCount_ = 0;
+    uint64_t firstSettingsChange_ = 0;
+    size_t settingsChangeCount_ = 0;
+};
+
+#endif // AFINADOR_CAPTURE_FILE_H
@@ -0,0 +1,83 @@
+#include "CaptureReplay.h"
+#include "DspLog.h"
+#include <chrono>
+#include <thread>
+#include <vector>
+
+bool replayCapture(const CaptureReader& capture, TunerEngine& engine, const ReplayOptions& options,
+                   ReplayStats* stats) {
+    using Clock = std::chrono::steady_clock;
+    const CaptureHeader& header = capture.header();
+    if (engine.config().channelCount != header.channelCount) {
+        DSP_LOGE("Capture has %d channel(s), engine expects %d.", header.channelCount, engine.config().channelCount);
+        return false;
+    }
+    if (options.inlineSink && engine.isStarted()) {
+        DSP_LOGE("Inline replay needs an engine that is not started.");
+        return false;
+    }
+    const bool applySettings = options.captureSettings && capture.laneCount() > 0;
+    // Captured lane whose settings each lane follows
+    int sources[MAX_ENGINE_LANES] = {};
+    for (int lane = 0; lane < engine.laneCount(); ++lane) {
+        for (int captured = 0; captured < capture.laneCount(); ++captured) {
+            if (capture.laneChannel(captured) == engine.config().laneChannels[lane]) {
+                sources[lane] = captured;
+                break;
+            }
+        }
+    }
+    auto apply = [&](int captured, LaneSettings settings) {
+        if (options.a4Override > 0.0f) settings.a4Frequency = options.a4Override;
+        if (options.dutyCycleOverride) settings.dutyCycle = *options.dutyCycleOverride;
+        for (int lane = 0; lane < engine.laneCount(); ++lane) {
+            if (sources[lane] == captured) engine.setLaneSettings(lane, settings);
+        }
+    };
+    size_t nextChange = 0;
+    if (applySettings) {
+        const uint64_t firstFrame = capture.callbackCount() > 0 ? capture.callback(0).firstFrame : 0;
+        for (int captured = 0; captured < capture.laneCount(); ++captured) {
+            apply(captured, capture.laneSettings(captured, firstFrame));
+        }
+        while (nextChange < capture.settingsChangeCount() && capture.settingsChange(nextChange).frame <= firstFrame) {
+            ++nextChange;
+        }
+    }
+    size_t appliedChanges = 0;
+
+    std::vector<float> frames(static_cast<size_t>(capture.maxFrameCount()) * header.channelCount);
+    const auto start = Clock::now();
+    const int64_t firstNanos = capture.callbackCount() > 0 ? capture.callback(0).timeNanos : 0;
+    uint64_t replayedFrames = 0;
+
+    for (size_t i = 0; i < capture.callbackCount(); ++i) {
+        const CaptureCallback& record = capture.callback(i);
+        capture.readFrames(i, frames.data());
+        if (options.realtime) {
+            std::this_thread::sleep_until(start + std::chrono::nanoseconds(record.timeNanos - firstNanos));
+        }
+        for (; applySettings && nextChange < capture.settingsChangeCount() &&
+               capture.settingsChange(nextChange).frame <= record.firstFrame; ++nextChange, ++appliedChanges) {
+            const CaptureSettingsChange& change = capture.settingsChange(nextChange);
+            apply(change.lane, fromCaptureSettings(change.settings));
+        }
+        engine.processCallback(frames.data(), record.frameCount, record.xRunCount);
+        replayedFrames += static_cast<uint64_t>(record.frameCount);
+        if (options.inlineSink) {
+            for (int lane = 0; lane < engine.laneCount(); ++lane) {
+                while (engine.lane(lane).analyseNext(*options.inlineSink)) {
+                }
+            }
+        }
+    }
+
+    if (stats) {
+        stats->callbacks = capture.callbackCount();
+        stats->frames = replayedFrames;
+        stats->capturedSeconds = static_cast<double>(replayedFrames) / header.sampleRate;
+        stats->seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        stats->settingsChanges = appliedChanges;
+    }
+    return true;
+}
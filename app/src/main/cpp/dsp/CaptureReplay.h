@@ -0,0 +1,40 @@
+#ifndef AFINADOR_CAPTURE_REPLAY_H
+#define AFINADOR_CAPTURE_REPLAY_H
+
+#include "CaptureFile.h"
+#include "TunerEngine.h"
+
+struct ReplayOptions {
+    // Waits for each callback's captured time; otherwise callbacks follow each other at once
+    bool realtime = false;
+    // If set, the engine must not be started: after every callback this thread analyses each lane
+    // until less than a hop is queued, delivering to this sink. Results then depend only on the
+    // capture and the config. Otherwise the engine's worker pool analyses as on the device.
+    AnalysisSink* inlineSink = nullptr;
+    // Gives each lane the settings recorded for the captured lane that analysed the same channel
+    // (captured lane 0 if none did) and applies their changes at the frames they were made.
+    // Otherwise the lanes keep the settings they have.
+    bool captureSettings = true;
+    // Replace the captured A4 and duty cycle in every settings applied; 0 and null keep them
+    float a4Override = 0.0f;
+    const DutyCyclePolicy* dutyCycleOverride = nullptr;
+};
+
+struct ReplayStats {
+    size_t callbacks = 0;
+    uint64_t frames = 0;
+    double capturedSeconds = 0.0; // Audio time of the replayed frames
+    double seconds = 0.0;         // Wall time of the replay
+    size_t settingsChanges = 0;   // Captured settings changes applied during the replay
+};
+
+// --- Capture Replay ---
+// Feeds every callback held by 'capture', oldest first, through TunerEngine::processCallback with
+// its captured frame count and xrun count: the same path the Oboe callback takes. A settings change
+// is applied before the first callback captured after it, so in an inline replay it takes effect
+// from the first hop that callback completes. 'engine' must be configured for the capture's channel
+// count. Returns false if it is not.
+bool replayCapture(const CaptureReader& capture, TunerEngine& engine, const ReplayOptions& options,
+                   ReplayStats* stats = nullptr);
+
+#endif // AFINADOR_CAPTURE_REPLAY_H
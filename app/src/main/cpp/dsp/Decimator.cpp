@@ -0,0 +1,69 @@
+#include "Decimator.h"
+#include "DspLog.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr double kPi = 3.14159265358979323846;
+}
+
+bool Decimator::configure(int factor, int maxBlockSize) {
+    if (factor < 1 || maxBlockSize < 1) {
+        DSP_LOGE("Invalid decimator: factor %d, block %d.", factor, maxBlockSize);
+        return false;
+    }
+    factor_ = factor;
+    maxBlockSize_ = maxBlockSize;
+
+    // Windowed sinc, cutoff 0.8 * (0.5 / factor) cycles per input sample, unity gain at DC
+    const int tapCount = factor == 1 ? 1 : TAPS_PER_PHASE * factor;
+    const double cutoff = 0.4 / factor;
+    const double center = (tapCount - 1) / 2.0;
+    taps_.assign(tapCount, 1.0f);
+    if (tapCount > 1) {
+        double sum = 0.0;
+        std::vector<double> design(tapCount);
+        for (int k = 0; k < tapCount; ++k) {
+            double t = k - center;
+            double sinc = t == 0.0 ? 2.0 * cutoff : std::sin(2.0 * kPi * cutoff * t) / (kPi * t);
+            double window = 0.42 - 0.5 * std::cos(2.0 * kPi * k / (tapCount - 1)) +
+                            0.08 * std::cos(4.0 * kPi * k / (tapCount - 1));
+            design[k] = sinc * window;
+            sum += design[k];
+        }
+        for (int k = 0; k < tapCount; ++k) {
+            taps_[k] = static_cast<float>(design[k] / sum);
+        }
+    }
+    history_.assign(tapCount - 1 + maxBlockSize, 0.0f);
+    phase_ = 0;
+    return true;
+}
+
+void Decimator::reset() {
+    std::fill(history_.begin(), history_.end(), 0.0f);
+    phase_ = 0;
+}
+
+int Decimator::process(const float* input, int count, float* out) {
+    const int tapCount = static_cast<int>(taps_.size());
+    const int keep = tapCount - 1;
+    count = std::min(count, maxBlockSize_);
+    std::copy(input, input + count, history_.begin() + keep);
+
+    // Input i of this block is history_[keep + i]; its output uses the tapCount samples ending there
+    int produced = 0;
+    int i = phase_;
+    for (; i < count; i += factor_) {
+        const float* x = history_.data() + i;
+        float sum = 0.0f;
+        for (int k = 0; k < tapCount; ++k) {
+            sum += taps_[k] * x[k];
+        }
+        out[produced++] = sum;
+    }
+    phase_ = i - count;
+
+    std::copy(history_.begin() + count, history_.begin() + count + keep, history_.begin());
+    return produced;
+}
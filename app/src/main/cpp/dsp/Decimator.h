@@ -0,0 +1,33 @@
+#ifndef AFINADOR_DECIMATOR_H
+#define AFINADOR_DECIMATOR_H
+
+#include <vector>
+
+// Anti-alias FIR low-pass followed by downsampling by an integer factor. Only every factor-th
+// output is computed (the polyphase form's cost: TAPS_PER_PHASE multiply-adds per input sample).
+// The filter is a Blackman-windowed sinc with its cutoff at 80% of the output Nyquist frequency.
+class Decimator {
+public:
+    static constexpr int TAPS_PER_PHASE = 16;
+
+    // Designs the filter and sizes the history for blocks of up to maxBlockSize input samples.
+    bool configure(int factor, int maxBlockSize);
+    int factor() const { return factor_; }
+
+    // Clears the filter history.
+    void reset();
+
+    // Filters 'count' input samples (count <= maxBlockSize) and writes the decimated ones to
+    // 'out', which must hold count / factor() + 1 samples. Returns how many were written.
+    // Performs no allocations.
+    int process(const float* input, int count, float* out);
+
+private:
+    int factor_ = 1;
+    int maxBlockSize_ = 0;
+    std::vector<float> taps_;    // Symmetric, so the dot product can run forward over history_
+    std::vector<float> history_; // Last taps_.size() - 1 inputs, followed by the current block
+    int phase_ = 0;              // Input samples to skip before the next output
+};
+
+#endif // AFINADOR_DECIMATOR_H
@@ -0,0 +1,17 @@
+#ifndef AFINADOR_DSP_LOG_H
+#define AFINADOR_DSP_LOG_H
+
+// Logging for the DSP core: logcat on Android, stderr on host builds.
+#define DSP_LOG_TAG "AfinadorDsp"
+
+#ifdef __ANDROID__
+#include <android/log.h>
+#define DSP_LOGE(...) __android_log_print(ANDROID_LOG_ERROR, DSP_LOG_TAG, __VA_ARGS__)
+#define DSP_LOGW(...) __android_log_print(ANDROID_LOG_WARN, DSP_LOG_TAG, __VA_ARGS__)
+#else
+#include <cstdio>
+#define DSP_LOGE(...) (std::fprintf(stderr, "E/" DSP_LOG_TAG ": " __VA_ARGS__), std::fputc('\n', stderr))
+#define DSP_LOGW(...) (std::fprintf(stderr, "W/" DSP_LOG_TAG ": " __VA_ARGS__), std::fputc('\n', stderr))
+#endif
+
+#endif // AFINADOR_DSP_LOG_H
@@ -0,0 +1,204 @@
+#ifndef AFINADOR_ENGINE_METRICS_H
+#define AFINADOR_ENGINE_METRICS_H
+
+#include <atomic>
+#include <cstdint>
+
+// Lock-free runtime instrumentation for the audio engine. Every counter has a single writer
+// (the audio callback, or the worker that owns the lane), which updates it with relaxed load/store pairs:
+// no read-modify-write instructions and no locks on the real-time path. Readers (the snapshot
+// JNI call) may see the fields of a snapshot from slightly different moments, which is fine for
+// diagnostics.
+
+// Increment for counters with a single writer thread.
+inline void relaxedAdd(std::atomic<uint64_t>& counter, uint64_t amount) {
+    counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+// --- Latency Histogram ---
+// Bucket b counts durations in [2^b, 2^(b+1)) microseconds; bucket 0 also takes anything below
+// 1 us and the last bucket everything from 2^(LATENCY_HISTOGRAM_BUCKETS - 1) us (about 33 ms) up.
+constexpr int LATENCY_HISTOGRAM_BUCKETS = 16;
+
+struct LatencyHistogram {
+    std::atomic<uint64_t> buckets[LATENCY_HISTOGRAM_BUCKETS];
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> totalNanos;
+    std::atomic<uint64_t> maxNanos;
+    std::atomic<uint64_t> totalBudgetNanos; // Sum of the deadlines the measured work had to meet
+    std::atomic<uint32_t> peakLoadPermille; // Highest duration / deadline seen, in 1/1000
+
+    void reset() {
+        for (auto& bucket : buckets) bucket.store(0, std::memory_order_relaxed);
+        count.store(0, std::memory_order_relaxed);
+        totalNanos.store(0, std::memory_order_relaxed);
+        maxNanos.store(0, std::memory_order_relaxed);
+        totalBudgetNanos.store(0, std::memory_order_relaxed);
+        peakLoadPermille.store(0, std::memory_order_relaxed);
+    }
+
+    // Single writer only.
+    void record(uint64_t nanos, uint64_t budgetNanos) {
+        const uint64_t micros = nanos / 1000;
+        int bucket = micros > 1 ? 63 - __builtin_clzll(micros) : 0;
+        if (bucket >= LATENCY_HISTOGRAM_BUCKETS) bucket = LATENCY_HISTOGRAM_BUCKETS - 1;
+        relaxedAdd(buckets[bucket], 1);
+        relaxedAdd(count, 1);
+        relaxedAdd(totalNanos, nanos);
+        relaxedAdd(totalBudgetNanos, budgetNanos);
+        if (nanos > maxNanos.load(std::memory_order_relaxed)) {
+            maxNanos.store(nanos, std::memory_order_relaxed);
+        }
+        if (budgetNanos > 0) {
+            const uint64_t load = nanos * 1000 / budgetNanos;
+            const uint32_t permille = load > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(load);
+            if (permille > peakLoadPermille.load(std::memory_order_relaxed)) {
+                peakLoadPermille.store(permille, std::memory_order_relaxed);
+            }
+        }
+    }
+};
+
+// --- Engine Metrics ---
+// One per engine instance: its stream and audio callback.
+struct EngineMetrics {
+    // Negotiated stream parameters, written on the JNI thread before the stream starts
+    std::atomic<int32_t> sampleRate;
+    std::atomic<int32_t> framesPerBurst;
+    std::atomic<int32_t> framesPerCallback;  // 0 = variable (device burst)
+    std::atomic<int32_t> bufferSizeFrames;
+    std::atomic<int32_t> sharingMode;        // oboe::SharingMode
+    std::atomic<int32_t> audioApi;           // oboe::AudioApi
+
+    // Audio callback
+    LatencyHistogram callback;
+    std::atomic<int32_t> xRunCount;          // As reported by the stream, -1 when unsupported
+    std::atomic<uint64_t> droppedInputFrames; // Lane input rings were full, summed over the lanes
+
+    void reset() {
+        sampleRate.store(0, std::memory_order_relaxed);
+        framesPerBurst.store(0, std::memory_order_relaxed);
+        framesPerCallback.store(0, std::memory_order_relaxed);
+        bufferSizeFrames.store(0, std::memory_order_relaxed);
+        sharingMode.store(0, std::memory_order_relaxed);
+        audioApi.store(0, std::memory_order_relaxed);
+        callback.reset();
+        xRunCount.store(-1, std::memory_order_relaxed);
+        droppedInputFrames.store(0, std::memory_order_relaxed);
+    }
+};
+
+// --- Lane Metrics ---
+// One per analysed channel, written by the pool worker that runs the lane.
+struct LaneMetrics {
+    LatencyHistogram analysis;
+    std::atomic<uint64_t> skippedBacklogs;   // Times the worker fell a window behind and skipped ahead
+    std::atomic<uint64_t> gatedWindows;      // Below the noise gate
+    std::atomic<uint64_t> aperiodicWindows;  // Stopped by the periodicity pre-check, YIN skipped
+    std::atomic<uint64_t> detectedWindows;   // A note was found
+    std::atomic<uint64_t> localSearchWindows; // Detected by the search around the held note alone
+    std::atomic<uint64_t> rejectedWindows;   // YIN ran, but no clear pitch
+    // Duty cycle (see AnalysisScheduler.h); hops it skips are not in the analysis histogram
+    std::atomic<int32_t> schedulerState;          // SchedulerState
+    std::atomic<int32_t> fullAnalysisRateMilliHz; // One window per hop
+    std::atomic<int32_t> analysisRateMilliHz;     // Current rate: the full rate over the scheduler's interval
+    std::atomic<uint64_t> dutyCycledHops;         // Appended to the window without analysing it
+    std::atomic<uint64_t> cpuSavedNanos;          // Estimated: what the skipped windows would have cost,
+                                                  // less the energy check and append that replaced them
+
+    void reset() {
+        analysis.reset();
+        skippedBacklogs.store(0, std::memory_order_relaxed);
+        gatedWindows.store(0, std::memory_order_relaxed);
+        aperiodicWindows.store(0, std::memory_order_relaxed);
+        detectedWindows.store(0, std::memory_order_relaxed);
+        localSearchWindows.store(0, std::memory_order_relaxed);
+        rejectedWindows.store(0, std::memory_order_relaxed);
+        schedulerState.store(0, std::memory_order_relaxed);
+        fullAnalysisRateMilliHz.store(0, std::memory_order_relaxed);
+        analysisRateMilliHz.store(0, std::memory_order_relaxed);
+        dutyCycledHops.store(0, std::memory_order_relaxed);
+        cpuSavedNanos.store(0, std::memory_order_relaxed);
+    }
+};
+
+// --- Snapshot Layout ---
+// Flat int64 array handed to Kotlin, one per lane (the stream fields are shared by the lanes of an
+// instance); indices must match the METRICS_* constants in TunerViewModel. Each histogram is its
+// summary fields followed by its buckets.
+
+// Histogram summary offsets, relative to METRICS_*_HISTOGRAM
+enum HistogramField : int {
+    HISTOGRAM_COUNT = 0,
+    HISTOGRAM_TOTAL_NANOS,
+    HISTOGRAM_MAX_NANOS,
+    HISTOGRAM_TOTAL_BUDGET_NANOS,
+    HISTOGRAM_PEAK_LOAD_PERMILLE,
+    HISTOGRAM_RESERVED,
+    HISTOGRAM_BUCKETS
+};
+
+enum MetricsField : int {
+    METRICS_SAMPLE_RATE = 0,
+    METRICS_FRAMES_PER_BURST,
+    METRICS_FRAMES_PER_CALLBACK,
+    METRICS_BUFFER_SIZE_FRAMES,
+    METRICS_SHARING_MODE,
+    METRICS_AUDIO_API,
+    METRICS_XRUN_COUNT,
+    METRICS_DROPPED_INPUT_FRAMES,
+    METRICS_SKIPPED_BACKLOGS,
+    METRICS_GATED_WINDOWS,
+    METRICS_DETECTED_WINDOWS,
+    METRICS_REJECTED_WINDOWS,
+    METRICS_APERIODIC_WINDOWS,
+    METRICS_LOCAL_SEARCH_WINDOWS,
+    METRICS_CALLBACK_HISTOGRAM,
+    METRICS_ANALYSIS_HISTOGRAM = METRICS_CALLBACK_HISTOGRAM + HISTOGRAM_BUCKETS + LATENCY_HISTOGRAM_BUCKETS,
+    // Duty cycle, after the histograms so that earlier fields keep their indices
+    METRICS_SCHEDULER_STATE = METRICS_ANALYSIS_HISTOGRAM + HISTOGRAM_BUCKETS + LATENCY_HISTOGRAM_BUCKETS,
+    METRICS_FULL_ANALYSIS_RATE_MILLIHZ,
+    METRICS_ANALYSIS_RATE_MILLIHZ,
+    METRICS_DUTY_CYCLED_HOPS,
+    METRICS_CPU_SAVED_NANOS,
+    METRICS_FIELD_COUNT
+};
+
+inline void writeHistogramSnapshot(const LatencyHistogram& histogram, int64_t* out) {
+    out[HISTOGRAM_COUNT] = static_cast<int64_t>(histogram.count.load(std::memory_order_relaxed));
+    out[HISTOGRAM_TOTAL_NANOS] = static_cast<int64_t>(histogram.totalNanos.load(std::memory_order_relaxed));
+    out[HISTOGRAM_MAX_NANOS] = static_cast<int64_t>(histogram.maxNanos.load(std::memory_order_relaxed));
+    out[HISTOGRAM_TOTAL_BUDGET_NANOS] = static_cast<int64_t>(histogram.totalBudgetNanos.load(std::memory_order_relaxed));
+    out[HISTOGRAM_PEAK_LOAD_PERMILLE] = histogram.peakLoadPermille.load(std::memory_order_relaxed);
+    out[HISTOGRAM_RESERVED] = 0;
+    for (int b = 0; b < LATENCY_HISTOGRAM_BUCKETS; ++b) {
+        out[HISTOGRAM_BUCKETS + b] = static_cast<int64_t>(histogram.buckets[b].load(std::memory_order_relaxed));
+    }
+}
+
+// 'out' must hold METRICS_FIELD_COUNT values.
+inline void writeMetricsSnapshot(const EngineMetrics& metrics, const LaneMetrics& lane, int64_t* out) {
+    out[METRICS_SAMPLE_RATE] = metrics.sampleRate.load(std::memory_order_relaxed);
+    out[METRICS_FRAMES_PER_BURST] = metrics.framesPerBurst.load(std::memory_order_relaxed);
+    out[METRICS_FRAMES_PER_CALLBACK] = metrics.framesPerCallback.load(std::memory_order_relaxed);
+    out[METRICS_BUFFER_SIZE_FRAMES] = metrics.bufferSizeFrames.load(std::memory_order_relaxed);
+    out[METRICS_SHARING_MODE] = metrics.sharingMode.load(std::memory_order_relaxed);
+    out[METRICS_AUDIO_API] = metrics.audioApi.load(std::memory_order_relaxed);
+    out[METRICS_XRUN_COUNT] = metrics.xRunCount.load(std::memory_order_relaxed);
+    out[METRICS_DROPPED_INPUT_FRAMES] = static_cast<int64_t>(metrics.droppedInputFrames.load(std::memory_order_relaxed));
+    out[METRICS_SKIPPED_BACKLOGS] = static_cast<int64_t>(lane.skippedBacklogs.load(std::memory_order_relaxed));
+    out[METRICS_GATED_WINDOWS] = static_cast<int64_t>(lane.gatedWindows.load(std::memory_order_relaxed));
+    out[METRICS_DETECTED_WINDOWS] = static_cast<int64_t>(lane.detectedWindows.load(std::memory_order_relaxed));
+    out[METRICS_REJECTED_WINDOWS] = static_cast<int64_t>(lane.rejectedWindows.load(std::memory_order_relaxed));
+    out[METRICS_APERIODIC_WINDOWS] = static_cast<int64_t>(lane.aperiodicWindows.load(std::memory_order_relaxed));
+    out[METRICS_LOCAL_SEARCH_WINDOWS] = static_cast<int64_t>(lane.localSearchWindows.load(std::memory_order_relaxed));
+    writeHistogramSnapshot(metrics.callback, out + METRICS_CALLBACK_HISTOGRAM);
+    writeHistogramSnapshot(lane.analysis, out + METRICS_ANALYSIS_HISTOGRAM);
+    out[METRICS_SCHEDULER_STATE] = lane.schedulerState.load(std::memory_order_relaxed);
+    out[METRICS_FULL_ANALYSIS_RATE_MILLIHZ] = lane.fullAnalysisRateMilliHz.load(std::memory_order_relaxed);
+    out[METRICS_ANALYSIS_RATE_MILLIHZ] = lane.analysisRateMilliHz.load(std::memory_order_relaxed);
+    out[METRICS_DUTY_CYCLED_HOPS] = static_cast<int64_t>(lane.dutyCycledHops.load(std::memory_order_relaxed));
+    out[METRICS_CPU_SAVED_NANOS] = static_cast<int64_t>(lane.cpuSavedNanos.load(std::memory_order_relaxed));
+}
+
+#endif // AFINADOR_ENGINE_METRICS_H
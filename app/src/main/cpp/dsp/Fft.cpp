@@ -0,0 +1,105 @@
+#include "Fft.h"
+#include <cmath>
+#include <utility>
+
+namespace {
+constexpr double kTwoPi = 6.283185307179586476925286766559;
+}
+
+int RealFft::nextPowerOfTwo(int value) {
+    int result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+RealFft::RealFft(int size)
+        : size_(nextPowerOfTwo(size < 4 ? 4 : size)),
+          halfSize_(size_ / 2),
+          bitReversal_(halfSize_),
+          twiddles_(halfSize_ / 2),
+          realTwiddles_(halfSize_ + 1),
+          work_(halfSize_) {
+    // Bit reversal table for the N/2-point complex transform
+    int bits = 0;
+    while ((1 << bits) < halfSize_) {
+        ++bits;
+    }
+    for (int i = 0; i < halfSize_; ++i) {
+        int reversed = 0;
+        for (int b = 0; b < bits; ++b) {
+            if (i & (1 << b)) reversed |= 1 << (bits - 1 - b);
+        }
+        bitReversal_[i] = reversed;
+    }
+    // Twiddles are computed in double precision to keep the float tables accurate
+    for (int k = 0; k < halfSize_ / 2; ++k) {
+        double angle = -kTwoPi * k / halfSize_;
+        twiddles_[k] = std::complex<float>(static_cast<float>(std::cos(angle)), static_cast<float>(std::sin(angle)));
+    }
+    for (int k = 0; k <= halfSize_; ++k) {
+        double angle = -kTwoPi * k / size_;
+        realTwiddles_[k] = std::complex<float>(static_cast<float>(std::cos(angle)), static_cast<float>(std::sin(angle)));
+    }
+}
+
+void RealFft::complexTransform(std::complex<float>* data, bool inverse) const {
+    const int n = halfSize_;
+    for (int i = 0; i < n; ++i) {
+        int j = bitReversal_[i];
+        if (j > i) std::swap(data[i], data[j]);
+    }
+    // Iterative Cooley-Tukey butterflies
+    for (int length = 2; length <= n; length <<= 1) {
+        const int half = length / 2;
+        const int twiddleStride = n / length;
+        for (int start = 0; start < n; start += length) {
+            for (int k = 0; k < half; ++k) {
+                std::complex<float> w = twiddles_[k * twiddleStride];
+                if (inverse) w = std::conj(w);
+                std::complex<float> odd = data[start + k + half] * w;
+                std::complex<float> even = data[start + k];
+                data[start + k] = even + odd;
+                data[start + k + half] = even - odd;
+            }
+        }
+    }
+}
+
+void RealFft::forward(const float* input, std::complex<float>* spectrum) {
+    const int n = halfSize_;
+    // Pack even samples into the real part and odd samples into the imaginary part
+    for (int i = 0; i < n; ++i) {
+        work_[i] = std::complex<float>(input[2 * i], input[2 * i + 1]);
+    }
+    complexTransform(work_.data(), false);
+
+    // Split the packed spectrum into the spectra of the even and odd samples and recombine
+    for (int k = 0; k <= n; ++k) {
+        std::complex<float> zk = work_[k == n ? 0 : k];
+        std::complex<float> zn = std::conj(work_[k == 0 ? 0 : n - k]);
+        std::complex<float> even = 0.5f * (zk + zn);
+        std::complex<float> odd = std::complex<float>(0.0f, -0.5f) * (zk - zn);
+        spectrum[k] = even + realTwiddles_[k] * odd;
+    }
+}
+
+void RealFft::inverse(const std::complex<float>* spectrum, float* output) {
+    const int n = halfSize_;
+    // Undo the split step to rebuild the packed N/2-point spectrum
+    for (int k = 0; k < n; ++k) {
+        std::complex<float> xk = spectrum[k];
+        std::complex<float> xn = std::conj(spectrum[n - k]);
+        std::complex<float> even = 0.5f * (xk + xn);
+        std::complex<float> odd = 0.5f * (xk - xn) * std::conj(realTwiddles_[k]);
+        work_[k] = even + std::complex<float>(0.0f, 1.0f) * odd;
+    }
+    complexTransform(work_.data(), true);
+
+    const float scale = 1.0f / static_cast<float>(n);
+    for (int i = 0; i < n; ++i) {
+        output[2 * i] = work_[i].real() * scale;
+        output[2 * i + 1] = work_[i].imag() * scale;
+    }
+}
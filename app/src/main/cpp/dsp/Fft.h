@@ -0,0 +1,37 @@
+#ifndef AFINADOR_FFT_H
+#define AFINADOR_FFT_H
+
+#include <complex>
+#include <vector>
+
+// Radix-2 FFT for real input signals.
+// The transform size must be a power of two (>= 4). A real signal of size N is packed into
+// an N/2-point complex FFT, so a forward/inverse pair costs about half of a full complex FFT.
+class RealFft {
+public:
+    explicit RealFft(int size);
+
+    int size() const { return size_; }
+
+    // Forward transform: 'input' holds size() real samples, 'spectrum' receives size()/2 + 1 bins.
+    void forward(const float* input, std::complex<float>* spectrum);
+
+    // Inverse transform: 'spectrum' holds size()/2 + 1 bins, 'output' receives size() real samples.
+    // The result is scaled by 1/size(), so inverse(forward(x)) == x.
+    void inverse(const std::complex<float>* spectrum, float* output);
+
+    static bool isPowerOfTwo(int value) { return value > 0 && (value & (value - 1)) == 0; }
+    static int nextPowerOfTwo(int value);
+
+private:
+    void complexTransform(std::complex<float>* data, bool inverse) const;
+
+    int size_;
+    int halfSize_;
+    std::vector<int> bitReversal_;               // Permutation for the N/2-point complex FFT
+    std::vector<std::complex<float>> twiddles_;  // exp(-2*pi*i*k/(N/2)), k < N/4
+    std::vector<std::complex<float>> realTwiddles_; // exp(-2*pi*i*k/N), k <= N/2 (real split step)
+    std::vector<std::complex<float>> work_;      // N/2 complex scratch values
+};
+
+#endif // AFINADOR_FFT_H
@@ -0,0 +1,117 @@
+#include "NoteMapping.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+// --- Compile-Time Tables ---
+// Note mapping runs for every analysed window, so it uses tables generated by the compiler
+// instead of powf/log2f: frequency ratios of the 12 semitones, and log2 over one octave.
+constexpr int LOG2_TABLE_BITS = 10; // Linear interpolation error below 0.001 cents
+constexpr int LOG2_TABLE_SIZE = 1 << LOG2_TABLE_BITS;
+
+// Natural logarithm for x in [1, 2]: ln(x) = 2 * atanh((x - 1) / (x + 1)), |z| <= 1/3.
+static constexpr double constexprLn(double x) {
+    const double z = (x - 1.0) / (x + 1.0);
+    const double z2 = z * z;
+    double term = z;
+    double sum = 0.0;
+    for (int k = 0; k < 40; ++k) {
+        sum += term / (2 * k + 1);
+        term *= z2;
+    }
+    return 2.0 * sum;
+}
+
+struct SemitoneRatioTable {
+    float values[12]; // 2^(k/12)
+};
+
+struct Log2Table {
+    float values[LOG2_TABLE_SIZE + 1]; // log2(1 + k / LOG2_TABLE_SIZE)
+};
+
+static constexpr SemitoneRatioTable makeSemitoneRatioTable() {
+    SemitoneRatioTable table = {};
+    double ratio = 1.0;
+    for (int k = 0; k < 12; ++k) {
+        table.values[k] = static_cast<float>(ratio);
+        ratio *= TWELFTH_ROOT_OF_TWO;
+    }
+    return table;
+}
+
+static constexpr Log2Table makeLog2Table() {
+    Log2Table table = {};
+    const double ln2 = constexprLn(2.0);
+    for (int k = 0; k <= LOG2_TABLE_SIZE; ++k) {
+        table.values[k] = static_cast<float>(constexprLn(1.0 + static_cast<double>(k) / LOG2_TABLE_SIZE) / ln2);
+    }
+    return table;
+}
+
+static constexpr SemitoneRatioTable kSemitoneRatios = makeSemitoneRatioTable();
+static constexpr Log2Table kLog2 = makeLog2Table();
+
+static_assert(kLog2.values[0] == 0.0f && kLog2.values[LOG2_TABLE_SIZE] == 1.0f, "log2 table endpoints");
+
+// log2 for positive, normal x: exponent from the float bits, mantissa from the table.
+static inline float fastLog2(float x) {
+    uint32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    const int exponent = static_cast<int>((bits >> 23) & 0xFF) - 127;
+    const uint32_t mantissa = bits & 0x7FFFFF;
+    const int index = static_cast<int>(mantissa >> (23 - LOG2_TABLE_BITS));
+    const float fraction = static_cast<float>(mantissa & ((1u << (23 - LOG2_TABLE_BITS)) - 1)) *
+                           (1.0f / static_cast<float>(1u << (23 - LOG2_TABLE_BITS)));
+    const float low = kLog2.values[index];
+    return static_cast<float>(exponent) + low + fraction * (kLog2.values[index + 1] - low);
+}
+
+// 2^n for the normal-float exponent range, assembled from the bits (no libm call).
+static inline float exp2Integer(int n) {
+    const uint32_t bits = static_cast<uint32_t>(n + 127) << 23;
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// --- Helper: Calculate Frequency for MIDI Note ---
+float calculateFrequencyForMidiNote(int midiNote, float a4Frequency) {
+    const int offset = midiNote - MIDI_NOTE_A4;
+    const int octaves = (offset >= 0 ? offset : offset - 11) / 12; // Floor division
+    if (octaves < -126 || octaves > 127) {
+        return std::ldexp(a4Frequency * kSemitoneRatios.values[offset - 12 * octaves], octaves);
+    }
+    return a4Frequency * kSemitoneRatios.values[offset - 12 * octaves] * exp2Integer(octaves);
+}
+
+// --- Helper: Get Note Info from Frequency ---
+DetectedNoteInfo getNoteInfoFromFrequency(float frequency, float a4Frequency) {
+    DetectedNoteInfo info;
+    if (frequency < MIN_VALID_FREQUENCY || !(a4Frequency > 0.0f)) {
+        return info; // Below valid range
+    }
+    // Calculate the floating-point MIDI note number
+    float midiNoteFloat = 12.0f * fastLog2(frequency / a4Frequency) + static_cast<float>(MIDI_NOTE_A4);
+    int roundedMidiNote = static_cast<int>(roundf(midiNoteFloat));
+
+    if (roundedMidiNote >= 0) { // Basic validity check for MIDI note number
+        info.noteIndex = roundedMidiNote % 12;
+        info.octave = (roundedMidiNote / 12) - 1; // Standard octave calculation
+        info.midiNote = roundedMidiNote;
+    }
+    return info;
+}
+
+// --- Helper: Cents Offset vs the Closest Chromatic Note ---
+float centsFromNote(float frequency, const DetectedNoteInfo& note, float a4Frequency) {
+    if (note.noteIndex == NOTE_INDEX_NOT_AVAILABLE || frequency < MIN_VALID_FREQUENCY) {
+        return CENTS_NOT_AVAILABLE;
+    }
+    float theoreticalFreq = calculateFrequencyForMidiNote(note.midiNote, a4Frequency);
+    if (theoreticalFreq > std::numeric_limits<float>::epsilon()) { // Avoid division by zero
+        return 1200.0f * fastLog2(frequency / theoreticalFreq);
+    }
+    return 0.0f; // Should not happen if frequency is valid
+}
@@ -0,0 +1,28 @@
+#ifndef AFINADOR_NOTE_MAPPING_H
+#define AFINADOR_NOTE_MAPPING_H
+
+// --- Constants (values mirror TunerViewModel) ---
+constexpr float MIN_VALID_FREQUENCY = 20.0f; // Hertz
+constexpr float CENTS_NOT_AVAILABLE = -1000.0f;
+constexpr int NOTE_INDEX_NOT_AVAILABLE = -1;
+constexpr int OCTAVE_NOT_AVAILABLE = -1;
+constexpr int MIDI_NOTE_A4 = 69;
+constexpr double TWELFTH_ROOT_OF_TWO = 1.0594630943592952646; // 2^(1/12)
+
+// --- Note Info for a Detected Frequency ---
+struct DetectedNoteInfo {
+    int noteIndex = NOTE_INDEX_NOT_AVAILABLE;
+    int octave = OCTAVE_NOT_AVAILABLE;
+    int midiNote = -1;
+};
+
+float calculateFrequencyForMidiNote(int midiNote, float a4Frequency);
+
+// Closest chromatic note to 'frequency' for the given A4 reference.
+DetectedNoteInfo getNoteInfoFromFrequency(float frequency, float a4Frequency);
+
+// Cents offset of 'frequency' from 'note' (as returned by getNoteInfoFromFrequency),
+// or CENTS_NOT_AVAILABLE when no note was found.
+float centsFromNote(float frequency, const DetectedNoteInfo& note, float a4Frequency);
+
+#endif // AFINADOR_NOTE_MAPPING_H
@@ -0,0 +1,327 @@
+#include "PitchAnalyzer.h"
+#include "DspLog.h"
+#include "SimdKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+constexpr int MAX_LOW_REGISTER_DECIMATION = 16;
+constexpr float SAME_NOTE_CENTS = 50.0f;
+constexpr int FULL_RATE_MIN_PERIODS = 4; // Fewer periods in the full-rate window: trust the low register
+constexpr int LOW_REGISTER_MIN_FILL_DIVISOR = 4; // Analyse the low window once this fraction is filled
+constexpr int PERIODICITY_MAX_LAG_DIVISOR = 4;   // Correlate down to a quarter of the window overlapping
+
+// Picks between the full-rate and the low-register estimate of the same window.
+static PitchEstimate mergeEstimates(const PitchEstimate& full, const PitchEstimate& low, float fullRateMinFrequency,
+                                    float fullRatePreferredFrequency) {
+    if (low.frequency <= 0.0f) return full;
+    if (full.frequency <= 0.0f) return low;
+    // Below its reach the full-rate path can only have locked onto a harmonic
+    if (low.frequency < fullRateMinFrequency) return low;
+    if (std::fabs(1200.0f * std::log2(full.frequency / low.frequency)) < SAME_NOTE_CENTS) {
+        // Same note: the longer low-register window is steadier for low notes, the full rate has
+        // the finer lag resolution for the rest
+        return full.frequency < fullRatePreferredFrequency ? low : full;
+    }
+    return low.confidence > full.confidence ? low : full;
+}
+
+bool PitchAnalyzer::configure(const AnalysisConfig& config) {
+    if (config.sampleRate <= 0 || config.windowSize < 256 || config.hopSize <= 0 ||
+        config.hopSize > config.windowSize) {
+        DSP_LOGE("Invalid analysis config: %d Hz, window %d, hop %d.",
+                 config.sampleRate, config.windowSize, config.hopSize);
+        return false;
+    }
+    if (config.lowRegisterDecimation < 1 || config.lowRegisterDecimation > MAX_LOW_REGISTER_DECIMATION ||
+        (config.lowRegisterDecimation > 1 && config.lowRegisterWindowSize < 256)) {
+        DSP_LOGE("Invalid low-register config: decimation %d, window %d.",
+                 config.lowRegisterDecimation, config.lowRegisterWindowSize);
+        return false;
+    }
+    config_ = config;
+    configureDetector(detector_, config.sampleRate, config.windowSize, config.method);
+    window_.assign(config.hopSize + config.windowSize, 0.0f);
+    filled_ = 0;
+    fullRateMinFrequency_ = static_cast<float>(config.sampleRate) / (config.windowSize / 2 - 1);
+    fullRatePreferredFrequency_ = static_cast<float>(FULL_RATE_MIN_PERIODS) * config.sampleRate / config.windowSize;
+    lowRegisterNeeded_ = true;
+
+    if (lowRegisterEnabled()) {
+        const int factor = config.lowRegisterDecimation;
+        const int lowSampleRate = config.sampleRate / factor;
+        // Blocks are hops, or whole windows from processWindow()
+        if (!decimator_.configure(factor, config.windowSize)) return false;
+        configureDetector(lowDetector_, lowSampleRate, config.lowRegisterWindowSize, config.method);
+        lowWindow_.assign(config.lowRegisterWindowSize, 0.0f);
+        decimated_.assign(config.windowSize / factor + 1, 0.0f);
+        lowRateCorrection_ = static_cast<float>(config.sampleRate) / factor / lowSampleRate;
+    } else {
+        lowDetector_ = DetectorContext();
+        lowWindow_.clear();
+        decimated_.clear();
+    }
+    lowFilled_ = 0;
+
+    // Gating cascade: the floor rise per window, and the decimated lags covering YIN's pitch range
+    // (down to the low register, which the full-rate window still shows a quarter overlap of)
+    noiseFloorRise_ = std::pow(10.0f, NOISE_FLOOR_RISE_DB_PER_SECOND / 20.0f * config.hopSize / config.sampleRate);
+    coarseSize_ = config.windowSize / PERIODICITY_DECIMATION;
+    periodicityFft_ = std::make_unique<RealFft>(RealFft::nextPowerOfTwo(2 * coarseSize_));
+    coarse_.assign(periodicityFft_->size(), 0.0f);
+    coarseSpectrum_.assign(periodicityFft_->size() / 2 + 1, std::complex<float>(0.0f, 0.0f));
+    coarseEnergy_.assign(coarseSize_ + 1, 0.0);
+    const int tauMin = std::max(2, static_cast<int>(config.sampleRate / MAX_EXPECTED_FREQUENCY));
+    const int tauMax = static_cast<int>(config.sampleRate / MIN_VALID_FREQUENCY);
+    coarseLagMin_ = std::max(1, tauMin / PERIODICITY_DECIMATION);
+    coarseLagMax_ = std::min(coarseSize_ - coarseSize_ / PERIODICITY_MAX_LAG_DIVISOR,
+                             tauMax / PERIODICITY_DECIMATION + 1);
+    reset();
+    return true;
+}
+
+void PitchAnalyzer::setCandidateRanges(const FrequencyRange* ranges, int count) {
+    ::setCandidateRanges(detector_, ranges, count);
+    if (!lowRegisterEnabled()) return;
+    ::setCandidateRanges(lowDetector_, ranges, count);
+    // Expected pitches the full-rate window reaches make the low-register pass redundant
+    lowRegisterNeeded_ = count <= 0;
+    for (int i = 0; i < count; ++i) {
+        if (ranges[i].minFrequency < fullRateMinFrequency_) lowRegisterNeeded_ = true;
+    }
+}
+
+void PitchAnalyzer::reset() {
+    std::fill(window_.begin(), window_.end(), 0.0f);
+    filled_ = 0;
+    resetSlidingDifference(detector_);
+    if (lowRegisterEnabled()) {
+        decimator_.reset();
+        std::fill(lowWindow_.begin(), lowWindow_.end(), 0.0f);
+        lowFilled_ = 0;
+    }
+    noiseFloor_ = NOISE_FLOOR_INITIAL;
+    heldFrequency_ = 0.0f;
+    heldWindows_ = 0;
+    windowsSinceFullSearch_ = 0;
+}
+
+float PitchAnalyzer::gateThreshold() const {
+    if (!config_.gatingCascade) return MIN_RMS_THRESHOLD;
+    const float margin = heldWindows_ > 0 ? NOISE_GATE_HOLD_MARGIN : NOISE_GATE_MARGIN;
+    return std::max(NOISE_GATE_MIN_RMS, margin * noiseFloor_);
+}
+
+void PitchAnalyzer::feedLowRegister(const float* input, int count) {
+    const int lowWindowSize = config_.lowRegisterWindowSize;
+    int produced = decimator_.process(input, count, decimated_.data());
+    if (produced >= lowWindowSize) {
+        std::copy(decimated_.begin() + (produced - lowWindowSize), decimated_.begin() + produced, lowWindow_.begin());
+    } else {
+        std::copy(lowWindow_.begin() + produced, lowWindow_.end(), lowWindow_.begin());
+        std::copy(decimated_.begin(), decimated_.begin() + produced, lowWindow_.end() - produced);
+    }
+    lowFilled_ = std::min(lowWindowSize, lowFilled_ + produced);
+}
+
+// Slides the window by one hop (the samples leaving it stay in front) and appends the new samples.
+void PitchAnalyzer::slideWindow(const float* hop) {
+    const int hopSize = config_.hopSize;
+    std::copy(window_.begin() + hopSize, window_.end(), window_.begin());
+    std::copy(hop, hop + hopSize, window_.end() - hopSize);
+    filled_ = std::min(config_.windowSize, filled_ + hopSize);
+    if (lowRegisterEnabled()) {
+        feedLowRegister(hop, hopSize);
+    }
+}
+
+bool PitchAnalyzer::processHop(const float* hop, float a4Frequency, PitchResult& result) {
+    slideWindow(hop);
+    if (filled_ < config_.windowSize) {
+        return false;
+    }
+    analyseWindow(a4Frequency, result);
+    return true;
+}
+
+void PitchAnalyzer::appendHop(const float* hop) {
+    slideWindow(hop);
+    resetSlidingDifference(detector_); // d(tau) is not carried over a skipped window
+}
+
+void PitchAnalyzer::processWindow(const float* window, float a4Frequency, PitchResult& result) {
+    std::copy(window, window + config_.windowSize, window_.begin() + config_.hopSize);
+    filled_ = config_.windowSize;
+    resetSlidingDifference(detector_); // Not contiguous with the previous window
+    if (lowRegisterEnabled()) {
+        // The older input is gone: the low-register window starts over from this one
+        decimator_.reset();
+        lowFilled_ = 0;
+        feedLowRegister(window, config_.windowSize);
+    }
+    analyseWindow(a4Frequency, result);
+}
+
+void PitchAnalyzer::analyseWindow(float a4Frequency, PitchResult& result) {
+    const int windowSize = config_.windowSize;
+    const float* window = window_.data() + config_.hopSize;
+    result = PitchResult();
+
+    // 1. Calculate RMS to check for silence/noise
+    float sumOfSquares = dspKernels().sumOfSquares(window, windowSize);
+    result.rms = sqrtf(sumOfSquares / windowSize);
+    if (result.rms < noiseFloor_) {
+        noiseFloor_ = std::max(result.rms, NOISE_GATE_MIN_RMS / NOISE_GATE_MARGIN);
+    }
+
+    // 2. Check RMS against the noise gate: below it is likely silence or noise, report invalid data
+    if (result.rms < gateThreshold()) {
+        result.gated = true;
+        result.stage = AnalysisStage::NoiseGate;
+        raiseNoiseFloor(result.rms);
+        trackEstimate({}, true);
+        resetSlidingDifference(detector_); // d(tau) was not carried over this window
+        return;
+    }
+
+    // 3. A held note is only searched for around its pitch; anything else must look periodic
+    // before the full detector runs
+    PitchEstimate estimate;
+    bool fullSearch = true;
+    if (config_.gatingCascade) {
+        estimate = searchAroundPrevious(window);
+        if (estimate.frequency > 0.0f) {
+            result.stage = AnalysisStage::LocalSearch;
+            fullSearch = false;
+        } else if (!looksPeriodic(window)) {
+            result.stage = AnalysisStage::Periodicity;
+            raiseNoiseFloor(result.rms);
+            trackEstimate({}, true);
+            resetSlidingDifference(detector_);
+            return;
+        }
+    }
+    if (fullSearch) {
+        estimate = searchAll(window);
+        if (estimate.frequency <= 0.0f) raiseNoiseFloor(result.rms);
+    }
+    trackEstimate(estimate, fullSearch);
+    DetectedNoteInfo detectedNote = getNoteInfoFromFrequency(estimate.frequency, a4Frequency);
+
+    // Cents offset relative to the CLOSEST CHROMATIC note if frequency is valid
+    result.noteIndex = detectedNote.noteIndex;
+    result.octave = detectedNote.octave;
+    result.frequency = estimate.frequency;
+    result.confidence = estimate.confidence;
+    result.narrowed = estimate.narrowed;
+    result.centsOffset = centsFromNote(estimate.frequency, detectedNote, a4Frequency);
+}
+
+// Full-rate YIN merged with the low register.
+PitchEstimate PitchAnalyzer::searchAll(const float* window) {
+    const int windowSize = config_.windowSize;
+    PitchEstimate estimate = config_.method == DifferenceMethod::Sliding
+            ? computeYINSliding(detector_, window_.data(), windowSize, config_.hopSize)
+            : computeYIN(detector_, window, windowSize);
+    const int lowWindowSize = config_.lowRegisterWindowSize;
+    if (lowRegisterEnabled() && lowRegisterNeeded_ && lowFilled_ >= lowWindowSize / LOW_REGISTER_MIN_FILL_DIVISOR) {
+        // While it fills up, only the valid tail of the low-register window is analysed
+        PitchEstimate low = computeYIN(lowDetector_, lowWindow_.data() + (lowWindowSize - lowFilled_), lowFilled_);
+        low.frequency *= lowRateCorrection_;
+        estimate = mergeEstimates(estimate, low, fullRateMinFrequency_, fullRatePreferredFrequency_);
+    }
+    return estimate;
+}
+
+// The held note searched for in the window the full search would have taken it from. Zero
+// frequency when no note is held, a full search is due, or the note was not found confidently.
+PitchEstimate PitchAnalyzer::searchAroundPrevious(const float* window) {
+    if (heldWindows_ < LOCAL_SEARCH_STABLE_WINDOWS || windowsSinceFullSearch_ >= LOCAL_SEARCH_REFRESH_WINDOWS) {
+        return {};
+    }
+    PitchEstimate estimate;
+    if (heldFrequency_ >= fullRatePreferredFrequency_ || !lowRegisterEnabled() || !lowRegisterNeeded_) {
+        estimate = computeYINAround(detector_, window, config_.windowSize, heldFrequency_, LOCAL_SEARCH_SPREAD_CENTS);
+    } else if (lowFilled_ == config_.lowRegisterWindowSize) {
+        estimate = computeYINAround(lowDetector_, lowWindow_.data(), lowFilled_, heldFrequency_ / lowRateCorrection_,
+                                    LOCAL_SEARCH_SPREAD_CENTS);
+        estimate.frequency *= lowRateCorrection_;
+    }
+    if (estimate.frequency <= 0.0f || estimate.confidence < LOCAL_SEARCH_MIN_CONFIDENCE) return {};
+    resetSlidingDifference(detector_); // d(tau) was not carried over this window
+    return estimate;
+}
+
+// Normalised autocorrelation of the boxcar-decimated window via the FFT. Periodic when, past the
+// first drop below PERIODICITY_MIN_CORRELATION (low-frequency noise stays correlated over short
+// lags), a peak inside the pitch range reaches it again.
+bool PitchAnalyzer::looksPeriodic(const float* window) {
+    const int n = coarseSize_;
+    const float* x = window + (config_.windowSize - n * PERIODICITY_DECIMATION);
+    float mean = 0.0f;
+    for (int i = 0; i < n; ++i) {
+        float sum = 0.0f;
+        for (int k = 0; k < PERIODICITY_DECIMATION; ++k) {
+            sum += x[i * PERIODICITY_DECIMATION + k];
+        }
+        coarse_[i] = sum;
+        mean += sum;
+    }
+    mean /= n;
+    coarseEnergy_[0] = 0.0;
+    for (int i = 0; i < n; ++i) {
+        coarse_[i] -= mean; // An input offset would correlate at every lag
+        coarseEnergy_[i + 1] = coarseEnergy_[i] + static_cast<double>(coarse_[i]) * coarse_[i];
+    }
+    std::fill(coarse_.begin() + n, coarse_.end(), 0.0f);
+    periodicityFft_->forward(coarse_.data(), coarseSpectrum_.data());
+    for (auto& bin : coarseSpectrum_) {
+        bin = std::norm(bin);
+    }
+    periodicityFft_->inverse(coarseSpectrum_.data(), coarse_.data());
+
+    const double totalEnergy = coarseEnergy_[n];
+    auto correlation = [&](int lag) {
+        const double energy = std::sqrt(coarseEnergy_[n - lag] * (totalEnergy - coarseEnergy_[lag]));
+        return energy > std::numeric_limits<float>::epsilon() ? static_cast<float>(coarse_[lag] / energy) : 0.0f;
+    };
+    float before = 1.0f;
+    float current = correlation(1);
+    bool dropped = false;
+    for (int lag = 1; lag < coarseLagMax_; ++lag) {
+        const float after = correlation(lag + 1);
+        dropped = dropped || current < PERIODICITY_MIN_CORRELATION;
+        if (dropped && lag >= coarseLagMin_ && current > before && current >= after) {
+            // The period rarely falls on a whole decimated lag: take the parabola's peak
+            float peak = current;
+            const float curvature = before + after - 2.0f * current;
+            if (curvature < 0.0f) {
+                const float shift = 0.5f * (before - after) / curvature;
+                peak = current - 0.25f * (before - after) * shift;
+            }
+            if (peak >= PERIODICITY_MIN_CORRELATION) return true;
+        }
+        before = current;
+        current = after;
+    }
+    return false;
+}
+
+// Unpitched windows move the floor up towards their RMS.
+void PitchAnalyzer::raiseNoiseFloor(float rms) {
+    if (!config_.gatingCascade || rms <= noiseFloor_) return;
+    noiseFloor_ = std::min(rms, noiseFloor_ * noiseFloorRise_);
+}
+
+void PitchAnalyzer::trackEstimate(const PitchEstimate& estimate, bool fullSearch) {
+    windowsSinceFullSearch_ = fullSearch ? 0 : windowsSinceFullSearch_ + 1;
+    if (estimate.frequency <= 0.0f || estimate.confidence < LOCAL_SEARCH_MIN_CONFIDENCE) {
+        heldFrequency_ = 0.0f;
+        heldWindows_ = 0;
+        return;
+    }
+    const bool agrees = heldFrequency_ > 0.0f &&
+                        std::fabs(1200.0f * std::log2(estimate.frequency / heldFrequency_)) < LOCAL_SEARCH_STABLE_CENTS;
+    heldWindows_ = agrees ? heldWindows_ + 1 : 1;
+    heldFrequency_ = estimate.frequency;
+}
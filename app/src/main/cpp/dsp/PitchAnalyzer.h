@@ -0,0 +1,146 @@
+#ifndef AFINADOR_PITCH_ANALYZER_H
+#define AFINADOR_PITCH_ANALYZER_H
+
+#include "Decimator.h"
+#include "NoteMapping.h"
+#include "YinDetector.h"
+#include <complex>
+#include <memory>
+#include <vector>
+
+// Further lowered RMS threshold to hold decaying notes longer
+constexpr float MIN_RMS_THRESHOLD = 0.004f; // Adjusted from 0.006f
+
+// --- Gating Cascade ---
+// Adaptive noise gate: the noise floor follows the window RMS down at once and rises slowly
+// towards it on windows without a pitch; windows below NOISE_GATE_MARGIN x floor are gated. A held
+// note keeps the gate open down to NOISE_GATE_HOLD_MARGIN x floor, so its tail is not cut short.
+constexpr float NOISE_GATE_MARGIN = 2.0f;                  // 6 dB above the floor
+constexpr float NOISE_GATE_HOLD_MARGIN = 1.0f;
+constexpr float NOISE_GATE_MIN_RMS = 0.001f;               // The gate never drops below this
+constexpr float NOISE_FLOOR_INITIAL = MIN_RMS_THRESHOLD / NOISE_GATE_MARGIN; // Starts at the fixed gate
+constexpr float NOISE_FLOOR_RISE_DB_PER_SECOND = 10.0f;
+// Periodicity pre-check on the window decimated by PERIODICITY_DECIMATION: a window whose
+// normalised autocorrelation has no peak of PERIODICITY_MIN_CORRELATION is skipped before YIN
+// (YIN itself accepts only dips that need well above 0.8).
+constexpr int PERIODICITY_DECIMATION = 4;
+constexpr float PERIODICITY_MIN_CORRELATION = 0.5f;
+// Local search: while a note is held, only the lags around the previous pitch are searched
+constexpr int LOCAL_SEARCH_STABLE_WINDOWS = 3;      // Consecutive estimates within LOCAL_SEARCH_STABLE_CENTS
+constexpr float LOCAL_SEARCH_STABLE_CENTS = 20.0f;
+constexpr float LOCAL_SEARCH_MIN_CONFIDENCE = 0.9f;
+constexpr float LOCAL_SEARCH_SPREAD_CENTS = 50.0f;  // Lags searched around the previous pitch
+constexpr int LOCAL_SEARCH_REFRESH_WINDOWS = 32;    // A full search at least this often
+
+struct AnalysisConfig {
+    int sampleRate = 44100;
+    int windowSize = 2048;
+    int hopSize = 512;
+    DifferenceMethod method = DifferenceMethod::Fft;
+    // Low-register path: YIN also runs on the input decimated by this factor (1 = off), over
+    // lowRegisterWindowSize decimated samples, so low strings are reached without a long
+    // full-rate window. Its result is merged with the full-rate one by confidence.
+    int lowRegisterDecimation = 8;
+    int lowRegisterWindowSize = 1024;
+    // Adaptive noise gate, periodicity pre-check and local search (see Gating Cascade). Off: the
+    // fixed MIN_RMS_THRESHOLD gate and the full detector on every window.
+    bool gatingCascade = true;
+};
+
+// Where the analysis of a window stopped
+enum class AnalysisStage : int {
+    NoiseGate = 0, // Below the noise gate, not analysed
+    Periodicity,   // Rejected by the periodicity pre-check, YIN skipped
+    LocalSearch,   // Answered by the search around the previous pitch
+    FullSearch     // Full detector (including the candidate ranges)
+};
+
+// Result for one analysed window. noteIndex/octave/centsOffset use the *_NOT_AVAILABLE values
+// when the window was gated or no pitch was found.
+struct PitchResult {
+    int noteIndex = NOTE_INDEX_NOT_AVAILABLE;
+    int octave = OCTAVE_NOT_AVAILABLE;
+    float frequency = 0.0f;
+    float centsOffset = CENTS_NOT_AVAILABLE;
+    float confidence = 0.0f;
+    float rms = 0.0f;
+    bool gated = false;    // Window was below the noise gate and not analysed
+    bool narrowed = false; // Pitch came from the candidate ranges or the local search without a full scan
+    AnalysisStage stage = AnalysisStage::FullSearch;
+};
+
+// --- Pitch Analyzer ---
+// The complete analysis pipeline shared by the live engine and the host tools:
+// sliding window (windowSize, advanced by hopSize) -> noise gate -> local search around the held
+// note or periodicity pre-check -> YIN -> note mapping, plus the optional decimated low-register
+// window analysed alongside it.
+// configure() allocates everything; the process* calls never allocate.
+class PitchAnalyzer {
+public:
+    bool configure(const AnalysisConfig& config);
+    const AnalysisConfig& config() const { return config_; }
+
+    // Expected pitch ranges for the narrowed search (count 0 goes back to full scans only).
+    void setCandidateRanges(const FrequencyRange* ranges, int count);
+
+    // Clears the window and the gating state; the next result comes once a full window has been
+    // collected again.
+    void reset();
+
+    // Current noise gate (window RMS below it is not analysed).
+    float gateThreshold() const;
+
+    // Appends config().hopSize samples. Returns true (and fills 'result') once the window is full.
+    bool processHop(const float* hop, float a4Frequency, PitchResult& result);
+
+    // Appends config().hopSize samples without analysing the window, for hops the duty cycle
+    // skips. The next analysed window is complete; only the sliding d(tau) starts over.
+    void appendHop(const float* hop);
+
+    // Replaces the whole window with config().windowSize samples and analyses it. The
+    // low-register window restarts from these samples, so it needs a while to refill.
+    void processWindow(const float* window, float a4Frequency, PitchResult& result);
+
+private:
+    void slideWindow(const float* hop);
+    void analyseWindow(float a4Frequency, PitchResult& result);
+    PitchEstimate searchAroundPrevious(const float* window);
+    PitchEstimate searchAll(const float* window);
+    bool looksPeriodic(const float* window);
+    void raiseNoiseFloor(float rms);
+    void trackEstimate(const PitchEstimate& estimate, bool fullSearch);
+    void feedLowRegister(const float* input, int count);
+    bool lowRegisterEnabled() const { return config_.lowRegisterDecimation > 1; }
+
+    AnalysisConfig config_;
+    DetectorContext detector_;
+    std::vector<float> window_; // The hop that left the window last, then the window itself
+    int filled_ = 0;            // Valid samples at the end of the window
+
+    // --- Low register ---
+    Decimator decimator_;
+    DetectorContext lowDetector_;
+    std::vector<float> lowWindow_;
+    std::vector<float> decimated_;    // One block of decimator output
+    int lowFilled_ = 0;
+    float lowRateCorrection_ = 1.0f;  // Exact decimated rate / the detector's whole-Hz rate
+    float fullRateMinFrequency_ = 0.0f; // Lowest pitch the full-rate window can reach
+    float fullRatePreferredFrequency_ = 0.0f; // Lowest pitch with enough periods in the full-rate window
+    bool lowRegisterNeeded_ = true;   // False when every candidate range is within full-rate reach
+
+    // --- Gating cascade ---
+    float noiseFloor_ = NOISE_FLOOR_INITIAL;
+    float noiseFloorRise_ = 1.0f;          // Floor growth per analysed window
+    std::unique_ptr<RealFft> periodicityFft_;
+    std::vector<float> coarse_;            // Decimated window, zero-padded, then its autocorrelation
+    std::vector<std::complex<float>> coarseSpectrum_;
+    std::vector<double> coarseEnergy_;     // coarseEnergy_[k] = sum_{j<k} coarse[j]^2
+    int coarseSize_ = 0;
+    int coarseLagMin_ = 0;                 // Decimated lags matching YIN's range
+    int coarseLagMax_ = 0;
+    float heldFrequency_ = 0.0f;           // Last estimate and how many in a row agreed with it
+    int heldWindows_ = 0;
+    int windowsSinceFullSearch_ = 0;
+};
+
+#endif // AFINADOR_PITCH_ANALYZER_H
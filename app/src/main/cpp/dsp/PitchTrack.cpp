@@ -0,0 +1,139 @@
+#include "PitchTrack.h"
+#include "DspLog.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+// Segments dealt to one thread. The owner takes from the front and thieves from the back, so every
+// thread works through consecutive segments and steals the ones furthest from the victim's.
+struct SegmentQueue {
+    std::mutex mutex;
+    std::deque<size_t> segments;
+};
+
+bool takeFront(SegmentQueue& queue, size_t& segment) {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.segments.empty()) return false;
+    segment = queue.segments.front();
+    queue.segments.pop_front();
+    return true;
+}
+
+bool stealBack(SegmentQueue& queue, size_t& segment) {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.segments.empty()) return false;
+    segment = queue.segments.back();
+    queue.segments.pop_back();
+    return true;
+}
+
+size_t hopsPerWindow(const AnalysisConfig& config) {
+    return (static_cast<size_t>(config.windowSize) + config.hopSize - 1) / config.hopSize;
+}
+
+PitchTrackRecord toRecord(const PitchResult& result, size_t windowEnd, const AnalysisConfig& config) {
+    PitchTrackRecord record;
+    const double centre = static_cast<double>(windowEnd) - config.windowSize / 2.0;
+    record.timeNanos = std::llround(1e9 * centre / config.sampleRate);
+    const bool pitched = result.noteIndex != NOTE_INDEX_NOT_AVAILABLE;
+    record.frequency = pitched ? result.frequency : 0.0f;
+    record.centsOffset = pitched ? result.centsOffset : CENTS_NOT_AVAILABLE;
+    record.confidence = result.confidence;
+    record.rms = result.rms;
+    return record;
+}
+
+// Records [first, last) of the take. Record r is the window ending with hop r + hopsPerWindow - 1;
+// the analyzer starts up to preRollHops earlier and its results before 'first' are dropped.
+void analyseSegment(PitchAnalyzer& analyzer, const float* samples, const PitchTrackConfig& config,
+                    size_t first, size_t last, size_t preRollHops, PitchTrackRecord* out) {
+    const AnalysisConfig& analysis = config.analysis;
+    const size_t hopSize = static_cast<size_t>(analysis.hopSize);
+    const size_t windowHops = hopsPerWindow(analysis);
+    analyzer.reset();
+    PitchResult result;
+    for (size_t hop = first > preRollHops ? first - preRollHops : 0; hop < last + windowHops - 1; ++hop) {
+        if (!analyzer.processHop(samples + hop * hopSize, config.a4Frequency, result)) continue;
+        const size_t record = hop + 1 - windowHops;
+        if (record >= first) out[record] = toRecord(result, (hop + 1) * hopSize, analysis);
+    }
+}
+}
+
+size_t pitchTrackRecordCount(size_t sampleCount, const AnalysisConfig& config) {
+    if (config.hopSize <= 0 || config.windowSize <= 0) return 0;
+    const size_t hops = sampleCount / config.hopSize;
+    const size_t windowHops = hopsPerWindow(config);
+    return hops >= windowHops ? hops - windowHops + 1 : 0;
+}
+
+bool computePitchTrack(const float* samples, size_t sampleCount, const PitchTrackConfig& config,
+                       PitchTrackRecord* out, PitchTrackStats* stats) {
+    using Clock = std::chrono::steady_clock;
+    const auto start = Clock::now();
+    const AnalysisConfig& analysis = config.analysis;
+    {
+        PitchAnalyzer probe; // Rejects the config the same way every thread would
+        if (!probe.configure(analysis)) return false;
+    }
+    if (config.segmentSeconds <= 0.0f || config.preRollSeconds < 0.0f) {
+        DSP_LOGE("Invalid pitch track segments: %.2f s, pre-roll %.2f s.", config.segmentSeconds, config.preRollSeconds);
+        return false;
+    }
+    const size_t records = pitchTrackRecordCount(sampleCount, analysis);
+    const double hopsPerSecond = static_cast<double>(analysis.sampleRate) / analysis.hopSize;
+    const size_t segmentRecords = std::max<size_t>(1, static_cast<size_t>(config.segmentSeconds * hopsPerSecond));
+    const size_t preRollHops = static_cast<size_t>(std::ceil(config.preRollSeconds * hopsPerSecond));
+    const size_t segmentCount = (records + segmentRecords - 1) / segmentRecords;
+
+    int threadCount = config.threadCount > 0 ? config.threadCount
+                                             : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    threadCount = static_cast<int>(std::max<size_t>(1, std::min<size_t>(threadCount, segmentCount)));
+
+    // Deal the segments out in contiguous runs, one run per thread
+    std::vector<SegmentQueue> queues(threadCount);
+    for (size_t s = 0; s < segmentCount; ++s) {
+        queues[s * threadCount / segmentCount].segments.push_back(s);
+    }
+    std::atomic<int> stolen{0};
+    auto work = [&](int self) {
+        PitchAnalyzer analyzer;
+        analyzer.configure(analysis);
+        for (;;) {
+            size_t segment = 0;
+            if (!takeFront(queues[self], segment)) {
+                bool found = false;
+                for (int i = 1; i < threadCount && !found; ++i) {
+                    found = stealBack(queues[(self + i) % threadCount], segment);
+                }
+                if (!found) return; // No segment is ever added, so every queue stays empty
+                stolen.fetch_add(1, std::memory_order_relaxed);
+            }
+            const size_t first = segment * segmentRecords;
+            analyseSegment(analyzer, samples, config, first, std::min(records, first + segmentRecords),
+                           preRollHops, out);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int t = 1; t < threadCount; ++t) {
+        threads.emplace_back(work, t);
+    }
+    work(0); // The calling thread takes the first run
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    if (stats) {
+        stats->threads = threadCount;
+        stats->segments = static_cast<int>(segmentCount);
+        stats->stolenSegments = stolen.load();
+        stats->seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    }
+    return true;
+}
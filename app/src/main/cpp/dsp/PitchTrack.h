@@ -0,0 +1,53 @@
+#ifndef AFINADOR_PITCH_TRACK_H
+#define AFINADOR_PITCH_TRACK_H
+
+#include "PitchAnalyzer.h"
+#include <cstddef>
+#include <cstdint>
+
+// --- Pitch Track Record ---
+// One analysed window of a recorded take, 24 bytes in native byte order. Offsets must match the
+// PITCH_TRACK_* constants in PitchTracker.kt.
+struct PitchTrackRecord {
+    int64_t timeNanos;  // Centre of the window, from the start of the input
+    float frequency;    // Hz, 0 when the window was gated or had no clear pitch
+    float centsOffset;  // Versus the closest chromatic note, CENTS_NOT_AVAILABLE without a pitch
+    float confidence;   // 0..1
+    float rms;
+};
+
+static_assert(sizeof(PitchTrackRecord) == 24, "Pitch track record layout mismatch");
+
+struct PitchTrackConfig {
+    AnalysisConfig analysis;
+    float a4Frequency = 440.0f;
+    int threadCount = 0;           // 0 = one per hardware thread
+    float segmentSeconds = 4.0f;   // Unit of work; idle threads steal whole segments
+    float preRollSeconds = 0.5f;   // Input analysed before each segment and discarded, so the
+                                   // gate, held note and low-register window have settled
+};
+
+struct PitchTrackStats {
+    int threads = 0;
+    int segments = 0;
+    int stolenSegments = 0; // Run by another thread than the one they were dealt to
+    double seconds = 0.0;   // Wall time
+};
+
+// --- Batch Pitch Tracking ---
+// Runs the live pipeline over a whole recorded take instead of a stream: one record per hop, the
+// same windows PitchAnalyzer::processHop would produce fed the take from the start. The take is
+// cut into segments analysed in parallel by independent analyzers, each warmed up on the
+// preRollSeconds before its segment; results match a serial run except where the adaptive gate
+// or held-note state still differs after the pre-roll.
+
+// Records for 'sampleCount' samples: one per complete window.
+size_t pitchTrackRecordCount(size_t sampleCount, const AnalysisConfig& config);
+
+// Analyses 'samples' (mono) into 'out', which must hold pitchTrackRecordCount() records. Blocks
+// until done; the input is only read, so it may be a read-only file mapping. Returns false on an
+// invalid config.
+bool computePitchTrack(const float* samples, size_t sampleCount, const PitchTrackConfig& config,
+                       PitchTrackRecord* out, PitchTrackStats* stats = nullptr);
+
+#endif // AFINADOR_PITCH_TRACK_H
@@ -0,0 +1,513 @@
+#include "SimdKernels.h"
+#include <limits>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define AFINADOR_SIMD_NEON 1
+#include <arm_neon.h>
+#elif (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__) && defined(__GNUC__)
+#define AFINADOR_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+// Number of lags computed per pass in the difference kernels: every x[j] load is reused for
+// this many lags instead of reloading the whole window for each lag.
+constexpr int LAGS_PER_PASS = 4;
+
+// --- Scalar Reference ---
+static float sumOfSquaresScalar(const float* x, int n) {
+    float sum = 0.0f;
+    for (int i = 0; i < n; ++i) {
+        sum += x[i] * x[i];
+    }
+    return sum;
+}
+
+static void differenceScalar(const float* x, int n, int tauBegin, int tauEnd, float* out) {
+    for (int tau = tauBegin; tau < tauEnd; ++tau) {
+        float sum = 0.0f;
+        for (int j = 0; j < n - tau; ++j) {
+            float delta = x[j] - x[j + tau];
+            sum += delta * delta;
+        }
+        out[tau] = sum;
+    }
+}
+
+static void slideDifferenceScalar(const float* x, int n, int hop, int tauBegin, int tauEnd, float* d) {
+    for (int tau = tauBegin; tau < tauEnd; ++tau) {
+        float change = 0.0f;
+        for (int i = 0; i < hop; ++i) {
+            float entering = x[n - tau + i] - x[n + i];
+            float leaving = x[i] - x[i + tau];
+            change += entering * entering - leaving * leaving;
+        }
+        d[tau] += change;
+    }
+}
+
+static void cumulativeMeanNormalizeScalar(float* d, int tauBegin, int tauEnd) {
+    float runningSum = 0.0f;
+    for (int tau = tauBegin; tau < tauEnd; ++tau) {
+        runningSum += d[tau];
+        // Avoid division by zero or very small numbers
+        d[tau] = (runningSum > std::numeric_limits<float>::epsilon()) ? (d[tau] * tau / runningSum) : 1.0f;
+    }
+}
+
+// Adds the terms [jBegin, n - tau) of lag 'tau' that a vector loop did not cover.
+static inline float differenceTail(const float* x, int n, int tau, int jBegin, float sum) {
+    for (int j = jBegin; j < n - tau; ++j) {
+        float delta = x[j] - x[j + tau];
+        sum += delta * delta;
+    }
+    return sum;
+}
+
+// Adds the hop terms [iBegin, hop) of lag 'tau' that a vector loop did not cover.
+static inline float slideTail(const float* x, int n, int hop, int tau, int iBegin, float change) {
+    for (int i = iBegin; i < hop; ++i) {
+        float entering = x[n - tau + i] - x[n + i];
+        float leaving = x[i] - x[i + tau];
+        change += entering * entering - leaving * leaving;
+    }
+    return change;
+}
+
+static const DspKernels kScalarKernels = {
+        "scalar", sumOfSquaresScalar, differenceScalar, slideDifferenceScalar, cumulativeMeanNormalizeScalar};
+
+#if defined(AFINADOR_SIMD_NEON)
+// --- NEON (armeabi-v7a with NEON, arm64-v8a) ---
+static inline float horizontalSumNeon(float32x4_t v) {
+#if defined(__aarch64__)
+    return vaddvq_f32(v);
+#else
+    float32x2_t pair = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+    return vget_lane_f32(vpadd_f32(pair, pair), 0);
+#endif
+}
+
+static inline float32x4_t multiplyAddNeon(float32x4_t acc, float32x4_t a, float32x4_t b) {
+#if defined(__aarch64__)
+    return vfmaq_f32(acc, a, b);
+#else
+    return vmlaq_f32(acc, a, b);
+#endif
+}
+
+static inline float32x4_t divideNeon(float32x4_t numerator, float32x4_t denominator) {
+#if defined(__aarch64__)
+    return vdivq_f32(numerator, denominator);
+#else
+    // Reciprocal estimate refined with two Newton-Raphson steps (~full float precision)
+    float32x4_t reciprocal = vrecpeq_f32(denominator);
+    reciprocal = vmulq_f32(vrecpsq_f32(denominator, reciprocal), reciprocal);
+    reciprocal = vmulq_f32(vrecpsq_f32(denominator, reciprocal), reciprocal);
+    return vmulq_f32(numerator, reciprocal);
+#endif
+}
+
+static float sumOfSquaresNeon(const float* x, int n) {
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        float32x4_t a = vld1q_f32(x + i);
+        float32x4_t b = vld1q_f32(x + i + 4);
+        acc0 = multiplyAddNeon(acc0, a, a);
+        acc1 = multiplyAddNeon(acc1, b, b);
+    }
+    float sum = horizontalSumNeon(vaddq_f32(acc0, acc1));
+    for (; i < n; ++i) {
+        sum += x[i] * x[i];
+    }
+    return sum;
+}
+
+static void differenceNeon(const float* x, int n, int tauBegin, int tauEnd, float* out) {
+    int tau = tauBegin;
+    for (; tau + LAGS_PER_PASS <= tauEnd; tau += LAGS_PER_PASS) {
+        const int shared = n - (tau + LAGS_PER_PASS - 1); // Terms every lag of this pass has
+        float32x4_t acc0 = vdupq_n_f32(0.0f);
+        float32x4_t acc1 = vdupq_n_f32(0.0f);
+        float32x4_t acc2 = vdupq_n_f32(0.0f);
+        float32x4_t acc3 = vdupq_n_f32(0.0f);
+        int j = 0;
+        for (; j + 4 <= shared; j += 4) {
+            float32x4_t a = vld1q_f32(x + j);
+            float32x4_t d0 = vsubq_f32(a, vld1q_f32(x + j + tau));
+            float32x4_t d1 = vsubq_f32(a, vld1q_f32(x + j + tau + 1));
+            float32x4_t d2 = vsubq_f32(a, vld1q_f32(x + j + tau + 2));
+            float32x4_t d3 = vsubq_f32(a, vld1q_f32(x + j + tau + 3));
+            acc0 = multiplyAddNeon(acc0, d0, d0);
+            acc1 = multiplyAddNeon(acc1, d1, d1);
+            acc2 = multiplyAddNeon(acc2, d2, d2);
+            acc3 = multiplyAddNeon(acc3, d3, d3);
+        }
+        out[tau] = differenceTail(x, n, tau, j, horizontalSumNeon(acc0));
+        out[tau + 1] = differenceTail(x, n, tau + 1, j, horizontalSumNeon(acc1));
+        out[tau + 2] = differenceTail(x, n, tau + 2, j, horizontalSumNeon(acc2));
+        out[tau + 3] = differenceTail(x, n, tau + 3, j, horizontalSumNeon(acc3));
+    }
+    for (; tau < tauEnd; ++tau) {
+        float32x4_t acc = vdupq_n_f32(0.0f);
+        int j = 0;
+        for (; j + 4 <= n - tau; j += 4) {
+            float32x4_t delta = vsubq_f32(vld1q_f32(x + j), vld1q_f32(x + j + tau));
+            acc = multiplyAddNeon(acc, delta, delta);
+        }
+        out[tau] = differenceTail(x, n, tau, j, horizontalSumNeon(acc));
+    }
+}
+
+static inline float32x4_t multiplySubtractNeon(float32x4_t acc, float32x4_t a, float32x4_t b) {
+#if defined(__aarch64__)
+    return vfmsq_f32(acc, a, b);
+#else
+    return vmlsq_f32(acc, a, b);
+#endif
+}
+
+// Entering terms share x[n + i] and leaving terms x[i] across the lags of a pass.
+static void slideDifferenceNeon(const float* x, int n, int hop, int tauBegin, int tauEnd, float* d) {
+    const float* incoming = x + n;
+    int tau = tauBegin;
+    for (; tau + LAGS_PER_PASS <= tauEnd; tau += LAGS_PER_PASS) {
+        float32x4_t acc0 = vdupq_n_f32(0.0f);
+        float32x4_t acc1 = vdupq_n_f32(0.0f);
+        float32x4_t acc2 = vdupq_n_f32(0.0f);
+        float32x4_t acc3 = vdupq_n_f32(0.0f);
+        int i = 0;
+        for (; i + 4 <= hop; i += 4) {
+            float32x4_t in = vld1q_f32(incoming + i);
+            float32x4_t out = vld1q_f32(x + i);
+            float32x4_t e0 = vsubq_f32(vld1q_f32(incoming - tau + i), in);
+            float32x4_t e1 = vsubq_f32(vld1q_f32(incoming - tau - 1 + i), in);
+            float32x4_t e2 = vsubq_f32(vld1q_f32(incoming - tau - 2 + i), in);
+            float32x4_t e3 = vsubq_f32(vld1q_f32(incoming - tau - 3 + i), in);
+            float32x4_t l0 = vsubq_f32(out, vld1q_f32(x + i + tau));
+            float32x4_t l1 = vsubq_f32(out, vld1q_f32(x + i + tau + 1));
+            float32x4_t l2 = vsubq_f32(out, vld1q_f32(x + i + tau + 2));
+            float32x4_t l3 = vsubq_f32(out, vld1q_f32(x + i + tau + 3));
+            acc0 = multiplySubtractNeon(multiplyAddNeon(acc0, e0, e0), l0, l0);
+            acc1 = multiplySubtractNeon(multiplyAddNeon(acc1, e1, e1), l1, l1);
+            acc2 = multiplySubtractNeon(multiplyAddNeon(acc2, e2, e2), l2, l2);
+            acc3 = multiplySubtractNeon(multiplyAddNeon(acc3, e3, e3), l3, l3);
+        }
+        d[tau] += slideTail(x, n, hop, tau, i, horizontalSumNeon(acc0));
+        d[tau + 1] += slideTail(x, n, hop, tau + 1, i, horizontalSumNeon(acc1));
+        d[tau + 2] += slideTail(x, n, hop, tau + 2, i, horizontalSumNeon(acc2));
+        d[tau + 3] += slideTail(x, n, hop, tau + 3, i, horizontalSumNeon(acc3));
+    }
+    for (; tau < tauEnd; ++tau) {
+        float32x4_t acc = vdupq_n_f32(0.0f);
+        int i = 0;
+        for (; i + 4 <= hop; i += 4) {
+            float32x4_t entering = vsubq_f32(vld1q_f32(incoming - tau + i), vld1q_f32(incoming + i));
+            float32x4_t leaving = vsubq_f32(vld1q_f32(x + i), vld1q_f32(x + i + tau));
+            acc = multiplySubtractNeon(multiplyAddNeon(acc, entering, entering), leaving, leaving);
+        }
+        d[tau] += slideTail(x, n, hop, tau, i, horizontalSumNeon(acc));
+    }
+}
+
+static void cumulativeMeanNormalizeNeon(float* d, int tauBegin, int tauEnd) {
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    const float32x4_t epsilon = vdupq_n_f32(std::numeric_limits<float>::epsilon());
+    const float32x4_t step = vdupq_n_f32(static_cast<float>(4));
+    float32x4_t carry = zero; // Running sum of everything before this block, in every lane
+    int tau = tauBegin;
+    const float firstLags[4] = {static_cast<float>(tau), static_cast<float>(tau + 1),
+                                static_cast<float>(tau + 2), static_cast<float>(tau + 3)};
+    float32x4_t lags = vld1q_f32(firstLags);
+    for (; tau + 4 <= tauEnd; tau += 4) {
+        float32x4_t v = vld1q_f32(d + tau);
+        // Inclusive prefix sum inside the vector: [v0, v0+v1, v0+v1+v2, v0+v1+v2+v3]
+        float32x4_t scan = vaddq_f32(v, vextq_f32(zero, v, 3));
+        scan = vaddq_f32(scan, vextq_f32(zero, scan, 2));
+        scan = vaddq_f32(scan, carry);
+        float32x4_t normalized = divideNeon(vmulq_f32(v, lags), scan);
+        uint32x4_t valid = vcgtq_f32(scan, epsilon);
+        vst1q_f32(d + tau, vbslq_f32(valid, normalized, one));
+        carry = vdupq_n_f32(vgetq_lane_f32(scan, 3));
+        lags = vaddq_f32(lags, step);
+    }
+    float runningSum = vgetq_lane_f32(carry, 0);
+    for (; tau < tauEnd; ++tau) {
+        runningSum += d[tau];
+        d[tau] = (runningSum > std::numeric_limits<float>::epsilon()) ? (d[tau] * tau / runningSum) : 1.0f;
+    }
+}
+
+static const DspKernels kNeonKernels = {
+        "neon", sumOfSquaresNeon, differenceNeon, slideDifferenceNeon, cumulativeMeanNormalizeNeon};
+#endif // AFINADOR_SIMD_NEON
+
+#if defined(AFINADOR_SIMD_X86)
+// --- SSE2 (x86 baseline) ---
+static inline float horizontalSumSse(__m128 v) {
+    __m128 shuffled = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+    __m128 sums = _mm_add_ps(v, shuffled);
+    shuffled = _mm_movehl_ps(shuffled, sums);
+    sums = _mm_add_ss(sums, shuffled);
+    return _mm_cvtss_f32(sums);
+}
+
+static float sumOfSquaresSse2(const float* x, int n) {
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128 a = _mm_loadu_ps(x + i);
+        __m128 b = _mm_loadu_ps(x + i + 4);
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(a, a));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(b, b));
+    }
+    float sum = horizontalSumSse(_mm_add_ps(acc0, acc1));
+    for (; i < n; ++i) {
+        sum += x[i] * x[i];
+    }
+    return sum;
+}
+
+static void differenceSse2(const float* x, int n, int tauBegin, int tauEnd, float* out) {
+    int tau = tauBegin;
+    for (; tau + LAGS_PER_PASS <= tauEnd; tau += LAGS_PER_PASS) {
+        const int shared = n - (tau + LAGS_PER_PASS - 1); // Terms every lag of this pass has
+        __m128 acc0 = _mm_setzero_ps();
+        __m128 acc1 = _mm_setzero_ps();
+        __m128 acc2 = _mm_setzero_ps();
+        __m128 acc3 = _mm_setzero_ps();
+        int j = 0;
+        for (; j + 4 <= shared; j += 4) {
+            __m128 a = _mm_loadu_ps(x + j);
+            __m128 d0 = _mm_sub_ps(a, _mm_loadu_ps(x + j + tau));
+            __m128 d1 = _mm_sub_ps(a, _mm_loadu_ps(x + j + tau + 1));
+            __m128 d2 = _mm_sub_ps(a, _mm_loadu_ps(x + j + tau + 2));
+            __m128 d3 = _mm_sub_ps(a, _mm_loadu_ps(x + j + tau + 3));
+            acc0 = _mm_add_ps(acc0, _mm_mul_ps(d0, d0));
+            acc1 = _mm_add_ps(acc1, _mm_mul_ps(d1, d1));
+            acc2 = _mm_add_ps(acc2, _mm_mul_ps(d2, d2));
+            acc3 = _mm_add_ps(acc3, _mm_mul_ps(d3, d3));
+        }
+        out[tau] = differenceTail(x, n, tau, j, horizontalSumSse(acc0));
+        out[tau + 1] = differenceTail(x, n, tau + 1, j, horizontalSumSse(acc1));
+        out[tau + 2] = differenceTail(x, n, tau + 2, j, horizontalSumSse(acc2));
+        out[tau + 3] = differenceTail(x, n, tau + 3, j, horizontalSumSse(acc3));
+    }
+    for (; tau < tauEnd; ++tau) {
+        __m128 acc = _mm_setzero_ps();
+        int j = 0;
+        for (; j + 4 <= n - tau; j += 4) {
+            __m128 delta = _mm_sub_ps(_mm_loadu_ps(x + j), _mm_loadu_ps(x + j + tau));
+            acc = _mm_add_ps(acc, _mm_mul_ps(delta, delta));
+        }
+        out[tau] = differenceTail(x, n, tau, j, horizontalSumSse(acc));
+    }
+}
+
+// Entering terms share x[n + i] and leaving terms x[i] across the lags of a pass.
+static void slideDifferenceSse2(const float* x, int n, int hop, int tauBegin, int tauEnd, float* d) {
+    const float* incoming = x + n;
+    int tau = tauBegin;
+    for (; tau + LAGS_PER_PASS <= tauEnd; tau += LAGS_PER_PASS) {
+        __m128 acc0 = _mm_setzero_ps();
+        __m128 acc1 = _mm_setzero_ps();
+        __m128 acc2 = _mm_setzero_ps();
+        __m128 acc3 = _mm_setzero_ps();
+        int i = 0;
+        for (; i + 4 <= hop; i += 4) {
+            __m128 in = _mm_loadu_ps(incoming + i);
+            __m128 out = _mm_loadu_ps(x + i);
+            __m128 e0 = _mm_sub_ps(_mm_loadu_ps(incoming - tau + i), in);
+            __m128 e1 = _mm_sub_ps(_mm_loadu_ps(incoming - tau - 1 + i), in);
+            __m128 e2 = _mm_sub_ps(_mm_loadu_ps(incoming - tau - 2 + i), in);
+            __m128 e3 = _mm_sub_ps(_mm_loadu_ps(incoming - tau - 3 + i), in);
+            __m128 l0 = _mm_sub_ps(out, _mm_loadu_ps(x + i + tau));
+            __m128 l1 = _mm_sub_ps(out, _mm_loadu_ps(x + i + tau + 1));
+            __m128 l2 = _mm_sub_ps(out, _mm_loadu_ps(x + i + tau + 2));
+            __m128 l3 = _mm_sub_ps(out, _mm_loadu_ps(x + i + tau + 3));
+            acc0 = _mm_add_ps(acc0, _mm_sub_ps(_mm_mul_ps(e0, e0), _mm_mul_ps(l0, l0)));
+            acc1 = _mm_add_ps(acc1, _mm_sub_ps(_mm_mul_ps(e1, e1), _mm_mul_ps(l1, l1)));
+            acc2 = _mm_add_ps(acc2, _mm_sub_ps(_mm_mul_ps(e2, e2), _mm_mul_ps(l2, l2)));
+            acc3 = _mm_add_ps(acc3, _mm_sub_ps(_mm_mul_ps(e3, e3), _mm_mul_ps(l3, l3)));
+        }
+        d[tau] += slideTail(x, n, hop, tau, i, horizontalSumSse(acc0));
+        d[tau + 1] += slideTail(x, n, hop, tau + 1, i, horizontalSumSse(acc1));
+        d[tau + 2] += slideTail(x, n, hop, tau + 2, i, horizontalSumSse(acc2));
+        d[tau + 3] += slideTail(x, n, hop, tau + 3, i, horizontalSumSse(acc3));
+    }
+    for (; tau < tauEnd; ++tau) {
+        __m128 acc = _mm_setzero_ps();
+        int i = 0;
+        for (; i + 4 <= hop; i += 4) {
+            __m128 entering = _mm_sub_ps(_mm_loadu_ps(incoming - tau + i), _mm_loadu_ps(incoming + i));
+            __m128 leaving = _mm_sub_ps(_mm_loadu_ps(x + i), _mm_loadu_ps(x + i + tau));
+            acc = _mm_add_ps(acc, _mm_sub_ps(_mm_mul_ps(entering, entering), _mm_mul_ps(leaving, leaving)));
+        }
+        d[tau] += slideTail(x, n, hop, tau, i, horizontalSumSse(acc));
+    }
+}
+
+static void cumulativeMeanNormalizeSse2(float* d, int tauBegin, int tauEnd) {
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 epsilon = _mm_set1_ps(std::numeric_limits<float>::epsilon());
+    const __m128 step = _mm_set1_ps(4.0f);
+    __m128 carry = _mm_setzero_ps(); // Running sum of everything before this block, in every lane
+    int tau = tauBegin;
+    __m128 lags = _mm_setr_ps(static_cast<float>(tau), static_cast<float>(tau + 1),
+                              static_cast<float>(tau + 2), static_cast<float>(tau + 3));
+    for (; tau + 4 <= tauEnd; tau += 4) {
+        __m128 v = _mm_loadu_ps(d + tau);
+        // Inclusive prefix sum inside the vector: [v0, v0+v1, v0+v1+v2, v0+v1+v2+v3]
+        __m128 scan = _mm_add_ps(v, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(v), 4)));
+        scan = _mm_add_ps(scan, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(scan), 8)));
+        scan = _mm_add_ps(scan, carry);
+        __m128 normalized = _mm_div_ps(_mm_mul_ps(v, lags), scan);
+        __m128 valid = _mm_cmpgt_ps(scan, epsilon);
+        _mm_storeu_ps(d + tau, _mm_or_ps(_mm_and_ps(valid, normalized), _mm_andnot_ps(valid, one)));
+        carry = _mm_shuffle_ps(scan, scan, _MM_SHUFFLE(3, 3, 3, 3));
+        lags = _mm_add_ps(lags, step);
+    }
+    float runningSum = _mm_cvtss_f32(carry);
+    for (; tau < tauEnd; ++tau) {
+        runningSum += d[tau];
+        d[tau] = (runningSum > std::numeric_limits<float>::epsilon()) ? (d[tau] * tau / runningSum) : 1.0f;
+    }
+}
+
+static const DspKernels kSse2Kernels = {
+        "sse2", sumOfSquaresSse2, differenceSse2, slideDifferenceSse2, cumulativeMeanNormalizeSse2};
+
+// --- AVX2 + FMA (x86_64, selected at runtime) ---
+#define AFINADOR_TARGET_AVX2 __attribute__((target("avx2,fma")))
+
+AFINADOR_TARGET_AVX2 static inline float horizontalSumAvx(__m256 v) {
+    return horizontalSumSse(_mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1)));
+}
+
+AFINADOR_TARGET_AVX2 static float sumOfSquaresAvx2(const float* x, int n) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256 a = _mm256_loadu_ps(x + i);
+        __m256 b = _mm256_loadu_ps(x + i + 8);
+        acc0 = _mm256_fmadd_ps(a, a, acc0);
+        acc1 = _mm256_fmadd_ps(b, b, acc1);
+    }
+    float sum = horizontalSumAvx(_mm256_add_ps(acc0, acc1));
+    for (; i < n; ++i) {
+        sum += x[i] * x[i];
+    }
+    return sum;
+}
+
+AFINADOR_TARGET_AVX2 static void differenceAvx2(const float* x, int n, int tauBegin, int tauEnd, float* out) {
+    int tau = tauBegin;
+    for (; tau + LAGS_PER_PASS <= tauEnd; tau += LAGS_PER_PASS) {
+        const int shared = n - (tau + LAGS_PER_PASS - 1); // Terms every lag of this pass has
+        __m256 acc0 = _mm256_setzero_ps();
+        __m256 acc1 = _mm256_setzero_ps();
+        __m256 acc2 = _mm256_setzero_ps();
+        __m256 acc3 = _mm256_setzero_ps();
+        int j = 0;
+        for (; j + 8 <= shared; j += 8) {
+            __m256 a = _mm256_loadu_ps(x + j);
+            __m256 d0 = _mm256_sub_ps(a, _mm256_loadu_ps(x + j + tau));
+            __m256 d1 = _mm256_sub_ps(a, _mm256_loadu_ps(x + j + tau + 1));
+            __m256 d2 = _mm256_sub_ps(a, _mm256_loadu_ps(x + j + tau + 2));
+            __m256 d3 = _mm256_sub_ps(a, _mm256_loadu_ps(x + j + tau + 3));
+            acc0 = _mm256_fmadd_ps(d0, d0, acc0);
+            acc1 = _mm256_fmadd_ps(d1, d1, acc1);
+            acc2 = _mm256_fmadd_ps(d2, d2, acc2);
+            acc3 = _mm256_fmadd_ps(d3, d3, acc3);
+        }
+        out[tau] = differenceTail(x, n, tau, j, horizontalSumAvx(acc0));
+        out[tau + 1] = differenceTail(x, n, tau + 1, j, horizontalSumAvx(acc1));
+        out[tau + 2] = differenceTail(x, n, tau + 2, j, horizontalSumAvx(acc2));
+        out[tau + 3] = differenceTail(x, n, tau + 3, j, horizontalSumAvx(acc3));
+    }
+    for (; tau < tauEnd; ++tau) {
+        __m256 acc = _mm256_setzero_ps();
+        int j = 0;
+        for (; j + 8 <= n - tau; j += 8) {
+            __m256 delta = _mm256_sub_ps(_mm256_loadu_ps(x + j), _mm256_loadu_ps(x + j + tau));
+            acc = _mm256_fmadd_ps(delta, delta, acc);
+        }
+        out[tau] = differenceTail(x, n, tau, j, horizontalSumAvx(acc));
+    }
+}
+
+AFINADOR_TARGET_AVX2 static void slideDifferenceAvx2(const float* x, int n, int hop, int tauBegin, int tauEnd,
+                                                     float* d) {
+    const float* incoming = x + n;
+    int tau = tauBegin;
+    for (; tau + LAGS_PER_PASS <= tauEnd; tau += LAGS_PER_PASS) {
+        __m256 acc0 = _mm256_setzero_ps();
+        __m256 acc1 = _mm256_setzero_ps();
+        __m256 acc2 = _mm256_setzero_ps();
+        __m256 acc3 = _mm256_setzero_ps();
+        int i = 0;
+        for (; i + 8 <= hop; i += 8) {
+            __m256 in = _mm256_loadu_ps(incoming + i);
+            __m256 out = _mm256_loadu_ps(x + i);
+            __m256 e0 = _mm256_sub_ps(_mm256_loadu_ps(incoming - tau + i), in);
+            __m256 e1 = _mm256_sub_ps(_mm256_loadu_ps(incoming - tau - 1 + i), in);
+            __m256 e2 = _mm256_sub_ps(_mm256_loadu_ps(incoming - tau - 2 + i), in);
+            __m256 e3 = _mm256_sub_ps(_mm256_loadu_ps(incoming - tau - 3 + i), in);
+            __m256 l0 = _mm256_sub_ps(out, _mm256_loadu_ps(x + i + tau));
+            __m256 l1 = _mm256_sub_ps(out, _mm256_loadu_ps(x + i + tau + 1));
+            __m256 l2 = _mm256_sub_ps(out, _mm256_loadu_ps(x + i + tau + 2));
+            __m256 l3 = _mm256_sub_ps(out, _mm256_loadu_ps(x + i + tau + 3));
+            acc0 = _mm256_fnmadd_ps(l0, l0, _mm256_fmadd_ps(e0, e0, acc0));
+            acc1 = _mm256_fnmadd_ps(l1, l1, _mm256_fmadd_ps(e1, e1, acc1));
+            acc2 = _mm256_fnmadd_ps(l2, l2, _mm256_fmadd_ps(e2, e2, acc2));
+            acc3 = _mm256_fnmadd_ps(l3, l3, _mm256_fmadd_ps(e3, e3, acc3));
+        }
+        d[tau] += slideTail(x, n, hop, tau, i, horizontalSumAvx(acc0));
+        d[tau + 1] += slideTail(x, n, hop, tau + 1, i, horizontalSumAvx(acc1));
+        d[tau + 2] += slideTail(x, n, hop, tau + 2, i, horizontalSumAvx(acc2));
+        d[tau + 3] += slideTail(x, n, hop, tau + 3, i, horizontalSumAvx(acc3));
+    }
+    for (; tau < tauEnd; ++tau) {
+        __m256 acc = _mm256_setzero_ps();
+        int i = 0;
+        for (; i + 8 <= hop; i += 8) {
+            __m256 entering = _mm256_sub_ps(_mm256_loadu_ps(incoming - tau + i), _mm256_loadu_ps(incoming + i));
+            __m256 leaving = _mm256_sub_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(x + i + tau));
+            acc = _mm256_fnmadd_ps(leaving, leaving, _mm256_fmadd_ps(entering, entering, acc));
+        }
+        d[tau] += slideTail(x, n, hop, tau, i, horizontalSumAvx(acc));
+    }
+}
+
+// The prefix-sum normalisation is latency bound; the SSE2 scan is as fast as an 8-lane one here.
+static const DspKernels kAvx2Kernels = {
+        "avx2", sumOfSquaresAvx2, differenceAvx2, slideDifferenceAvx2, cumulativeMeanNormalizeSse2};
+#endif // AFINADOR_SIMD_X86
+
+// --- Dispatch ---
+static const DspKernels& selectKernels() {
+#if defined(AFINADOR_SIMD_NEON)
+    return kNeonKernels;
+#elif defined(AFINADOR_SIMD_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return kAvx2Kernels;
+    }
+    return kSse2Kernels;
+#else
+    return kScalarKernels;
+#endif
+}
+
+const DspKernels& scalarKernels() {
+    return kScalarKernels;
+}
+
+const DspKernels& dspKernels() {
+    static const DspKernels& kernels = selectKernels();
+    return kernels;
+}
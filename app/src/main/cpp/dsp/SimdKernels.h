@@ -0,0 +1,35 @@
+#ifndef AFINADOR_SIMD_KERNELS_H
+#define AFINADOR_SIMD_KERNELS_H
+
+// --- Vectorised DSP Kernels ---
+// Hot loops of the detector, with a scalar reference implementation and SIMD versions:
+// NEON on ARM (compile-time), SSE2 on x86_64 (baseline) and AVX2+FMA on x86_64 when the CPU
+// supports it (runtime check). dspKernels() returns the best set for the running CPU.
+struct DspKernels {
+    const char* name;
+
+    // sum_{i<n} x[i]^2
+    float (*sumOfSquares)(const float* x, int n);
+
+    // YIN difference function for lags [tauBegin, tauEnd):
+    // out[tau] = sum_{j < n - tau} (x[j] - x[j + tau])^2
+    void (*difference)(const float* x, int n, int tauBegin, int tauEnd, float* out);
+
+    // Slides the difference function of lags [tauBegin, tauEnd) forward by 'hop' samples.
+    // x holds n + hop samples: d[] is the difference of the window x[0, n) on entry and of
+    // x[hop, n + hop) on return:
+    // d[tau] += sum_{i<hop} (x[n - tau + i] - x[n + i])^2 - sum_{i<hop} (x[i] - x[i + tau])^2
+    void (*slideDifference)(const float* x, int n, int hop, int tauBegin, int tauEnd, float* d);
+
+    // Cumulative mean normalisation in place over [tauBegin, tauEnd):
+    // d[tau] <- d[tau] * tau / sum_{k=tauBegin..tau} d[k]  (1 when the running sum is ~0)
+    void (*cumulativeMeanNormalize)(float* d, int tauBegin, int tauEnd);
+};
+
+// Plain C++ loops; the reference the SIMD kernels are checked against.
+const DspKernels& scalarKernels();
+
+// Fastest kernels available on this CPU (resolved once, thread-safe).
+const DspKernels& dspKernels();
+
+#endif // AFINADOR_SIMD_KERNELS_H
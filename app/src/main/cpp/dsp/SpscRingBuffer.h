@@ -0,0 +1,92 @@
+#ifndef AFINADOR_SPSC_RING_BUFFER_H
+#define AFINADOR_SPSC_RING_BUFFER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Lock-free single-producer/single-consumer ring buffer.
+// One thread may call write(), one other thread may call read()/skip(); neither ever blocks or
+// allocates. Capacity is rounded up to a power of two so indices wrap with a mask.
+template <typename T>
+class SpscRingBuffer {
+public:
+    explicit SpscRingBuffer(size_t minCapacity) {
+        size_t capacity = 1;
+        while (capacity < minCapacity) {
+            capacity <<= 1;
+        }
+        buffer_.assign(capacity, T());
+        mask_ = capacity - 1;
+    }
+
+    SpscRingBuffer(const SpscRingBuffer&) = delete;
+    SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+    size_t capacity() const { return buffer_.size(); }
+
+    size_t availableToRead() const {
+        return writeIndex_.load(std::memory_order_acquire) - readIndex_.load(std::memory_order_relaxed);
+    }
+
+    size_t availableToWrite() const {
+        return capacity() - (writeIndex_.load(std::memory_order_relaxed) - readIndex_.load(std::memory_order_acquire));
+    }
+
+    // Producer side. Writes as many items as fit and returns that count (the rest is dropped).
+    size_t write(const T* data, size_t count) {
+        const size_t write = writeIndex_.load(std::memory_order_relaxed);
+        const size_t read = readIndex_.load(std::memory_order_acquire);
+        const size_t toWrite = std::min(count, capacity() - (write - read));
+        const size_t start = write & mask_;
+        const size_t firstPart = std::min(toWrite, capacity() - start);
+        std::copy(data, data + firstPart, buffer_.begin() + start);
+        std::copy(data + firstPart, data + toWrite, buffer_.begin());
+        writeIndex_.store(write + toWrite, std::memory_order_release);
+        return toWrite;
+    }
+
+    // Producer side. Like write(), for items 'stride' apart in 'data' (one channel of interleaved
+    // frames), so channels are split without a scratch copy.
+    size_t writeStrided(const T* data, size_t count, size_t stride) {
+        const size_t write = writeIndex_.load(std::memory_order_relaxed);
+        const size_t read = readIndex_.load(std::memory_order_acquire);
+        const size_t toWrite = std::min(count, capacity() - (write - read));
+        for (size_t i = 0; i < toWrite; ++i) {
+            buffer_[(write + i) & mask_] = data[i * stride];
+        }
+        writeIndex_.store(write + toWrite, std::memory_order_release);
+        return toWrite;
+    }
+
+    // Consumer side. Reads up to 'count' items and returns how many were read.
+    size_t read(T* dest, size_t count) {
+        const size_t read = readIndex_.load(std::memory_order_relaxed);
+        const size_t write = writeIndex_.load(std::memory_order_acquire);
+        const size_t toRead = std::min(count, write - read);
+        const size_t start = read & mask_;
+        const size_t firstPart = std::min(toRead, capacity() - start);
+        std::copy(buffer_.begin() + start, buffer_.begin() + start + firstPart, dest);
+        std::copy(buffer_.begin(), buffer_.begin() + (toRead - firstPart), dest + firstPart);
+        readIndex_.store(read + toRead, std::memory_order_release);
+        return toRead;
+    }
+
+    // Consumer side. Discards up to 'count' items without copying them.
+    size_t skip(size_t count) {
+        const size_t read = readIndex_.load(std::memory_order_relaxed);
+        const size_t toSkip = std::min(count, writeIndex_.load(std::memory_order_acquire) - read);
+        readIndex_.store(read + toSkip, std::memory_order_release);
+        return toSkip;
+    }
+
+private:
+    std::vector<T> buffer_;
+    size_t mask_ = 0;
+    // Separate cache lines so producer and consumer do not false-share their indices
+    alignas(64) std::atomic<size_t> writeIndex_{0};
+    alignas(64) std::atomic<size_t> readIndex_{0};
+};
+
+#endif // AFINADOR_SPSC_RING_BUFFER_H
@@ -0,0 +1,200 @@
+#include "StrobeAnalyzer.h"
+#include "DspLog.h"
+#include "PitchAnalyzer.h"
+#include "SimdKernels.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kTwoPi = 2.0 * kPi;
+constexpr float STROBE_LEVEL_SECONDS = 0.03f;    // Smoothing of the input power the bands are compared to
+constexpr float STROBE_MAX_DEVIATION = 1.0595f;  // A semitone: bands must step less than pi per hop up to it
+}
+
+bool StrobeAnalyzer::configure(const StrobeConfig& config) {
+    if (config.sampleRate <= 0 || config.hopSize <= 0 || config.harmonics < 1 ||
+        config.harmonics > STROBE_MAX_HARMONICS || config.trackingSeconds <= 0.0f) {
+        DSP_LOGE("Invalid strobe config: %d Hz, hop %d, %d harmonics, %.2f s.",
+                 config.sampleRate, config.hopSize, config.harmonics, config.trackingSeconds);
+        return false;
+    }
+    config_ = config;
+    const double hopsPerSecond = static_cast<double>(config.sampleRate) / config.hopSize;
+    const int historySize = std::max(2, static_cast<int>(std::lround(config.trackingSeconds * hopsPerSecond)));
+    history_.assign(historySize, 0.0);
+    minFitCount_ = std::min(historySize, std::max(2, static_cast<int>(std::ceil(STROBE_MIN_FIT_SECONDS * hopsPerSecond))));
+    setTarget(0.0f);
+    return true;
+}
+
+void StrobeAnalyzer::setTarget(float frequency) {
+    target_ = 0.0f;
+    bandCount_ = 0;
+    const double sampleRate = config_.sampleRate;
+    if (frequency >= MIN_VALID_FREQUENCY && frequency < 0.45 * sampleRate) {
+        target_ = frequency;
+        // Upper bands must stay below Nyquist and must not wrap between hops a semitone off target
+        const double wrapLimit = 0.5 * sampleRate / config_.hopSize;
+        for (int h = 1; h <= config_.harmonics; ++h) {
+            const double band = static_cast<double>(h) * frequency;
+            if (band >= 0.45 * sampleRate || band * (STROBE_MAX_DEVIATION - 1.0) >= wrapLimit) break;
+            oscillatorStep_[bandCount_++] = kTwoPi * band / sampleRate;
+        }
+        coefficient_ = static_cast<float>(1.0 - std::exp(-kTwoPi * STROBE_BANDWIDTH * frequency / sampleRate));
+    }
+    reset();
+}
+
+void StrobeAnalyzer::reset() {
+    for (int b = 0; b < STROBE_MAX_HARMONICS; ++b) {
+        oscillatorPhase_[b] = 0.0;
+        std::fill(stages_[b], stages_[b] + STROBE_FILTER_ORDER, std::complex<float>(0.0f, 0.0f));
+        previous_[b] = std::complex<float>(0.0f, 0.0f);
+    }
+    hasPrevious_ = false;
+    hopFilled_ = 0;
+    hopSumOfSquares_ = 0.0;
+    meanSquare_ = 0.0f;
+    unwrappedPhase_ = 0.0;
+    clearHistory();
+}
+
+void StrobeAnalyzer::clearHistory() {
+    historyHead_ = 0;
+    historyCount_ = 0;
+}
+
+bool StrobeAnalyzer::process(const float* input, int count, StrobeResult& result) {
+    if (bandCount_ == 0 || count <= 0) return false;
+    bool produced = false;
+    while (count > 0) {
+        const int take = std::min(count, config_.hopSize - hopFilled_);
+        mix(input, take);
+        hopSumOfSquares_ += dspKernels().sumOfSquares(input, take);
+        hopFilled_ += take;
+        input += take;
+        count -= take;
+        if (hopFilled_ == config_.hopSize) {
+            finishHop(result);
+            produced = true;
+            hopFilled_ = 0;
+            hopSumOfSquares_ = 0.0;
+        }
+    }
+    return produced;
+}
+
+// Demodulates 'count' samples into every band: multiply by e^(-i phase), then the low-pass
+// cascade. The oscillator is re-seeded from the double-precision phase on every call, so the
+// float rotation never drifts for more than one hop.
+void StrobeAnalyzer::mix(const float* input, int count) {
+    const float a = coefficient_;
+    for (int b = 0; b < bandCount_; ++b) {
+        const double step = oscillatorStep_[b];
+        const float rotationRe = static_cast<float>(std::cos(step));
+        const float rotationIm = static_cast<float>(-std::sin(step));
+        float oscRe = static_cast<float>(std::cos(oscillatorPhase_[b]));
+        float oscIm = static_cast<float>(-std::sin(oscillatorPhase_[b]));
+        float re[STROBE_FILTER_ORDER];
+        float im[STROBE_FILTER_ORDER];
+        for (int s = 0; s < STROBE_FILTER_ORDER; ++s) {
+            re[s] = stages_[b][s].real();
+            im[s] = stages_[b][s].imag();
+        }
+        for (int i = 0; i < count; ++i) {
+            float inRe = input[i] * oscRe;
+            float inIm = input[i] * oscIm;
+            for (int s = 0; s < STROBE_FILTER_ORDER; ++s) {
+                re[s] += a * (inRe - re[s]);
+                im[s] += a * (inIm - im[s]);
+                inRe = re[s];
+                inIm = im[s];
+            }
+            const float nextRe = oscRe * rotationRe - oscIm * rotationIm;
+            oscIm = oscRe * rotationIm + oscIm * rotationRe;
+            oscRe = nextRe;
+        }
+        for (int s = 0; s < STROBE_FILTER_ORDER; ++s) {
+            stages_[b][s] = std::complex<float>(re[s], im[s]);
+        }
+        oscillatorPhase_[b] = std::fmod(oscillatorPhase_[b] + step * count, kTwoPi);
+    }
+}
+
+void StrobeAnalyzer::finishHop(StrobeResult& result) {
+    const float levelSmoothing = 1.0f - std::exp(-static_cast<float>(config_.hopSize) /
+                                                 (STROBE_LEVEL_SECONDS * config_.sampleRate));
+    meanSquare_ += levelSmoothing * (static_cast<float>(hopSumOfSquares_ / config_.hopSize) - meanSquare_);
+
+    result = StrobeResult();
+    result.targetFrequency = target_;
+    result.rms = std::sqrt(meanSquare_);
+    result.gated = result.rms < MIN_RMS_THRESHOLD;
+    result.bandCount = bandCount_;
+
+    // Band powers (a sinusoid of amplitude A demodulates to A/2) and the power-weighted phase
+    // step of the fundamental
+    float totalPower = 0.0f;
+    double weightedStep = 0.0;
+    for (int b = 0; b < bandCount_; ++b) {
+        const std::complex<float> output = stages_[b][STROBE_FILTER_ORDER - 1];
+        const float power = 2.0f * std::norm(output);
+        totalPower += power;
+        result.bandLevels[b] = meanSquare_ > 0.0f ? std::sqrt(power / meanSquare_) : 0.0f;
+        if (hasPrevious_) {
+            weightedStep += power * std::arg(output * std::conj(previous_[b])) / (b + 1);
+        }
+        previous_[b] = output;
+    }
+    if (hasPrevious_ && totalPower > 0.0f) {
+        unwrappedPhase_ += weightedStep / totalPower;
+    }
+    hasPrevious_ = true;
+    result.confidence = meanSquare_ > 0.0f ? std::min(1.0f, totalPower / meanSquare_) : 0.0f;
+    result.phase = static_cast<float>(std::fmod(unwrappedPhase_, kTwoPi));
+    if (result.phase < 0.0f) result.phase += static_cast<float>(kTwoPi);
+
+    if (result.gated || result.confidence < STROBE_MIN_LOCK) {
+        clearHistory(); // The next note starts a fresh fit
+        return;
+    }
+    const int size = static_cast<int>(history_.size());
+    history_[(historyHead_ + historyCount_) % size] = unwrappedPhase_;
+    if (historyCount_ < size) {
+        ++historyCount_;
+    } else {
+        historyHead_ = (historyHead_ + 1) % size;
+    }
+    if (historyCount_ < minFitCount_) return;
+
+    const double deviationHz = fitSlope() * config_.sampleRate / (kTwoPi * config_.hopSize);
+    result.frequency = static_cast<float>(target_ + deviationHz);
+    if (result.frequency <= 0.0f) {
+        result.frequency = 0.0f;
+        return;
+    }
+    result.centsOffset = static_cast<float>(1200.0 * std::log2(result.frequency / static_cast<double>(target_)));
+    result.phaseVelocity = static_cast<float>(kTwoPi * deviationHz);
+    result.locked = true;
+}
+
+// Least-squares slope of the phase history against the hop index.
+double StrobeAnalyzer::fitSlope() const {
+    const int size = static_cast<int>(history_.size());
+    const double origin = history_[historyHead_];
+    const double meanX = 0.5 * (historyCount_ - 1);
+    double meanY = 0.0;
+    for (int i = 0; i < historyCount_; ++i) {
+        meanY += history_[(historyHead_ + i) % size] - origin;
+    }
+    meanY /= historyCount_;
+    double covariance = 0.0;
+    double variance = 0.0;
+    for (int i = 0; i < historyCount_; ++i) {
+        const double dx = i - meanX;
+        covariance += dx * (history_[(historyHead_ + i) % size] - origin - meanY);
+        variance += dx * dx;
+    }
+    return covariance / variance;
+}
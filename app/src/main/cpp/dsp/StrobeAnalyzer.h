@@ -0,0 +1,92 @@
+#ifndef AFINADOR_STROBE_ANALYZER_H
+#define AFINADOR_STROBE_ANALYZER_H
+
+#include "NoteMapping.h"
+#include <complex>
+#include <vector>
+
+// --- Strobe Analysis Constants ---
+constexpr int STROBE_MAX_HARMONICS = 4;   // Bands at 1..4 x the target
+constexpr int STROBE_FILTER_ORDER = 4;    // One-pole low-pass stages per band
+constexpr float STROBE_BANDWIDTH = 0.25f; // Band cutoff as a fraction of the target: rejects the neighbouring partials
+constexpr float STROBE_MIN_LOCK = 0.5f;   // Share of the input power the bands must hold to count as locked
+constexpr float STROBE_MIN_FIT_SECONDS = 0.05f; // Phase history needed before cents are reported
+
+struct StrobeConfig {
+    int sampleRate = 44100;
+    int hopSize = 128;            // Samples between results
+    int harmonics = STROBE_MAX_HARMONICS;
+    float trackingSeconds = 0.5f; // Phase history the frequency is fitted over
+};
+
+struct StrobeResult {
+    float targetFrequency = 0.0f;
+    float frequency = 0.0f;                  // 0 until locked
+    float centsOffset = CENTS_NOT_AVAILABLE; // Versus targetFrequency
+    float phase = 0.0f;         // Strobe position of the fundamental, radians in [0, 2pi)
+    float phaseVelocity = 0.0f; // radians/s: 2pi (frequency - target), 0 until locked
+    float confidence = 0.0f;    // Share of the input power inside the bands, 0..1
+    float rms = 0.0f;
+    bool gated = false;  // Input below MIN_RMS_THRESHOLD
+    bool locked = false; // Bands hold the signal and the phase history is long enough to fit
+    int bandCount = 0;
+    float bandLevels[STROBE_MAX_HARMONICS] = {}; // Band amplitude over the input RMS, for drawing
+};
+
+// --- Strobe Analyzer ---
+// Deviation from one known target instead of general pitch detection. Each band demodulates the
+// input at h x target with a phase-continuous oscillator and low-passes the result, so its phase
+// turns at 2pi h (f - target) rad/s. The per-hop phase steps of the bands are combined in
+// fundamental units, weighted by band power, and unwrapped; a least-squares line over the last
+// trackingSeconds gives the frequency. O(bands) work per sample; a fit over half a second
+// resolves well under 0.1 cent on a steady tone. Stiff strings read their upper partials sharp,
+// so the reading leans slightly sharp of the fundamental alone when those are strong.
+// configure() allocates everything; setTarget() and process() never allocate.
+class StrobeAnalyzer {
+public:
+    bool configure(const StrobeConfig& config);
+    const StrobeConfig& config() const { return config_; }
+
+    // Target fundamental in Hz (0 disables the analysis). Restarts the bands and the history.
+    void setTarget(float frequency);
+    float target() const { return target_; }
+
+    // Clears the band filters and the phase history.
+    void reset();
+
+    // Appends 'count' samples. Returns true (and fills 'result') when a hop completed inside them;
+    // with several, 'result' holds the last one.
+    bool process(const float* input, int count, StrobeResult& result);
+
+private:
+    void mix(const float* input, int count);
+    void finishHop(StrobeResult& result);
+    void clearHistory();
+    double fitSlope() const; // Radians per hop
+
+    StrobeConfig config_;
+    float target_ = 0.0f;
+    int bandCount_ = 0;
+    float coefficient_ = 0.0f; // One-pole smoothing factor shared by the bands
+
+    // --- Bands ---
+    double oscillatorPhase_[STROBE_MAX_HARMONICS] = {}; // Kept in [0, 2pi), exact across hops
+    double oscillatorStep_[STROBE_MAX_HARMONICS] = {};
+    std::complex<float> stages_[STROBE_MAX_HARMONICS][STROBE_FILTER_ORDER];
+    std::complex<float> previous_[STROBE_MAX_HARMONICS]; // Band output at the previous hop
+    bool hasPrevious_ = false;
+
+    // --- Hop accumulation ---
+    int hopFilled_ = 0;
+    double hopSumOfSquares_ = 0.0;
+    float meanSquare_ = 0.0f; // Smoothed over hops, the reference the bands' power is compared to
+
+    // --- Phase history (fundamental radians, unwrapped) ---
+    std::vector<double> history_; // Ring of trackingSeconds worth of hops
+    int historyHead_ = 0;
+    int historyCount_ = 0;
+    int minFitCount_ = 2;
+    double unwrappedPhase_ = 0.0;
+};
+
+#endif // AFINADOR_STROBE_ANALYZER_H
@@ -0,0 +1,259 @@
+#include "StrumAnalyzer.h"
+#include "DspLog.h"
+#include "PitchAnalyzer.h"
+#include "SimdKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+constexpr double kPi = 3.14159265358979323846;
+constexpr float kLn2 = 0.69314718f;
+constexpr float STRUM_GRID_MAX_CENTS = 4.0f; // Coarsest step of the harmonic-sum search
+}
+
+bool StrumAnalyzer::configure(const StrumConfig& config) {
+    if (config.sampleRate <= 0 || config.hopSize <= 0 || config.maxWindowSize < STRUM_MIN_WINDOW ||
+        !RealFft::isPowerOfTwo(config.maxWindowSize)) {
+        DSP_LOGE("Invalid strum config: %d Hz, max window %d, hop %d.",
+                 config.sampleRate, config.maxWindowSize, config.hopSize);
+        return false;
+    }
+    config_ = config;
+    ffts_.clear();
+    for (int size = STRUM_MIN_WINDOW; size <= config.maxWindowSize; size *= 2) {
+        ffts_.push_back(std::make_unique<RealFft>(size));
+    }
+    const int maxWindow = config.maxWindowSize;
+    history_.assign(maxWindow, 0.0f);
+    hann_.assign(maxWindow, 0.0f);
+    frame_.assign(maxWindow, 0.0f);
+    spectrum_.assign(maxWindow / 2 + 1, std::complex<float>(0.0f, 0.0f));
+    magnitude_.assign(maxWindow / 2 + 1, 0.0f);
+    scratch_.assign(maxWindow / 2 + 1, 0.0f);
+    stringCount_ = 0;
+    fft_ = nullptr;
+    reset();
+    return true;
+}
+
+void StrumAnalyzer::setStrings(const float* frequencies, int count) {
+    stringCount_ = 0;
+    const float nyquist = 0.5f * config_.sampleRate;
+    for (int i = 0; i < count && stringCount_ < MAX_STRUM_STRINGS; ++i) {
+        if (frequencies[i] < MIN_VALID_FREQUENCY || frequencies[i] >= nyquist) continue;
+        strings_[stringCount_++] = {frequencies[i], 0u, false};
+    }
+    reset();
+    if (stringCount_ == 0 || ffts_.empty()) {
+        stringCount_ = 0;
+        return;
+    }
+
+    // Shortest window that puts the lowest fundamental STRUM_BINS_PER_FUNDAMENTAL bins up
+    float lowest = strings_[0].target;
+    for (int s = 1; s < stringCount_; ++s) lowest = std::min(lowest, strings_[s].target);
+    const int wanted = static_cast<int>(std::ceil(config_.sampleRate * STRUM_BINS_PER_FUNDAMENTAL / lowest));
+    windowSize_ = std::min(std::max(RealFft::nextPowerOfTwo(wanted), STRUM_MIN_WINDOW), config_.maxWindowSize);
+    fft_ = ffts_[__builtin_ctz(static_cast<unsigned>(windowSize_ / STRUM_MIN_WINDOW))].get();
+    binHz_ = static_cast<float>(config_.sampleRate) / windowSize_;
+    for (int i = 0; i < windowSize_; ++i) {
+        hann_[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * kPi * i / windowSize_)); // Periodic
+    }
+    planStrings();
+}
+
+// Decides which partials each string is scored on, how far its search may reach, and the bins the
+// spectrum is needed over.
+void StrumAnalyzer::planStrings() {
+    const float maxSpread = std::exp2(STRUM_SEARCH_CENTS / 1200.0f);
+    const int maxBin = windowSize_ / 2 - 2; // Peaks need a neighbour on each side
+    float lowest = strings_[0].target;
+    float highest = 0.0f;
+    for (int s = 0; s < stringCount_; ++s) {
+        StringPlan& plan = strings_[s];
+        plan.harmonicMask = 0;
+        plan.searchCents = STRUM_SEARCH_CENTS;
+        plan.shared = false;
+        unsigned inRange = 0;
+        for (int h = 1; h <= STRUM_HARMONICS; ++h) {
+            const float partial = h * plan.target;
+            if (partial * maxSpread / binHz_ >= maxBin) break;
+            inRange |= 1u << (h - 1);
+            highest = std::max(highest, partial);
+
+            // A partial shared with another string's partial of lower (or equal) order belongs to
+            // that string. Distinct foreign partials bound the search, so that it cannot slide this
+            // partial onto them.
+            const float marginCents = 1200.0f * std::log2(1.0f + STRUM_COLLISION_BINS * binHz_ / partial);
+            float clearCents = STRUM_SEARCH_CENTS;
+            bool owned = true;
+            for (int o = 0; o < stringCount_ && owned; ++o) {
+                if (o == s) continue;
+                for (int k = 1; k <= STRUM_MASK_HARMONICS; ++k) {
+                    const float foreign = k * strings_[o].target;
+                    if (std::fabs(partial - foreign) < STRUM_COLLISION_BINS * binHz_) {
+                        if (k <= h) owned = false;
+                        continue;
+                    }
+                    clearCents = std::min(clearCents, std::fabs(1200.0f * std::log2(foreign / partial)) - marginCents);
+                }
+            }
+            if (!owned || clearCents < STRUM_MIN_SEARCH_CENTS) continue;
+            plan.harmonicMask |= 1u << (h - 1);
+            plan.searchCents = std::min(plan.searchCents, clearCents);
+        }
+        if (plan.harmonicMask == 0) { // Octave or unison strings: the mixed estimate is all there is
+            plan.harmonicMask = inRange;
+            plan.searchCents = STRUM_MIN_SEARCH_CENTS;
+            plan.shared = true;
+        }
+        lowest = std::min(lowest, plan.target);
+    }
+    firstBin_ = std::max(1, static_cast<int>(0.5f * lowest / binHz_));
+    lastBin_ = std::min(maxBin, static_cast<int>(std::ceil(highest * maxSpread / binHz_)) + 2);
+}
+
+void StrumAnalyzer::reset() {
+    std::fill(history_.begin(), history_.end(), 0.0f);
+    writePosition_ = 0;
+    filled_ = 0;
+    sinceAnalysis_ = 0;
+}
+
+bool StrumAnalyzer::process(const float* input, int count, StrumResult& result) {
+    if (stringCount_ == 0 || count <= 0) return false;
+    const int capacity = config_.maxWindowSize;
+    if (count > capacity) { // Only the newest samples can matter
+        input += count - capacity;
+        count = capacity;
+    }
+    const int first = std::min(count, capacity - writePosition_);
+    std::memcpy(history_.data() + writePosition_, input, first * sizeof(float));
+    std::memcpy(history_.data(), input + first, (count - first) * sizeof(float));
+    writePosition_ = (writePosition_ + count) & (capacity - 1);
+    filled_ = std::min(filled_ + count, capacity);
+    sinceAnalysis_ += count;
+    if (filled_ < windowSize_ || sinceAnalysis_ < config_.hopSize) return false;
+    sinceAnalysis_ = 0;
+
+    // Unwrap the newest window from the ring, applying the Hann window on the way
+    const int start = (writePosition_ - windowSize_) & (capacity - 1);
+    const int head = std::min(windowSize_, capacity - start);
+    const DspKernels& kernels = dspKernels();
+    const double energy = kernels.sumOfSquares(history_.data() + start, head) +
+                          kernels.sumOfSquares(history_.data(), windowSize_ - head);
+    for (int i = 0; i < head; ++i) frame_[i] = history_[start + i] * hann_[i];
+    for (int i = head; i < windowSize_; ++i) frame_[i] = history_[i - head] * hann_[i];
+    analyseFrame(static_cast<float>(std::sqrt(energy / windowSize_)), result);
+    return true;
+}
+
+void StrumAnalyzer::analyseWindow(const float* window, StrumResult& result) {
+    if (stringCount_ == 0) {
+        result = StrumResult();
+        return;
+    }
+    const double energy = dspKernels().sumOfSquares(window, windowSize_);
+    for (int i = 0; i < windowSize_; ++i) frame_[i] = window[i] * hann_[i];
+    analyseFrame(static_cast<float>(std::sqrt(energy / windowSize_)), result);
+}
+
+void StrumAnalyzer::analyseFrame(float rms, StrumResult& result) {
+    result.stringCount = stringCount_;
+    result.rms = rms;
+    result.gated = rms < MIN_RMS_THRESHOLD;
+    for (int s = 0; s < stringCount_; ++s) {
+        result.strings[s] = StringEstimate();
+        result.strings[s].targetFrequency = strings_[s].target;
+    }
+    if (result.gated) return;
+
+    fft_->forward(frame_.data(), spectrum_.data());
+    for (int k = 0; k <= lastBin_ + 1; ++k) {
+        magnitude_[k] = std::abs(spectrum_[k]);
+    }
+    const float floor = noiseFloor(firstBin_, lastBin_);
+    for (int s = 0; s < stringCount_; ++s) {
+        estimateString(strings_[s], floor, result.strings[s]);
+    }
+}
+
+// Median magnitude over the analysed band: most bins of a chord spectrum lie between partials.
+float StrumAnalyzer::noiseFloor(int firstBin, int lastBin) {
+    const int count = lastBin - firstBin + 1;
+    if (count <= 0) return 0.0f;
+    std::copy(magnitude_.begin() + firstBin, magnitude_.begin() + lastBin + 1, scratch_.begin());
+    std::nth_element(scratch_.begin(), scratch_.begin() + count / 2, scratch_.begin() + count);
+    return scratch_[count / 2];
+}
+
+// Sum of the (linearly interpolated) magnitudes at the scored partials of 'frequency'.
+float StrumAnalyzer::harmonicSum(const StringPlan& plan, float frequency) const {
+    float sum = 0.0f;
+    for (int h = 1; h <= STRUM_HARMONICS; ++h) {
+        if (!(plan.harmonicMask & (1u << (h - 1)))) continue;
+        const float position = h * frequency / binHz_;
+        const int bin = static_cast<int>(position);
+        if (bin + 1 > lastBin_) break;
+        const float fraction = position - bin;
+        sum += magnitude_[bin] + fraction * (magnitude_[bin + 1] - magnitude_[bin]);
+    }
+    return sum;
+}
+
+void StrumAnalyzer::estimateString(const StringPlan& plan, float floor, StringEstimate& estimate) const {
+    if (plan.harmonicMask == 0) return; // Not even the fundamental fits below the analysed band
+    // Step 1: harmonic-sum search, fine enough that the highest scored partial moves < 1/2 bin per step
+    const int highestHarmonic = 32 - __builtin_clz(plan.harmonicMask);
+    const float highestBin = highestHarmonic * plan.target / binHz_;
+    const float step = std::min(STRUM_GRID_MAX_CENTS, 0.5f * 1200.0f / (kLn2 * highestBin));
+    float bestScore = -1.0f;
+    float bestFrequency = plan.target;
+    for (float cents = -plan.searchCents; cents <= plan.searchCents; cents += step) {
+        const float frequency = plan.target * std::exp2(cents / 1200.0f);
+        const float score = harmonicSum(plan, frequency);
+        if (score > bestScore) {
+            bestScore = score;
+            bestFrequency = frequency;
+        }
+    }
+
+    // Step 2: locate each scored partial near the best candidate and average their fundamentals,
+    // weighted towards the strong, low partials (the least affected by inharmonicity)
+    const float threshold = STRUM_PEAK_SNR * std::max(floor, 1e-12f);
+    double weightedSum = 0.0;
+    double weightTotal = 0.0;
+    float strongest = 0.0f;
+    for (int h = 1; h <= highestHarmonic; ++h) {
+        if (!(plan.harmonicMask & (1u << (h - 1)))) continue;
+        int bin = static_cast<int>(std::lround(h * bestFrequency / binHz_));
+        if (bin < 2 || bin + 2 > lastBin_ + 1) continue;
+        if (magnitude_[bin - 1] > magnitude_[bin]) bin--;
+        else if (magnitude_[bin + 1] > magnitude_[bin]) bin++;
+        const float peak = magnitude_[bin];
+        if (peak < threshold || magnitude_[bin - 1] > peak || magnitude_[bin + 1] > peak) continue;
+
+        // Parabola through the log magnitudes (exact for a Gaussian main lobe, close for Hann)
+        const float left = std::log(magnitude_[bin - 1] + 1e-20f);
+        const float centre = std::log(peak);
+        const float right = std::log(magnitude_[bin + 1] + 1e-20f);
+        const float curvature = left - 2.0f * centre + right;
+        float offset = curvature < 0.0f ? 0.5f * (left - right) / curvature : 0.0f;
+        offset = std::min(0.5f, std::max(-0.5f, offset));
+
+        const double weight = static_cast<double>(peak) / h;
+        weightedSum += weight * (bin + offset) * binHz_ / h;
+        weightTotal += weight;
+        strongest = std::max(strongest, peak);
+    }
+    if (weightTotal <= 0.0) return;
+
+    const float frequency = static_cast<float>(weightedSum / weightTotal);
+    const float cents = 1200.0f * std::log2(frequency / plan.target);
+    if (std::fabs(cents) > plan.searchCents) return; // Pulled away by a neighbouring partial
+    estimate.frequency = frequency;
+    estimate.centsOffset = cents;
+    estimate.confidence = std::min(1.0f, std::max(0.0f, 1.0f - threshold / strongest)) * (plan.shared ? 0.5f : 1.0f);
+    estimate.shared = plan.shared;
+}
@@ -0,0 +1,108 @@
+#ifndef AFINADOR_STRUM_ANALYZER_H
+#define AFINADOR_STRUM_ANALYZER_H
+
+#include "Fft.h"
+#include "NoteMapping.h"
+#include <complex>
+#include <memory>
+#include <vector>
+
+// --- Strum Analysis Constants ---
+constexpr int MAX_STRUM_STRINGS = 12;
+constexpr int STRUM_HARMONICS = 6;           // Partials scored per string
+constexpr int STRUM_MASK_HARMONICS = 12;     // Partials of the other strings checked for collisions
+constexpr int STRUM_MIN_WINDOW = 4096;
+constexpr int STRUM_BINS_PER_FUNDAMENTAL = 16; // The lowest string's fundamental sits at least this many bins up
+constexpr float STRUM_COLLISION_BINS = 2.0f;  // Partials closer than this share a Hann main lobe
+constexpr float STRUM_SEARCH_CENTS = 100.0f;  // Widest search around each string's target
+constexpr float STRUM_MIN_SEARCH_CENTS = 40.0f; // Partials with another string's partial closer than this are not scored
+constexpr float STRUM_PEAK_SNR = 8.0f;        // Partial peak over the median spectrum level needed to count
+
+struct StrumConfig {
+    int sampleRate = 44100;
+    int maxWindowSize = 32768; // Power of two; strings too low for it get coarser bins
+    int hopSize = 4096;        // Input samples between analyses
+};
+
+// One string of the strum. frequency is 0 (and centsOffset CENTS_NOT_AVAILABLE) when none of its
+// partials stood out of the spectrum.
+struct StringEstimate {
+    float targetFrequency = 0.0f;
+    float frequency = 0.0f;
+    float centsOffset = CENTS_NOT_AVAILABLE; // Versus targetFrequency
+    float confidence = 0.0f;                 // 0..1
+    bool shared = false; // Every partial overlaps another string's, so the estimate mixes both
+};
+
+struct StrumResult {
+    int stringCount = 0;
+    float rms = 0.0f;
+    bool gated = false; // Window was below MIN_RMS_THRESHOLD and not analysed
+    StringEstimate strings[MAX_STRUM_STRINGS];
+};
+
+// --- Strum Analyzer ---
+// Tunes every string of an instrument from one strummed chord. A Hann-windowed FFT long enough to
+// resolve the lowest string is scored, per string, by the harmonic sum of its partials around the
+// target; the partials at the best candidate are then located by log-parabolic peak interpolation
+// and averaged into the estimate. A partial that collides with a lower-order partial of another
+// string (E2's 4th and E4's fundamental) is left to that string, and each search stops short of
+// the other strings' partials, so strings further off than that are for the single-note mode.
+// configure() allocates everything; setStrings() and the process calls never allocate.
+class StrumAnalyzer {
+public:
+    bool configure(const StrumConfig& config);
+    const StrumConfig& config() const { return config_; }
+
+    // Open-string targets in Hz (at most MAX_STRUM_STRINGS; count 0 disables the analysis). Picks
+    // the window length for the lowest string and restarts the window.
+    void setStrings(const float* frequencies, int count);
+    int stringCount() const { return stringCount_; }
+    int windowSize() const { return windowSize_; }
+
+    // Clears the window; the next result comes once windowSize() samples have been collected again.
+    void reset();
+
+    // Appends 'count' samples. Returns true (and fills 'result') when an analysis ran, every
+    // config().hopSize samples once the window is full.
+    bool process(const float* input, int count, StrumResult& result);
+
+    // Analyses windowSize() samples at once, independent of the collected window.
+    void analyseWindow(const float* window, StrumResult& result);
+
+private:
+    struct StringPlan {
+        float target = 0.0f;
+        unsigned harmonicMask = 0; // Bit h - 1: partial h is scored
+        float searchCents = STRUM_SEARCH_CENTS;
+        bool shared = false;
+    };
+
+    void planStrings();
+    void analyseFrame(float rms, StrumResult& result);
+    float noiseFloor(int firstBin, int lastBin);
+    float harmonicSum(const StringPlan& plan, float frequency) const;
+    void estimateString(const StringPlan& plan, float floor, StringEstimate& estimate) const;
+
+    StrumConfig config_;
+    std::vector<std::unique_ptr<RealFft>> ffts_; // One plan per power of two from STRUM_MIN_WINDOW
+    std::vector<float> history_;   // Ring of the last maxWindowSize input samples
+    std::vector<float> hann_;      // For the current window size
+    std::vector<float> frame_;     // Windowed samples handed to the FFT
+    std::vector<std::complex<float>> spectrum_;
+    std::vector<float> magnitude_; // |X[k]| up to lastBin_
+    std::vector<float> scratch_;   // Median selection
+    int writePosition_ = 0;
+    int filled_ = 0;
+    int sinceAnalysis_ = 0;
+
+    StringPlan strings_[MAX_STRUM_STRINGS];
+    int stringCount_ = 0;
+    int windowSize_ = STRUM_MIN_WINDOW;
+    RealFft* fft_ = nullptr;
+    float binHz_ = 0.0f;
+    int firstBin_ = 0; // Range the noise floor is taken over and the magnitudes are computed for
+    int lastBin_ = 0;
+};
+
+#endif // AFINADOR_STRUM_ANALYZER_H
@@ -0,0 +1,132 @@
+#include "TunerEngine.h"
+#include "DspLog.h"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+int64_t monotonicNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+}
+
+bool TunerEngine::configure(const EngineConfig& config) {
+    if (isStarted()) {
+        DSP_LOGE("Engine reconfigured while started.");
+        return false;
+    }
+    if (config.channelCount < 1 || config.channelCount > MAX_INPUT_CHANNELS ||
+        config.laneCount < 1 || config.laneCount > MAX_ENGINE_LANES) {
+        DSP_LOGE("Invalid engine layout: %d channel(s), %d lane(s).", config.channelCount, config.laneCount);
+        return false;
+    }
+    for (int i = 0; i < config.laneCount; ++i) {
+        if (config.laneChannels[i] < 0 || config.laneChannels[i] >= config.channelCount) {
+            DSP_LOGE("Lane %d selects channel %d of %d.", i, config.laneChannels[i], config.channelCount);
+            return false;
+        }
+    }
+    const size_t ringCapacity = config.ringCapacity > 0
+            ? config.ringCapacity
+            : std::max(4 * static_cast<size_t>(config.analysis.windowSize),
+                       static_cast<size_t>(config.analysis.sampleRate / 2));
+    for (int i = 0; i < config.laneCount; ++i) {
+        if (!lanes_[i].configure(i, config.analysis, ringCapacity)) return false;
+    }
+    config_ = config;
+    nanosPerFrame_ = 1e9 / config.analysis.sampleRate;
+    metrics_.reset();
+    metrics_.sampleRate.store(config.analysis.sampleRate, std::memory_order_relaxed);
+    return true;
+}
+
+void TunerEngine::start(AnalysisWorkerPool& pool, AnalysisSink& sink) {
+    if (isStarted()) return;
+    pool_ = &pool;
+    for (int i = 0; i < config_.laneCount; ++i) {
+        pool.attach(lanes_[i], sink);
+    }
+}
+
+void TunerEngine::stop() {
+    if (!isStarted()) return;
+    for (int i = 0; i < config_.laneCount; ++i) {
+        pool_->detach(lanes_[i]);
+    }
+    pool_ = nullptr;
+}
+
+void TunerEngine::onInput(const float* frames, int frameCount) {
+    if (frameCount <= 0) return;
+    const size_t count = static_cast<size_t>(frameCount);
+    const size_t stride = static_cast<size_t>(config_.channelCount);
+    uint64_t dropped = 0;
+    for (int i = 0; i < config_.laneCount; ++i) {
+        dropped += count - lanes_[i].write(frames + config_.laneChannels[i], count, stride);
+    }
+    if (dropped > 0) relaxedAdd(metrics_.droppedInputFrames, dropped);
+}
+
+void TunerEngine::processCallback(const float* frames, int frameCount, int32_t xRunCount) {
+    if (frameCount <= 0) return;
+    const int64_t callbackStart = monotonicNanos();
+    if (capture_) capture_->append(frames, frameCount, callbackStart, xRunCount);
+
+    // Only hand the samples over to the lanes: no DSP, locks or allocations here
+    onInput(frames, frameCount);
+
+    if (xRunCount >= 0) metrics_.xRunCount.store(xRunCount, std::memory_order_relaxed);
+    metrics_.callback.record(static_cast<uint64_t>(monotonicNanos() - callbackStart),
+                             static_cast<uint64_t>(nanosPerFrame_ * frameCount));
+}
+
+void TunerEngine::setCapture(CaptureWriter* capture) {
+    std::lock_guard<std::mutex> lock(captureMutex_);
+    capture_ = capture;
+    if (!capture_) return;
+    LaneSettings settings[MAX_ENGINE_LANES];
+    for (int i = 0; i < config_.laneCount; ++i) {
+        settings[i] = lanes_[i].settings();
+    }
+    capture_->setLanes(config_.laneCount, config_.laneChannels, settings);
+}
+
+void TunerEngine::setA4(float frequency) {
+    for (AnalysisLane& lane : lanes_) {
+        lane.setA4(frequency);
+    }
+    for (int i = 0; i < config_.laneCount; ++i) {
+        recordSettings(i);
+    }
+}
+
+void TunerEngine::setCandidateRanges(int lane, const FrequencyRange* ranges, int count) {
+    lanes_[lane].setCandidateRanges(ranges, count);
+    recordSettings(lane);
+}
+
+void TunerEngine::setStrumStrings(int lane, const float* frequencies, int count) {
+    lanes_[lane].setStrumStrings(frequencies, count);
+    recordSettings(lane);
+}
+
+void TunerEngine::setStrobeTarget(int lane, float frequency) {
+    lanes_[lane].setStrobeTarget(frequency);
+    recordSettings(lane);
+}
+
+void TunerEngine::setDutyCycle(int lane, const DutyCyclePolicy& policy) {
+    lanes_[lane].setDutyCycle(policy);
+    recordSettings(lane);
+}
+
+void TunerEngine::setLaneSettings(int lane, const LaneSettings& settings) {
+    lanes_[lane].setSettings(settings);
+    recordSettings(lane);
+}
+
+// Lanes past laneCount are not in the capture.
+void TunerEngine::recordSettings(int lane) {
+    std::lock_guard<std::mutex> lock(captureMutex_);
+    if (capture_ && lane < config_.laneCount) capture_->recordSettings(lane, lanes_[lane].settings());
+}
@@ -0,0 +1,84 @@
+#ifndef AFINADOR_TUNER_ENGINE_H
+#define AFINADOR_TUNER_ENGINE_H
+
+#include "AnalysisLane.h"
+#include "AnalysisWorkerPool.h"
+#include "CaptureFile.h"
+#include "EngineMetrics.h"
+#include <mutex>
+
+// --- Engine Constants ---
+constexpr int MAX_ENGINE_LANES = 8;    // Analysed channels per engine instance
+constexpr int MAX_INPUT_CHANNELS = 32; // Interleaved channels per input frame
+static_assert(MAX_ENGINE_LANES <= CAPTURE_MAX_LANES, "Captures record every lane");
+
+struct EngineConfig {
+    AnalysisConfig analysis;                    // Shared by the lanes
+    int channelCount = 1;                       // Interleaved channels per input frame
+    int laneCount = 1;
+    int laneChannels[MAX_ENGINE_LANES] = {};    // Input channel analysed by each lane
+    size_t ringCapacity = 0;                    // Samples per lane; 0 = half a second, at least 4 windows
+};
+
+// --- Tuner Engine ---
+// The platform-independent part of one engine instance: splits interleaved input frames into one
+// lane per selected channel and runs the lanes on a worker pool shared with other instances.
+// Streams, JNI and what happens to the results belong to the caller: the Android engine runs
+// processCallback() from its Oboe callback, capture replays run it from a file, and the host tools
+// feed onInput() synthetic multichannel audio.
+class TunerEngine {
+public:
+    // Sizes the lanes. Not while started.
+    bool configure(const EngineConfig& config);
+    const EngineConfig& config() const { return config_; }
+    int laneCount() const { return config_.laneCount; }
+
+    // Attaches the lanes to 'pool', delivering their results to 'sink' until stop().
+    void start(AnalysisWorkerPool& pool, AnalysisSink& sink);
+    // Returns once no worker analyses a lane any more. Never call it from the sink.
+    void stop();
+    bool isStarted() const { return pool_ != nullptr; }
+
+    // Audio callback: hands 'frameCount' interleaved frames to the lanes. Lock-free and allocation
+    // free; frames that do not fit in a lane's ring are dropped and counted.
+    void onInput(const float* frames, int frameCount);
+    // The whole audio callback once the stream is known to be running: appends the callback to the
+    // capture file if one is set, hands the frames to onInput() and times the callback against the
+    // audio it carries. xRunCount < 0 (unknown) leaves the xrun metric as it is.
+    void processCallback(const float* frames, int frameCount, int32_t xRunCount);
+    // Capture file for processCallback(), or null. Records the configured lanes and their current
+    // settings in it. Only while no callback can run, e.g. before the stream starts and after it is
+    // closed.
+    void setCapture(CaptureWriter* capture);
+
+    // --- Lane Settings (any thread) ---
+    // Forwarded to the lanes (any lane below MAX_ENGINE_LANES, configured or not); while a capture
+    // is set, the changed lane's settings are also recorded in it, so replays follow them. Prefer
+    // these to the lane's own setters.
+    void setA4(float frequency); // Every lane
+    void setCandidateRanges(int lane, const FrequencyRange* ranges, int count);
+    void setStrumStrings(int lane, const float* frequencies, int count);
+    void setStrobeTarget(int lane, float frequency);
+    void setDutyCycle(int lane, const DutyCyclePolicy& policy);
+    void setLaneSettings(int lane, const LaneSettings& settings);
+
+    // Any lane below MAX_ENGINE_LANES, configured or not: settings wait for the lane to run.
+    AnalysisLane& lane(int index) { return lanes_[index]; }
+    const AnalysisLane& lane(int index) const { return lanes_[index]; }
+
+    EngineMetrics& metrics() { return metrics_; }
+    const EngineMetrics& metrics() const { return metrics_; }
+
+private:
+    void recordSettings(int lane);
+
+    EngineConfig config_;
+    AnalysisLane lanes_[MAX_ENGINE_LANES];
+    AnalysisWorkerPool* pool_ = nullptr;
+    CaptureWriter* capture_ = nullptr;
+    std::mutex captureMutex_; // Orders setCapture() and the settings records, never on the audio thread
+    double nanosPerFrame_ = 0.0;
+    EngineMetrics metrics_;
+};
+
+#endif // AFINADOR_TUNER_ENGINE_H
@@ -0,0 +1,394 @@
+#include "YinDetector.h"
+#include "DspLog.h"
+#include "NoteMapping.h"
+#include "SimdKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// --- YIN Algorithm Implementation ---
+// The direct difference function and the normalisation run through the SIMD kernels (SimdKernels.h).
+
+// --- FFT Difference Function ---
+// Allocates the FFT plan and workspace for windows of up to 'capacity' samples.
+static void prepareFftDifference(FftDifferenceState& state, int capacity) {
+    int fftSize = RealFft::nextPowerOfTwo(2 * capacity);
+    state.fft = std::make_unique<RealFft>(fftSize);
+    state.padded.assign(fftSize, 0.0f);
+    state.spectrum.assign(fftSize / 2 + 1, std::complex<float>(0.0f, 0.0f));
+    state.energyPrefix.assign(capacity + 1, 0.0);
+}
+
+// Requires a prior prepareFftDifference() with capacity >= size; performs no allocations.
+static void differenceFft(FftDifferenceState& state, const float* buffer, int size, int tauMin, int tauMax,
+                          std::vector<float>& yinBuffer) {
+    const int fftSize = state.fft->size();
+
+    std::copy(buffer, buffer + size, state.padded.begin());
+    std::fill(state.padded.begin() + size, state.padded.begin() + fftSize, 0.0f);
+    state.fft->forward(state.padded.data(), state.spectrum.data());
+    for (int k = 0; k <= fftSize / 2; ++k) {
+        state.spectrum[k] = std::norm(state.spectrum[k]); // Power spectrum
+    }
+    state.fft->inverse(state.spectrum.data(), state.padded.data()); // padded[tau] = r(tau)
+
+    // Energy sums in double precision: d(tau) is a small difference of large terms near the period
+    state.energyPrefix[0] = 0.0;
+    for (int j = 0; j < size; ++j) {
+        state.energyPrefix[j + 1] = state.energyPrefix[j] + static_cast<double>(buffer[j]) * buffer[j];
+    }
+    const double totalEnergy = state.energyPrefix[size];
+    for (int tau = tauMin; tau < tauMax; ++tau) {
+        double head = state.energyPrefix[size - tau];        // sum_{j<N-tau} x[j]^2
+        double tail = totalEnergy - state.energyPrefix[tau]; // sum_{j>=tau} x[j]^2
+        double d = head + tail - 2.0 * state.padded[tau];
+        yinBuffer[tau] = d > 0.0 ? static_cast<float>(d) : 0.0f;
+    }
+}
+
+static int absoluteThreshold(const std::vector<float>& yinBuffer, int tauMax, float threshold, int tauMin) {
+    // Start search from tauMin; only lags below tauMax are valid for the current window
+    for (int tau = tauMin; tau < tauMax; ++tau) {
+        if (yinBuffer[tau] < threshold) {
+            // Find the local minimum within this dip
+            while (tau + 1 < tauMax && yinBuffer[tau + 1] < yinBuffer[tau]) {
+                tau++;
+            }
+            // Ensure the minimum is actually below the threshold
+            if(yinBuffer[tau] < threshold) return tau;
+            // If the minimum wasn't below threshold, continue searching for the next dip
+        }
+    }
+    return -1; // No pitch detected below the threshold within the valid range
+}
+static float parabolicInterpolation(const std::vector<float>& yinBuffer, int tauMax, int tauEstimate) {
+    if (tauEstimate <= 0 || tauEstimate >= tauMax - 1) {
+        // Cannot interpolate at the edges
+        return static_cast<float>(tauEstimate);
+    }
+    float yMinus = yinBuffer[tauEstimate - 1];
+    float yCenter = yinBuffer[tauEstimate];
+    float yPlus = yinBuffer[tauEstimate + 1];
+    float denominator = yMinus + yPlus - 2.0f * yCenter;
+    if (std::abs(denominator) > std::numeric_limits<float>::epsilon()) {
+        // Corrected numerator (yMinus - yPlus)
+        float peakShift = (yMinus - yPlus) / (2.0f * denominator);
+        return tauEstimate + peakShift;
+    } else {
+        // Denominator is too small, return original estimate
+        return static_cast<float>(tauEstimate);
+    }
+}
+
+// --- Narrowed Search ---
+// Multiples of the found lag that are checked for a dip: one there means the real period is
+// shorter and outside every candidate range.
+static const int kSubharmonicDivisors[] = {2, 3, 5};
+
+// Energy-normalised difference d(tau) / (sum_{j<N-tau} x[j]^2 + sum_{j>=tau} x[j]^2), in [0, 2].
+// Unlike the cumulative mean it needs no lags outside [begin, end).
+static void normalizeByEnergy(const std::vector<double>& energyPrefix, int size, int begin, int end, float* curve) {
+    const double totalEnergy = energyPrefix[size];
+    for (int tau = begin; tau < end; ++tau) {
+        double energy = energyPrefix[size - tau] + (totalEnergy - energyPrefix[tau]);
+        curve[tau] = energy > std::numeric_limits<float>::epsilon() ? static_cast<float>(curve[tau] / energy) : 1.0f;
+    }
+}
+
+// First local minimum below the threshold strictly inside [begin, end), or -1. Dips whose minimum
+// lies on the range edge belong to a pitch outside the range and are skipped.
+static int firstDipInside(const float* curve, int begin, int end, float threshold) {
+    for (int tau = begin + 1; tau < end - 1; ++tau) {
+        if (curve[tau] >= threshold) continue;
+        const int dipStart = tau;
+        while (tau + 1 < end && curve[tau + 1] < curve[tau]) {
+            tau++;
+        }
+        if (tau < end - 1 && (tau > dipStart || curve[tau - 1] > curve[tau])) return tau;
+        while (tau + 1 < end - 1 && curve[tau + 1] < threshold) { // Skip the rest of this dip
+            tau++;
+        }
+    }
+    return -1;
+}
+
+static float minimumNormalizedDifference(DetectorContext& ctx, const float* x, int size, int begin, int end) {
+    float* curve = ctx.yinBuffer.data();
+    dspKernels().difference(x, size, begin, end, curve);
+    normalizeByEnergy(ctx.energyPrefix, size, begin, end, curve);
+    return *std::min_element(curve + begin, curve + end);
+}
+
+static void fillEnergyPrefix(DetectorContext& ctx, const float* x, int size) {
+    ctx.energyPrefix[0] = 0.0;
+    for (int j = 0; j < size; ++j) {
+        ctx.energyPrefix[j + 1] = ctx.energyPrefix[j] + static_cast<double>(x[j]) * x[j];
+    }
+}
+
+// Interpolates the dip found at tauEstimate in ctx.yinBuffer and rejects it when a shorter period
+// (a divisor of the lag) also dips: then the lag is a subharmonic of the real pitch.
+static PitchEstimate finishNarrowedDip(DetectorContext& ctx, const float* x, int windowSize, int tauMin,
+                                       int windowTauMax, int tauEstimate) {
+    PitchEstimate estimate;
+    float refinedTau = parabolicInterpolation(ctx.yinBuffer, windowTauMax, tauEstimate);
+    estimate.confidence = std::min(1.0f, std::max(0.0f, 1.0f - ctx.yinBuffer[tauEstimate]));
+
+    // Overwrites the curve, so it runs after the interpolation above
+    for (int divisor : kSubharmonicDivisors) {
+        int lag = static_cast<int>(std::lround(refinedTau / divisor));
+        if (lag - 1 < tauMin) break;
+        if (minimumNormalizedDifference(ctx, x, windowSize, lag - 1, lag + 2) < YIN_DEFAULT_THRESHOLD) {
+            return {}; // The real period is lag, not a candidate
+        }
+    }
+
+    if (refinedTau > 0.0f) {
+        estimate.frequency = static_cast<float>(ctx.sampleRate) / refinedTau;
+        estimate.narrowed = true;
+    }
+    return estimate;
+}
+
+// Evaluates only the candidate lags. Returns an estimate only for a clear dip inside a candidate
+// range; zero frequency asks the caller for the full scan.
+static PitchEstimate searchCandidateLags(DetectorContext& ctx, const float* buffer, int size, int tauMin, int tauMax) {
+    // Only the most recent few periods of the longest candidate are needed
+    int longestLag = 0;
+    for (int i = 0; i < ctx.candidateCount; ++i) {
+        longestLag = std::max(longestLag, std::min(ctx.candidateLags[i].end + 1, tauMax));
+    }
+    const int windowSize = std::min(size, std::max(NARROW_SEARCH_PERIODS * longestLag, NARROW_SEARCH_MIN_WINDOW));
+    const float* x = buffer + (size - windowSize);
+    const int windowTauMax = std::min(tauMax, windowSize / 2 - 1);
+
+    fillEnergyPrefix(ctx, x, windowSize);
+
+    // Ranges are sorted by lag, so the first dip found has the highest pitch (YIN's first-dip rule)
+    float* curve = ctx.yinBuffer.data();
+    int tauEstimate = -1;
+    for (int i = 0; i < ctx.candidateCount && tauEstimate < 0; ++i) {
+        // One extra lag on each side so a dip at the range edge can still be interpolated
+        const int begin = std::max(tauMin, ctx.candidateLags[i].begin - 1);
+        const int end = std::min(windowTauMax, ctx.candidateLags[i].end + 1);
+        if (end - begin < 3) continue;
+        dspKernels().difference(x, windowSize, begin, end, curve);
+        normalizeByEnergy(ctx.energyPrefix, windowSize, begin, end, curve);
+        tauEstimate = firstDipInside(curve, begin, end, YIN_DEFAULT_THRESHOLD);
+    }
+    if (tauEstimate < 0) return {};
+    return finishNarrowedDip(ctx, x, windowSize, tauMin, windowTauMax, tauEstimate);
+}
+
+void setCandidateRanges(DetectorContext& ctx, const FrequencyRange* ranges, int count) {
+    ctx.candidateCount = 0;
+    if (ctx.sampleRate <= 0) return;
+    for (int i = 0; i < count && ctx.candidateCount < MAX_CANDIDATE_RANGES; ++i) {
+        if (ranges[i].minFrequency <= 0.0f || ranges[i].maxFrequency <= ranges[i].minFrequency) continue;
+        LagRange lags;
+        lags.begin = std::max(1, static_cast<int>(std::floor(ctx.sampleRate / ranges[i].maxFrequency)));
+        lags.end = static_cast<int>(std::ceil(ctx.sampleRate / ranges[i].minFrequency)) + 1;
+        // Insertion by first lag, merging with any overlapping neighbour
+        int position = ctx.candidateCount;
+        while (position > 0 && ctx.candidateLags[position - 1].begin > lags.begin) {
+            ctx.candidateLags[position] = ctx.candidateLags[position - 1];
+            position--;
+        }
+        ctx.candidateLags[position] = lags;
+        ctx.candidateCount++;
+    }
+    int merged = 0;
+    for (int i = 0; i < ctx.candidateCount; ++i) {
+        if (merged > 0 && ctx.candidateLags[i].begin <= ctx.candidateLags[merged - 1].end) {
+            ctx.candidateLags[merged - 1].end = std::max(ctx.candidateLags[merged - 1].end, ctx.candidateLags[i].end);
+        } else {
+            ctx.candidateLags[merged++] = ctx.candidateLags[i];
+        }
+    }
+    ctx.candidateCount = merged;
+}
+
+// --- Full Scan ---
+// Steps 3-6 of YIN over the difference function of every lag in [tauMin, tauMax), in ctx.yinBuffer.
+static PitchEstimate scanDifference(DetectorContext& ctx, int sampleRate, int tauMin, int practicalTauMax) {
+    std::vector<float>& yinBuffer = ctx.yinBuffer; // Preallocated, holds at least practicalTauMax lags
+    const DspKernels& kernels = dspKernels();
+
+    // Step 3: Cumulative mean normalized difference (Apply only from tauMin)
+    yinBuffer[0] = 1.0f; // Should not be used, but initialize
+    // Start normalization sum from the first calculated difference value (at tauMin)
+    kernels.cumulativeMeanNormalize(yinBuffer.data(), tauMin, practicalTauMax);
+    // Values before tauMin are invalid, set to 1 (no dip)
+    for(int tau = 1; tau < tauMin; ++tau) {
+        yinBuffer[tau] = 1.0f;
+    }
+
+    // Step 4: Absolute thresholding (Search starts from tauMin)
+    int tauEstimate = absoluteThreshold(yinBuffer, practicalTauMax, YIN_DEFAULT_THRESHOLD, tauMin);
+
+    // Step 5 & 6: Parabolic interpolation (if threshold found)
+    float refinedTau = (tauEstimate != -1) ?
+                       parabolicInterpolation(yinBuffer, practicalTauMax, tauEstimate) : -1.0f;
+
+    PitchEstimate estimate;
+    if (refinedTau > 0.0f) {
+        float frequency = static_cast<float>(sampleRate) / refinedTau;
+        // Extra check: ensure the detected frequency is within our valid range
+        if (frequency >= MIN_VALID_FREQUENCY) {
+            estimate.frequency = frequency;
+            estimate.confidence = std::min(1.0f, std::max(0.0f, 1.0f - yinBuffer[tauEstimate]));
+        }
+    }
+    return estimate; // Zero frequency: no reliable pitch detected
+}
+
+// Steps 2-6 of YIN over every lag in [tauMin, tauMax).
+static PitchEstimate scanAllLags(DetectorContext& ctx, const float* audioBuffer, int bufferSize, int sampleRate,
+                                 int tauMin, int practicalTauMax) {
+    // Step 2: Autocorrelation using difference function (the sliding method's whole windows use the direct loop)
+    if (ctx.method == DifferenceMethod::Fft) {
+        differenceFft(ctx.fftState, audioBuffer, bufferSize, tauMin, practicalTauMax, ctx.yinBuffer);
+    } else {
+        // Start from tauMin
+        dspKernels().difference(audioBuffer, bufferSize, tauMin, practicalTauMax, ctx.yinBuffer.data());
+    }
+    return scanDifference(ctx, sampleRate, tauMin, practicalTauMax);
+}
+
+// --- Detector ---
+void configureDetector(DetectorContext& ctx, int sampleRate, int capacity, DifferenceMethod method) {
+    ctx.sampleRate = sampleRate;
+    ctx.capacity = capacity;
+    ctx.method = method;
+    // YIN curve covers every lag a window of 'capacity' frames can use
+    ctx.yinBuffer.assign(std::max(capacity / 2, 1), 0.0f);
+    ctx.energyPrefix.assign(capacity + 1, 0.0);
+    ctx.candidateCount = 0; // Lag ranges depend on the sample rate
+    ctx.sliding = SlidingDifferenceState();
+    if (method == DifferenceMethod::Sliding) {
+        ctx.sliding.difference.assign(ctx.yinBuffer.size(), 0.0f);
+    }
+    if (method == DifferenceMethod::Fft) {
+        prepareFftDifference(ctx.fftState, capacity);
+    } else {
+        ctx.fftState = FftDifferenceState();
+    }
+}
+
+// Lag range YIN searches in a window of 'bufferSize' samples.
+static bool lagBounds(int sampleRate, int bufferSize, int& tauMin, int& practicalTauMax) {
+    // Calculate tauMax based on the lowest frequency we want to detect
+    int calculatedTauMax = static_cast<int>(std::floor(static_cast<float>(sampleRate) / MIN_VALID_FREQUENCY));
+    // Ensure tauMax does not exceed buffer bounds
+    practicalTauMax = std::min(calculatedTauMax, bufferSize / 2 - 1);
+
+    // Minimum tau (period) corresponds to the highest frequency we might expect
+    tauMin = static_cast<int>(std::floor(static_cast<float>(sampleRate) / MAX_EXPECTED_FREQUENCY));
+    tauMin = std::max(2, tauMin); // Ensure tau is at least 2
+
+    if (practicalTauMax <= tauMin) {
+        DSP_LOGW("computeYIN: practicalTauMax (%d) <= tauMin (%d). Buffer might be too small for min freq. BufferSize: %d, SampleRate: %d",
+                 practicalTauMax, tauMin, bufferSize, sampleRate);
+        return false;
+    }
+    return true;
+}
+
+PitchEstimate computeYIN(DetectorContext& ctx, const float* audioBuffer, int bufferSize) {
+    const int sampleRate = ctx.sampleRate;
+    if (bufferSize <= 0 || sampleRate <= 0 || MIN_VALID_FREQUENCY <= 0) return {};
+    if (bufferSize > ctx.capacity) {
+        // Larger than negotiated: analyse the most recent frames the context can hold
+        audioBuffer += bufferSize - ctx.capacity;
+        bufferSize = ctx.capacity;
+    }
+
+    int tauMin = 0;
+    int practicalTauMax = 0;
+    if (!lagBounds(sampleRate, bufferSize, tauMin, practicalTauMax)) {
+        return {}; // Cannot perform YIN with this range
+    }
+
+    if (ctx.candidateCount > 0) {
+        PitchEstimate narrowed = searchCandidateLags(ctx, audioBuffer, bufferSize, tauMin, practicalTauMax);
+        if (narrowed.frequency > 0.0f) return narrowed;
+        // No clear dip among the candidates: the full scan below decides
+    }
+
+    return scanAllLags(ctx, audioBuffer, bufferSize, sampleRate, tauMin, practicalTauMax);
+}
+
+PitchEstimate computeYINAround(DetectorContext& ctx, const float* audioBuffer, int bufferSize, float frequency,
+                               float spreadCents) {
+    const int sampleRate = ctx.sampleRate;
+    if (bufferSize <= 0 || sampleRate <= 0 || frequency <= 0.0f || spreadCents <= 0.0f) return {};
+    if (bufferSize > ctx.capacity) {
+        audioBuffer += bufferSize - ctx.capacity;
+        bufferSize = ctx.capacity;
+    }
+    int tauMin = 0;
+    int practicalTauMax = 0;
+    if (!lagBounds(sampleRate, bufferSize, tauMin, practicalTauMax)) {
+        return {};
+    }
+    // One extra lag on each side so a dip at the edge can still be interpolated
+    const float spread = std::exp2(spreadCents / 1200.0f);
+    const int begin = std::max(tauMin, static_cast<int>(std::floor(sampleRate / (frequency * spread))) - 1);
+    const int end = std::min(practicalTauMax, static_cast<int>(std::ceil(sampleRate * spread / frequency)) + 2);
+    if (end - begin < 3) return {};
+
+    // Few lags, so the whole window is affordable and keeps the full scan's precision. The range
+    // holds one note only: its deepest point is the dip, unless that lies on the edge.
+    float* curve = ctx.yinBuffer.data();
+    fillEnergyPrefix(ctx, audioBuffer, bufferSize);
+    dspKernels().difference(audioBuffer, bufferSize, begin, end, curve);
+    normalizeByEnergy(ctx.energyPrefix, bufferSize, begin, end, curve);
+    const int tauEstimate = static_cast<int>(std::min_element(curve + begin, curve + end) - curve);
+    if (tauEstimate == begin || tauEstimate == end - 1 || curve[tauEstimate] >= YIN_DEFAULT_THRESHOLD) return {};
+    return finishNarrowedDip(ctx, audioBuffer, bufferSize, tauMin, practicalTauMax, tauEstimate);
+}
+
+// --- Sliding Detector ---
+void resetSlidingDifference(DetectorContext& ctx) {
+    ctx.sliding.windowSize = 0;
+}
+
+PitchEstimate computeYINSliding(DetectorContext& ctx, const float* history, int windowSize, int hopSize) {
+    SlidingDifferenceState& sliding = ctx.sliding;
+    const float* window = history + hopSize;
+    if (ctx.method != DifferenceMethod::Sliding || windowSize > ctx.capacity || hopSize <= 0) {
+        sliding.windowSize = 0;
+        return computeYIN(ctx, window, windowSize);
+    }
+    int tauMin = 0;
+    int practicalTauMax = 0;
+    if (!lagBounds(ctx.sampleRate, windowSize, tauMin, practicalTauMax)) {
+        sliding.windowSize = 0;
+        return {};
+    }
+
+    // Keep d(tau) of every window current, even when the narrowed search below decides this one
+    const DspKernels& kernels = dspKernels();
+    float* difference = sliding.difference.data();
+    const bool updatable = sliding.windowSize == windowSize && sliding.hopsSinceRefresh < SLIDING_REFRESH_HOPS &&
+                           2 * hopSize < windowSize; // Past half a window the full loop is cheaper
+    if (updatable) {
+        kernels.slideDifference(history, windowSize, hopSize, tauMin, practicalTauMax, difference);
+        sliding.hopsSinceRefresh++;
+    } else {
+        kernels.difference(window, windowSize, tauMin, practicalTauMax, difference);
+        sliding.windowSize = windowSize;
+        sliding.hopsSinceRefresh = 0;
+    }
+
+    if (ctx.candidateCount > 0) {
+        PitchEstimate narrowed = searchCandidateLags(ctx, window, windowSize, tauMin, practicalTauMax);
+        if (narrowed.frequency > 0.0f) return narrowed;
+    }
+
+    // Rounding can leave a zero difference slightly negative
+    for (int tau = tauMin; tau < practicalTauMax; ++tau) {
+        ctx.yinBuffer[tau] = std::max(0.0f, difference[tau]);
+    }
+    return scanDifference(ctx, ctx.sampleRate, tauMin, practicalTauMax);
+}
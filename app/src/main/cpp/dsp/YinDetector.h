@@ -0,0 +1,111 @@
+#ifndef AFINADOR_YIN_DETECTOR_H
+#define AFINADOR_YIN_DETECTOR_H
+
+#include "Fft.h"
+#include <complex>
+#include <memory>
+#include <vector>
+
+// --- YIN Constants ---
+constexpr float MAX_EXPECTED_FREQUENCY = 2000.0f; // Hertz, upper bound for tauMin optimization
+constexpr float YIN_DEFAULT_THRESHOLD = 0.15f;
+
+// Difference function backends, selected at engine start (values mirror TunerViewModel)
+enum class DifferenceMethod : int {
+    Direct = 0, // O(N*tau) lag loop, reference implementation
+    Fft = 1,    // O(N log N) autocorrelation via FFT plus cumulative energy sums
+    Sliding = 2 // O(hop*tau) per hop: updates the previous window's d(tau) (see computeYINSliding)
+};
+
+// --- FFT Difference Function ---
+// d(tau) = sum_{j<N-tau} x[j]^2 + sum_{j>=tau} x[j]^2 - 2*r(tau), where r(tau) is the
+// autocorrelation obtained from the inverse FFT of |X|^2 (zero-padded to >= 2N, so it is linear).
+struct FftDifferenceState {
+    std::unique_ptr<RealFft> fft;
+    std::vector<float> padded;                    // Zero-padded input, then autocorrelation
+    std::vector<std::complex<float>> spectrum;
+    std::vector<double> energyPrefix;             // energyPrefix[k] = sum_{j<k} x[j]^2
+};
+
+// --- Sliding Difference ---
+// Streaming windows overlap by all but one hop, so the sliding method keeps d(tau) of the previous
+// window and only adds the lag products of the entering samples and removes those of the leaving
+// ones. The float updates accumulate rounding error, so d(tau) is recomputed in full every
+// SLIDING_REFRESH_HOPS updates.
+constexpr int SLIDING_REFRESH_HOPS = 64;
+
+struct SlidingDifferenceState {
+    std::vector<float> difference; // d(tau) of the previous window
+    int windowSize = 0;            // 0: no previous window, the next call recomputes in full
+    int hopsSinceRefresh = 0;
+};
+
+// --- Narrowed Search ---
+// When the expected pitches are known (the strings of a tuning, a chosen target) only the lags of
+// those candidate ranges are evaluated, over the most recent few periods of the window. A window
+// without a clear dip inside the candidates falls back to the full YIN scan.
+constexpr int MAX_CANDIDATE_RANGES = 16;
+constexpr int NARROW_SEARCH_PERIODS = 4;     // Window length, in periods of the longest candidate lag
+constexpr int NARROW_SEARCH_MIN_WINDOW = 512;
+
+struct FrequencyRange {
+    float minFrequency; // Hertz
+    float maxFrequency;
+};
+
+struct LagRange {
+    int begin; // First lag (inclusive)
+    int end;   // Last lag (exclusive)
+};
+
+// --- Detector Context ---
+// Owns every scratch buffer used by the detector. It is sized once up front (in the engine, from
+// the negotiated stream parameters), so computeYIN never allocates or locks.
+struct DetectorContext {
+    int sampleRate = 0;
+    int capacity = 0;     // Largest window (in frames) the buffers can hold
+    DifferenceMethod method = DifferenceMethod::Direct;
+    std::vector<float> yinBuffer;
+    FftDifferenceState fftState;
+    SlidingDifferenceState sliding;
+    std::vector<double> energyPrefix;           // Narrowed search: energyPrefix[k] = sum_{j<k} x[j]^2
+    LagRange candidateLags[MAX_CANDIDATE_RANGES]; // Sorted by lag, non-overlapping
+    int candidateCount = 0;                       // 0: every window gets the full scan
+};
+
+// Detector output. A frequency of 0 means no reliable pitch; confidence is 1 - d'(tau) at the dip.
+struct PitchEstimate {
+    float frequency = 0.0f;
+    float confidence = 0.0f;
+    bool narrowed = false; // Found by the narrowed search rather than the full scan
+};
+
+// Allocates all buffers for windows of up to 'capacity' samples.
+void configureDetector(DetectorContext& ctx, int sampleRate, int capacity, DifferenceMethod method);
+
+// Restricts the search to 'count' frequency ranges (count 0 clears them). Overlapping ranges are
+// merged; ranges beyond MAX_CANDIDATE_RANGES are ignored. Call between computeYIN calls only.
+void setCandidateRanges(DetectorContext& ctx, const FrequencyRange* ranges, int count);
+
+// Runs YIN on 'bufferSize' samples. Performs no allocations; windows longer than the
+// configured capacity are analysed over their most recent samples. With candidate ranges set,
+// the narrowed search runs first and the full scan only when it finds no clear dip.
+PitchEstimate computeYIN(DetectorContext& ctx, const float* audioBuffer, int bufferSize);
+
+// Narrowed search over the lags within 'spreadCents' of 'frequency' only (the tracking step of a
+// held note): same dip and subharmonic rules as the candidate ranges. Zero frequency means no clear
+// dip there and the caller runs the full detector. Performs no allocations.
+PitchEstimate computeYINAround(DetectorContext& ctx, const float* audioBuffer, int bufferSize, float frequency,
+                               float spreadCents);
+
+// Streaming YIN for contiguous windows (DifferenceMethod::Sliding). 'history' holds hopSize samples
+// followed by the windowSize-sample window to analyse; its first windowSize samples must be the
+// window of the previous call, whose d(tau) is then updated in O(hopSize * tau). Without a usable
+// previous window (first call, reset, different size) or when a refresh is due, d(tau) is
+// recomputed in full. Same results as computeYIN up to float rounding; performs no allocations.
+PitchEstimate computeYINSliding(DetectorContext& ctx, const float* history, int windowSize, int hopSize);
+
+// Forgets the previous window, so the next computeYINSliding() recomputes d(tau) in full.
+void resetSlidingDifference(DetectorContext& ctx);
+
+#endif // AFINADOR_YIN_DETECTOR_H
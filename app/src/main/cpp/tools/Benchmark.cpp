@@ -0,0 +1,1291 @@
+// Speed and accuracy benchmark for the DSP core. Runs PitchAnalyzer over synthetic plucked-string
+// signals (and optional recorded references) and reports throughput, per-window latency
+// percentiles and pitch error in cents, plus StrumAnalyzer over synthetic strums of the bundled
+// tunings, StrobeAnalyzer at known targets, the gating cascade against the fixed RMS gate on
+// a session with room, pick and fret noise. Before that it checks the SIMD kernels against the
+// scalar reference, the result mailbox's seqlock under a concurrent writer, two engine instances
+// fed synthetic multichannel input on a shared worker pool, an input capture written, read back
+// and replayed, the analysis duty cycle against the full rate, and the batch tracker, made to
+// steal segments, against a serial run over a recorded-length take, and exits non-zero if any fails.
+//
+//   afinador_bench [--method direct|fft|sliding|all] [--window N] [--hop N] [--rate HZ] [--seconds S]
+//                  [--narrow SEMITONES] [--decimate M] [--low-window N] [--no-cascade]
+//                  [recording.wav:EXPECTED_HZ ...]
+//
+// --narrow gives the detector each signal's expected pitch +/- SEMITONES as its only candidate
+// range, like a selected target in the app. --decimate enables the low-register path (input
+// decimated by M, analysed over --low-window decimated samples). --no-cascade runs the signals
+// with the fixed RMS gate and the full detector on every window.
+
+#include "AnalysisLane.h"
+#include "AnalysisWorkerPool.h"
+#include "CaptureFile.h"
+#include "CaptureReplay.h"
+#include "PitchAnalyzer.h"
+#include "PitchTrack.h"
+#include "ResultMailbox.h"
+#include "SimdKernels.h"
+#include "StrobeAnalyzer.h"
+#include "StrumAnalyzer.h"
+#include "TunerEngine.h"
+#include "WavFile.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr float GROSS_ERROR_CENTS = 50.0f;  // Beyond this the window counts as a wrong note
+constexpr float SYNTHETIC_DETUNE_CENTS = 7.0f;
+constexpr double KERNEL_TOLERANCE = 1e-4;   // Relative; SIMD kernels sum in a different order
+constexpr int STRUM_TRIALS = 24;            // Random detunings per tuning
+constexpr float STRUM_MAX_DETUNE_CENTS = 30.0f;
+constexpr float STRUM_STAGGER_SECONDS = 0.012f; // Between strings of a downstroke
+constexpr float STRUM_INHARMONICITY = 1e-4f;    // Partial h at h * f * sqrt(1 + B h^2), as on wound strings
+constexpr float STROBE_SECONDS = 1.5f;
+constexpr float STROBE_SETTLED_SECONDS = 0.6f; // Errors are taken once a full tracking history is in
+constexpr float ROOM_NOISE_RMS = 0.006f;        // Above the fixed gate, as a fan or traffic would be
+constexpr float ROOM_NOISE_SMOOTHING = 0.05f;   // One-pole low-pass: mostly rumble
+constexpr int ANALYSIS_STAGES = 4;              // AnalysisStage values
+constexpr float TAKE_SECONDS = 60.0f;          // Batch tracking input: a minute of practice
+constexpr float TAKE_NOTE_SECONDS = 2.0f;
+constexpr float TAKE_SILENCE_RMS = 1e-4f;      // Below either gate, so the quiet part costs next to nothing
+constexpr int BATCH_THREADS = 4;               // Forced, so segments are stolen on any host
+constexpr double BATCH_HELD_NOTE_CENTS = 25.0; // Batch versus serial, on a note held over a segment start
+constexpr float ENGINE_SECONDS = 2.0f;
+constexpr double ENGINE_FEED_SPEEDUP = 4.0;     // Input delivered 4x faster than real time
+constexpr int ENGINE_BLOCK_FRAMES = 192;        // A typical device burst
+constexpr float ENGINE_MIN_DETECTED = 0.9f;     // Share of each lane's windows that must find its note
+constexpr float CAPTURE_INPUT_SECONDS = 6.0f;
+constexpr float CAPTURE_RING_SECONDS = 4.0f;    // Shorter than the input, so both rings wrap
+constexpr int CAPTURE_CALLBACK_FRAMES[] = {192, 96, 240, 37, 480}; // Burst sizes seen across devices
+// A4 changes made while capturing: the first before the held part of the input, the second inside it
+constexpr float CAPTURE_A4_CHANGE_SECONDS[] = {1.0f, 4.0f};
+constexpr float CAPTURE_A4_CHANGES[] = {436.0f, 445.0f};
+constexpr int MAILBOX_PUBLISHES = 200000;
+constexpr int MAILBOX_PUBLISH_GAP_NANOS = 1000; // Far tighter than a hop, so copies often overlap
+constexpr float DUTY_SESSION_SECONDS = 8.0f;
+constexpr float DUTY_SILENCE_RMS = 1e-4f;      // Well below the noise gate
+constexpr double DUTY_AGREEMENT_CENTS = 1.0;   // Reported share; the default held-note tolerance
+
+struct ReferenceSignal {
+    std::string name;
+    int sampleRate = 0;
+    float frequency = 0.0f; // Expected fundamental
+    std::vector<float> samples;
+};
+
+struct BenchStats {
+    int windows = 0;
+    int voiced = 0;    // Windows above the noise gate
+    int detected = 0;
+    int gross = 0;
+    int narrowed = 0;  // Detected without a full scan
+    int stages[ANALYSIS_STAGES] = {}; // Windows per AnalysisStage
+    double audioSeconds = 0.0;
+    double cpuSeconds = 0.0;
+    std::vector<double> latenciesMicros;
+    std::vector<double> absCentsErrors; // Detected windows without gross errors
+
+    void merge(const BenchStats& other) {
+        windows += other.windows;
+        voiced += other.voiced;
+        detected += other.detected;
+        gross += other.gross;
+        narrowed += other.narrowed;
+        for (int i = 0; i < ANALYSIS_STAGES; ++i) stages[i] += other.stages[i];
+        audioSeconds += other.audioSeconds;
+        cpuSeconds += other.cpuSeconds;
+        latenciesMicros.insert(latenciesMicros.end(), other.latenciesMicros.begin(), other.latenciesMicros.end());
+        absCentsErrors.insert(absCentsErrors.end(), other.absCentsErrors.begin(), other.absCentsErrors.end());
+    }
+};
+
+// Plucked-string-like tone: decaying harmonics with 1/h amplitudes plus white noise at about -40 dB.
+std::vector<float> synthesizeString(float frequency, int sampleRate, float seconds, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> noise(0.0f, 0.005f);
+    std::uniform_real_distribution<float> phase(0.0f, static_cast<float>(2.0 * kPi));
+    const int harmonics = 8;
+    float phases[harmonics];
+    for (float& p : phases) p = phase(rng);
+
+    std::vector<float> samples(static_cast<size_t>(seconds * sampleRate));
+    for (size_t i = 0; i < samples.size(); ++i) {
+        double t = static_cast<double>(i) / sampleRate;
+        double value = 0.0;
+        for (int h = 1; h <= harmonics; ++h) {
+            if (frequency * h >= sampleRate / 2.0f) break;
+            double decay = std::exp(-t * (0.8 + 0.3 * h));
+            value += decay / h * std::sin(2.0 * kPi * frequency * h * t + phases[h - 1]);
+        }
+        samples[i] = static_cast<float>(0.3 * value) + noise(rng);
+    }
+    return samples;
+}
+
+// Low-passed Gaussian noise scaled to 'rms'.
+std::vector<float> synthesizeNoise(int sampleRate, float seconds, float rms, float smoothing, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+    std::vector<float> samples(static_cast<size_t>(seconds * sampleRate));
+    float state = 0.0f;
+    double sumOfSquares = 0.0;
+    for (float& sample : samples) {
+        state += smoothing * (noise(rng) - state);
+        sample = state;
+        sumOfSquares += static_cast<double>(state) * state;
+    }
+    const float scale = samples.empty() ? 0.0f : rms / static_cast<float>(std::sqrt(sumOfSquares / samples.size()));
+    for (float& sample : samples) sample *= scale;
+    return samples;
+}
+
+const char* methodName(DifferenceMethod method) {
+    switch (method) {
+        case DifferenceMethod::Fft: return "fft";
+        case DifferenceMethod::Sliding: return "sliding";
+        default: return "direct";
+    }
+}
+
+double percentile(std::vector<double> values, double fraction) {
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    size_t index = static_cast<size_t>(fraction * (values.size() - 1) + 0.5);
+    return values[std::min(index, values.size() - 1)];
+}
+
+double mean(const std::vector<double>& values) {
+    if (values.empty()) return 0.0;
+    double sum = 0.0;
+    for (double v : values) sum += v;
+    return sum / values.size();
+}
+
+BenchStats runSignal(PitchAnalyzer& analyzer, const ReferenceSignal& signal) {
+    using Clock = std::chrono::steady_clock;
+    const int hopSize = analyzer.config().hopSize;
+    BenchStats stats;
+    stats.audioSeconds = static_cast<double>(signal.samples.size()) / signal.sampleRate;
+    analyzer.reset();
+
+    PitchResult result;
+    for (size_t offset = 0; offset + hopSize <= signal.samples.size(); offset += hopSize) {
+        auto start = Clock::now();
+        bool analysed = analyzer.processHop(signal.samples.data() + offset, 440.0f, result);
+        double micros = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+        stats.cpuSeconds += micros * 1e-6;
+        if (!analysed) continue;
+
+        ++stats.windows;
+        stats.latenciesMicros.push_back(micros);
+        ++stats.stages[static_cast<int>(result.stage)];
+        if (result.gated) continue;
+        ++stats.voiced;
+        if (result.frequency <= 0.0f) continue;
+        ++stats.detected;
+        if (result.narrowed) ++stats.narrowed;
+        double cents = std::fabs(1200.0 * std::log2(result.frequency / signal.frequency));
+        if (cents > GROSS_ERROR_CENTS) {
+            ++stats.gross;
+        } else {
+            stats.absCentsErrors.push_back(cents);
+        }
+    }
+    return stats;
+}
+
+void printSignalLine(const ReferenceSignal& signal, const BenchStats& stats) {
+    double detectedPct = stats.voiced > 0 ? 100.0 * stats.detected / stats.voiced : 0.0;
+    std::printf("  %-14s %8.2f Hz  voiced %4d  detected %5.1f%%  narrowed %5.1f%%  gross %3d  "
+                "|cents| mean %6.3f max %6.3f\n",
+                signal.name.c_str(), signal.frequency, stats.voiced, detectedPct,
+                stats.detected > 0 ? 100.0 * stats.narrowed / stats.detected : 0.0, stats.gross,
+                mean(stats.absCentsErrors), percentile(stats.absCentsErrors, 1.0));
+}
+
+void printStages(const int* stages) {
+    std::printf("gated %d  aperiodic %d  local %d  full %d",
+                stages[static_cast<int>(AnalysisStage::NoiseGate)], stages[static_cast<int>(AnalysisStage::Periodicity)],
+                stages[static_cast<int>(AnalysisStage::LocalSearch)], stages[static_cast<int>(AnalysisStage::FullSearch)]);
+}
+
+void printSummary(const char* methodName, const BenchStats& total) {
+    std::printf("  -- %s summary --\n", methodName);
+    std::printf("  windows/s %.0f   realtime factor %.1fx   latency us p50 %.1f p90 %.1f p99 %.1f max %.1f\n",
+                total.cpuSeconds > 0 ? total.windows / total.cpuSeconds : 0.0,
+                total.cpuSeconds > 0 ? total.audioSeconds / total.cpuSeconds : 0.0,
+                percentile(total.latenciesMicros, 0.50), percentile(total.latenciesMicros, 0.90),
+                percentile(total.latenciesMicros, 0.99), percentile(total.latenciesMicros, 1.0));
+    std::printf("  detected %.1f%% of voiced windows (%.1f%% narrowed), gross errors %d, |cents| mean %.3f p95 %.3f\n",
+                total.voiced > 0 ? 100.0 * total.detected / total.voiced : 0.0,
+                total.detected > 0 ? 100.0 * total.narrowed / total.detected : 0.0, total.gross,
+                mean(total.absCentsErrors), percentile(total.absCentsErrors, 0.95));
+    std::printf("  stages: ");
+    printStages(total.stages);
+    std::printf("\n\n");
+}
+
+// Note mapping through the compile-time tables versus the same math on libm's log2f/powf.
+void compareNoteMapping() {
+    using Clock = std::chrono::steady_clock;
+    std::vector<float> frequencies(4096);
+    for (size_t i = 0; i < frequencies.size(); ++i) {
+        frequencies[i] = 25.0f * std::pow(2.0f, 6.0f * i / frequencies.size());
+    }
+    const int passes = 100;
+    double checksum[2] = {0.0, 0.0};
+    double worstCents = 0.0;
+
+    auto start = Clock::now();
+    for (int p = 0; p < passes; ++p) {
+        for (float frequency : frequencies) {
+            DetectedNoteInfo note = getNoteInfoFromFrequency(frequency, 440.0f);
+            checksum[0] += centsFromNote(frequency, note, 440.0f);
+        }
+    }
+    auto middle = Clock::now();
+    for (int p = 0; p < passes; ++p) {
+        for (float frequency : frequencies) {
+            int midiNote = static_cast<int>(roundf(12.0f * log2f(frequency / 440.0f))) + MIDI_NOTE_A4;
+            float noteFrequency = 440.0f * powf(2.0f, (midiNote - MIDI_NOTE_A4) / 12.0f);
+            float cents = 1200.0f * log2f(frequency / noteFrequency);
+            checksum[1] += cents;
+            if (p == 0) {
+                DetectedNoteInfo note = getNoteInfoFromFrequency(frequency, 440.0f);
+                worstCents = std::max(worstCents, static_cast<double>(std::fabs(centsFromNote(frequency, note, 440.0f) - cents)));
+            }
+        }
+    }
+    auto end = Clock::now();
+    const double calls = static_cast<double>(passes) * frequencies.size();
+    std::printf("[note mapping] libm %.1f ns  tables %.1f ns per window  (max difference %.4f cents, checksum %.0f/%.0f)\n\n",
+                1e9 * std::chrono::duration<double>(end - middle).count() / calls,
+                1e9 * std::chrono::duration<double>(middle - start).count() / calls, worstCents,
+                checksum[0], checksum[1]);
+}
+
+// --- Kernel Equivalence ---
+double relativeError(double value, double reference) {
+    return std::fabs(value - reference) / std::max(std::fabs(reference), 1e-6);
+}
+
+double maxRelativeError(const std::vector<float>& values, const std::vector<float>& reference, int begin, int end) {
+    double worst = 0.0;
+    for (int i = begin; i < end; ++i) {
+        worst = std::max(worst, relativeError(values[i], reference[i]));
+    }
+    return worst;
+}
+
+// Times one direct difference pass over a full window at the lag range the detector uses.
+double differenceMicros(const DspKernels& kernels, const std::vector<float>& x, int tauEnd, std::vector<float>& out) {
+    using Clock = std::chrono::steady_clock;
+    const int repeats = 20;
+    auto start = Clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        kernels.difference(x.data(), static_cast<int>(x.size()), 2, tauEnd, out.data());
+    }
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count() / repeats;
+}
+
+// Compares dspKernels() with scalarKernels() on random inputs, including sizes that are not a
+// multiple of any vector width. Returns false on mismatch.
+bool verifyKernels(const AnalysisConfig& config) {
+    const DspKernels& reference = scalarKernels();
+    const DspKernels& fast = dspKernels();
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> amplitude(-1.0f, 1.0f);
+
+    double worstSum = 0.0;
+    double worstDifference = 0.0;
+    double worstSlide = 0.0;
+    double worstNormalized = 0.0;
+    for (int n : {1, 3, 7, 8, 13, 64, 257, 1023, 2048, 4097}) {
+        std::vector<float> x(n);
+        for (float& v : x) v = amplitude(rng);
+        worstSum = std::max(worstSum, relativeError(fast.sumOfSquares(x.data(), n),
+                                                    reference.sumOfSquares(x.data(), n)));
+
+        const int tauBegin = 2;
+        const int tauEnd = n / 2;
+        if (tauEnd <= tauBegin) continue;
+        std::vector<float> expected(tauEnd, 0.0f);
+        std::vector<float> actual(tauEnd, 0.0f);
+        reference.difference(x.data(), n, tauBegin, tauEnd, expected.data());
+        fast.difference(x.data(), n, tauBegin, tauEnd, actual.data());
+        worstDifference = std::max(worstDifference, maxRelativeError(actual, expected, tauBegin, tauEnd));
+
+        // Sliding the first n - hop samples' curve forward must give the curve of the last n - hop
+        for (int hop : {1, 5, 8, 17, 64}) {
+            const int window = n - hop;
+            const int slideEnd = window / 2;
+            if (slideEnd <= tauBegin) continue;
+            std::vector<float> direct(slideEnd, 0.0f);
+            reference.difference(x.data() + hop, window, tauBegin, slideEnd, direct.data());
+            for (const DspKernels* kernels : {&reference, &fast}) {
+                std::vector<float> slid(slideEnd, 0.0f);
+                reference.difference(x.data(), window, tauBegin, slideEnd, slid.data());
+                kernels->slideDifference(x.data(), window, hop, tauBegin, slideEnd, slid.data());
+                worstSlide = std::max(worstSlide, maxRelativeError(slid, direct, tauBegin, slideEnd));
+            }
+        }
+
+        actual = expected; // Same input for both normalisations
+        reference.cumulativeMeanNormalize(expected.data(), tauBegin, tauEnd);
+        fast.cumulativeMeanNormalize(actual.data(), tauBegin, tauEnd);
+        worstNormalized = std::max(worstNormalized, maxRelativeError(actual, expected, tauBegin, tauEnd));
+    }
+
+    std::vector<float> window(config.windowSize);
+    for (float& v : window) v = amplitude(rng);
+    const int tauEnd = std::min(config.sampleRate / static_cast<int>(MIN_VALID_FREQUENCY), config.windowSize / 2 - 1);
+    std::vector<float> out(std::max(config.windowSize / 2, 1));
+    double scalarMicros = tauEnd > 2 ? differenceMicros(reference, window, tauEnd, out) : 0.0;
+    double fastMicros = tauEnd > 2 ? differenceMicros(fast, window, tauEnd, out) : 0.0;
+
+    bool ok = worstSum <= KERNEL_TOLERANCE && worstDifference <= KERNEL_TOLERANCE &&
+              worstSlide <= KERNEL_TOLERANCE && worstNormalized <= KERNEL_TOLERANCE;
+    std::printf("[kernels: %s vs %s] %s\n", fast.name, reference.name, ok ? "match" : "MISMATCH");
+    std::printf("  max relative error: sumOfSquares %.2e  difference %.2e  slide %.2e  normalize %.2e\n",
+                worstSum, worstDifference, worstSlide, worstNormalized);
+    std::printf("  direct difference, window %d: %s %.1f us  %s %.1f us  speedup %.1fx\n\n", config.windowSize,
+                reference.name, scalarMicros, fast.name, fastMicros,
+                fastMicros > 0 ? scalarMicros / fastMicros : 0.0);
+    return ok;
+}
+
+// --- Strum Mode ---
+// Downstroke over the given strings: each a decaying stiff string (partials stretched by
+// STRUM_INHARMONICITY) with its own level, starting STRUM_STAGGER_SECONDS after the previous one.
+std::vector<float> synthesizeStrum(const std::vector<float>& frequencies, int sampleRate, int length, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> noise(0.0f, 0.005f);
+    std::uniform_real_distribution<float> phase(0.0f, static_cast<float>(2.0 * kPi));
+    std::uniform_real_distribution<float> level(0.5f, 1.0f);
+    const int harmonics = 10;
+    std::vector<float> samples(length, 0.0f);
+    for (size_t s = 0; s < frequencies.size(); ++s) {
+        const int onset = static_cast<int>(s * STRUM_STAGGER_SECONDS * sampleRate);
+        const float amplitude = 0.15f * level(rng);
+        for (int h = 1; h <= harmonics; ++h) {
+            const double partial = frequencies[s] * h * std::sqrt(1.0 + STRUM_INHARMONICITY * h * h);
+            if (partial >= sampleRate / 2.0) break;
+            const double startPhase = phase(rng);
+            for (int i = onset; i < length; ++i) {
+                double t = static_cast<double>(i - onset) / sampleRate;
+                samples[i] += static_cast<float>(amplitude * std::exp(-t * (0.8 + 0.3 * h)) / h *
+                                                 std::sin(2.0 * kPi * partial * t + startPhase));
+            }
+        }
+    }
+    for (float& sample : samples) sample += noise(rng);
+    return samples;
+}
+
+// Tunes each bundled instrument from STRUM_TRIALS synthetic strums with every string randomly off
+// by up to STRUM_MAX_DETUNE_CENTS. Each analysis is timed against the interval between analyses
+// and against one hop of the single-note pipeline, the deadline it has to fit into when it runs.
+void measureStrumMode(int sampleRate, int pitchHopSize) {
+    using Clock = std::chrono::steady_clock;
+    struct Instrument { const char* name; std::vector<float> strings; };
+    const Instrument instruments[] = {
+            {"guitar standard", {82.407f, 110.0f, 146.83f, 196.0f, 246.94f, 329.63f}},
+            {"guitar drop D", {73.416f, 110.0f, 146.83f, 196.0f, 246.94f, 329.63f}},
+            {"guitar DADGAD", {73.416f, 110.0f, 146.83f, 196.0f, 220.0f, 293.66f}},
+            {"bass 5 strings", {30.868f, 41.203f, 55.0f, 73.416f, 97.999f}},
+            {"ukulele", {392.0f, 261.63f, 329.63f, 440.0f}},
+            {"violin", {196.0f, 293.66f, 440.0f, 659.26f}},
+    };
+    StrumConfig config;
+    config.sampleRate = sampleRate;
+    StrumAnalyzer analyzer;
+    if (!analyzer.configure(config)) return;
+
+    std::printf("[strum mode, analysis every %d samples]\n", config.hopSize);
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> detune(-STRUM_MAX_DETUNE_CENTS, STRUM_MAX_DETUNE_CENTS);
+    for (const Instrument& instrument : instruments) {
+        analyzer.setStrings(instrument.strings.data(), static_cast<int>(instrument.strings.size()));
+        const int window = analyzer.windowSize();
+        const int length = window + sampleRate / 10; // Window ends 100 ms after the last string starts
+        int estimates = 0;
+        int detected = 0;
+        int shared = 0;
+        std::vector<double> errors;
+        std::vector<double> micros;
+        StrumResult result;
+        for (int trial = 0; trial < STRUM_TRIALS; ++trial) {
+            std::vector<float> detunes;
+            std::vector<float> played;
+            for (float target : instrument.strings) {
+                detunes.push_back(detune(rng));
+                played.push_back(target * std::exp2(detunes.back() / 1200.0f));
+            }
+            std::vector<float> strum = synthesizeStrum(played, sampleRate, length, 100 + trial);
+            auto start = Clock::now();
+            analyzer.analyseWindow(strum.data() + (length - window), result);
+            micros.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+            for (int s = 0; s < result.stringCount; ++s) {
+                ++estimates;
+                if (result.strings[s].frequency <= 0.0f) continue;
+                ++detected;
+                if (result.strings[s].shared) ++shared;
+                errors.push_back(std::fabs(result.strings[s].centsOffset - detunes[s]));
+            }
+        }
+        const double intervalMicros = 1e6 * config.hopSize / sampleRate;
+        const double pitchHopMicros = 1e6 * pitchHopSize / sampleRate;
+        std::printf("  %-16s window %5d  detected %5.1f%% (%d shared)  |cents| mean %5.2f p95 %5.2f max %6.2f  "
+                    "%6.1f us/analysis (%.2f%% of its interval, max %.1f%% of a %d-sample hop)\n",
+                    instrument.name, window, estimates > 0 ? 100.0 * detected / estimates : 0.0, shared,
+                    mean(errors), percentile(errors, 0.95), percentile(errors, 1.0), mean(micros),
+                    100.0 * mean(micros) / intervalMicros, 100.0 * percentile(micros, 1.0) / pitchHopMicros,
+                    pitchHopSize);
+    }
+    std::printf("\n");
+}
+
+// --- Strobe Mode ---
+// Plays each target slightly detuned (synthesizeString) into the strobe analyzer with that target
+// selected and reports the time to the first locked reading, the cents error once settled, and
+// the cost per hop against the single-note pipeline on the same signal.
+void measureStrobeMode(AnalysisConfig pitchConfig) {
+    using Clock = std::chrono::steady_clock;
+    struct Target { const char* name; float frequency; };
+    const Target targets[] = {
+            {"B0", 30.868f}, {"E2", 82.407f}, {"A2", 110.0f}, {"G3", 196.0f},
+            {"E4", 329.63f}, {"A4", 440.0f},  {"E5", 659.26f},
+    };
+    const std::vector<float> detunes = {-12.0f, -1.0f, -0.3f, -0.1f, 0.0f, 0.1f, 0.25f, 3.0f};
+    StrobeConfig config;
+    config.sampleRate = pitchConfig.sampleRate;
+    config.hopSize = pitchConfig.hopSize;
+    pitchConfig.method = DifferenceMethod::Sliding; // The app's single-note pipeline
+    StrobeAnalyzer strobe;
+    PitchAnalyzer pitch;
+    if (!strobe.configure(config) || !pitch.configure(pitchConfig)) return;
+
+    std::printf("[strobe mode, hop %d, %d bands, %.2f s fit]\n", config.hopSize, config.harmonics,
+                config.trackingSeconds);
+    const int hop = config.hopSize;
+    const int settledHop = static_cast<int>(STROBE_SETTLED_SECONDS * config.sampleRate / hop);
+    double strobeSeconds = 0.0;
+    double pitchSeconds = 0.0;
+    long totalHops = 0;
+    std::vector<double> allErrors;
+    uint32_t seed = 500;
+    for (const Target& target : targets) {
+        std::vector<double> errors;
+        std::vector<double> lockMillis;
+        for (float detune : detunes) {
+            const float played = target.frequency * std::exp2(detune / 1200.0f);
+            std::vector<float> signal = synthesizeString(played, config.sampleRate, STROBE_SECONDS, seed++);
+            strobe.setTarget(target.frequency);
+            pitch.reset();
+            StrobeResult result;
+            PitchResult pitchResult;
+            double firstLock = -1.0;
+            for (size_t offset = 0, h = 0; offset + hop <= signal.size(); offset += hop, ++h) {
+                auto start = Clock::now();
+                strobe.process(signal.data() + offset, hop, result);
+                auto middle = Clock::now();
+                pitch.processHop(signal.data() + offset, 440.0f, pitchResult);
+                pitchSeconds += std::chrono::duration<double>(Clock::now() - middle).count();
+                strobeSeconds += std::chrono::duration<double>(middle - start).count();
+                ++totalHops;
+                if (!result.locked) continue;
+                if (firstLock < 0.0) firstLock = 1000.0 * (offset + hop) / config.sampleRate;
+                if (static_cast<int>(h) >= settledHop) errors.push_back(std::fabs(result.centsOffset - detune));
+            }
+            if (firstLock >= 0.0) lockMillis.push_back(firstLock);
+        }
+        std::printf("  %-3s %8.2f Hz  locked %zu/%zu  first lock %5.0f ms  |cents| mean %6.3f p95 %6.3f max %6.3f\n",
+                    target.name, target.frequency, lockMillis.size(), detunes.size(), mean(lockMillis),
+                    mean(errors), percentile(errors, 0.95), percentile(errors, 1.0));
+        allErrors.insert(allErrors.end(), errors.begin(), errors.end());
+    }
+    const double strobeMicros = totalHops > 0 ? 1e6 * strobeSeconds / totalHops : 0.0;
+    const double pitchMicros = totalHops > 0 ? 1e6 * pitchSeconds / totalHops : 0.0;
+    std::printf("  settled |cents| p95 %.3f  %.2f us/hop vs %.2f us/hop for the %s pipeline (%.1fx cheaper)\n\n",
+                percentile(allErrors, 0.95), strobeMicros, pitchMicros, methodName(pitchConfig.method),
+                strobeMicros > 0 ? pitchMicros / strobeMicros : 0.0);
+}
+
+// --- Gating Cascade ---
+// A practice session over steady room noise: silence, a pick attack into a low note, fret noise,
+// a second note, silence again. Runs it through the same pipeline with the cascade and with the
+// fixed gate, and reports the windows each stage stopped, the analysis cost, and where the two
+// disagree (a note only one of them found, and the largest cents difference where both did).
+void measureGatingCascade(AnalysisConfig config) {
+    using Clock = std::chrono::steady_clock;
+    const int rate = config.sampleRate;
+    std::vector<float> session = synthesizeNoise(rate, 8.0f, ROOM_NOISE_RMS, ROOM_NOISE_SMOOTHING, 900);
+    auto mixIn = [&](const std::vector<float>& part, float atSeconds) {
+        const size_t start = static_cast<size_t>(atSeconds * rate);
+        for (size_t i = 0; i < part.size() && start + i < session.size(); ++i) session[start + i] += part[i];
+    };
+    mixIn(synthesizeNoise(rate, 0.02f, 0.2f, 1.0f, 901), 1.5f);      // Pick attack
+    mixIn(synthesizeString(82.41f, rate, 2.5f, 902), 1.5f);          // E2
+    mixIn(synthesizeNoise(rate, 0.08f, 0.05f, 0.5f, 903), 4.2f);     // Fret squeak
+    mixIn(synthesizeString(220.0f * std::exp2(-9.0f / 1200.0f), rate, 2.0f, 904), 4.6f);
+
+    config.method = DifferenceMethod::Sliding; // The app's single-note pipeline
+    const bool cascades[] = {true, false};
+    std::vector<PitchResult> results[2];
+    double seconds[2] = {};
+    int stages[2][ANALYSIS_STAGES] = {};
+    for (int run = 0; run < 2; ++run) {
+        config.gatingCascade = cascades[run];
+        PitchAnalyzer analyzer;
+        if (!analyzer.configure(config)) return;
+        PitchResult result;
+        for (size_t offset = 0; offset + config.hopSize <= session.size(); offset += config.hopSize) {
+            auto start = Clock::now();
+            bool analysed = analyzer.processHop(session.data() + offset, 440.0f, result);
+            seconds[run] += std::chrono::duration<double>(Clock::now() - start).count();
+            if (!analysed) continue;
+            ++stages[run][static_cast<int>(result.stage)];
+            results[run].push_back(result);
+        }
+    }
+
+    int onlyCascade = 0;
+    int onlyFixed = 0;
+    double worstCents = 0.0;
+    for (size_t i = 0; i < results[0].size() && i < results[1].size(); ++i) {
+        const float on = results[0][i].frequency;
+        const float off = results[1][i].frequency;
+        if (on > 0.0f && off > 0.0f) {
+            worstCents = std::max(worstCents, std::fabs(1200.0 * std::log2(on / off)));
+        } else if (on > 0.0f) {
+            ++onlyCascade;
+        } else if (off > 0.0f) {
+            ++onlyFixed;
+        }
+    }
+    const double windows = static_cast<double>(results[0].size());
+    std::printf("[gating cascade, %s, hop %d, %.0f s session, %zu windows]\n", methodName(config.method),
+                config.hopSize, session.size() / static_cast<double>(rate), results[0].size());
+    for (int run = 0; run < 2; ++run) {
+        std::printf("  %-10s ", cascades[run] ? "cascade" : "fixed gate");
+        printStages(stages[run]);
+        std::printf("  %.2f us/window\n", windows > 0 ? 1e6 * seconds[run] / windows : 0.0);
+    }
+    std::printf("  cpu saved %.0f%%  pitch only with cascade %d, only with fixed gate %d, max |cents| apart %.3f\n\n",
+                seconds[1] > 0.0 ? 100.0 * (1.0 - seconds[0] / seconds[1]) : 0.0, onlyCascade, onlyFixed, worstCents);
+}
+
+// --- Result Mailbox ---
+// A writer thread publishes results whose fields all encode the same counter while this thread
+// reads them back the way readMailboxNative does, from the raw buffer. Every copy the seqlock
+// accepts must be whole.
+bool verifyMailbox() {
+    ResultMailbox* mailbox = new ResultMailbox(); // Value-initialised, as constructMailboxes does
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+        using Clock = std::chrono::steady_clock;
+        for (int i = 1; i <= MAILBOX_PUBLISHES; ++i) {
+            const auto until = Clock::now() + std::chrono::nanoseconds(MAILBOX_PUBLISH_GAP_NANOS);
+            while (Clock::now() < until) {
+            }
+            mailbox->publish({i, -i, static_cast<float>(i), static_cast<float>(-i), static_cast<float>(i),
+                              static_cast<float>(i), 3 * static_cast<int64_t>(i)});
+        }
+        done = true;
+    });
+    const auto* base = reinterpret_cast<const unsigned char*>(mailbox);
+    uint32_t last = 0;
+    uint64_t reads = 0;
+    uint64_t torn = 0;
+    int previous = 0;
+    uint64_t stale = 0; // Newer sequence but an older result: would mean a lost ordering
+    while (!done.load()) {
+        uint32_t words[ResultMailbox::WORDS];
+        const uint32_t sequence = readMailboxWords(*reinterpret_cast<const std::atomic<uint32_t>*>(base),
+                                                   reinterpret_cast<const std::atomic<uint32_t>*>(base + MAILBOX_PAYLOAD_OFFSET),
+                                                   ResultMailbox::WORDS, last, words);
+        if (sequence == last) continue;
+        last = sequence;
+        MailboxResult result;
+        std::memcpy(&result, words, sizeof(result));
+        ++reads;
+        const int i = result.noteIndex;
+        if (result.octave != -i || result.frequency != static_cast<float>(i) || result.centsOffset != static_cast<float>(-i) ||
+            result.rms != static_cast<float>(i) || result.timestampNanos != 3 * static_cast<int64_t>(i) ||
+            static_cast<uint32_t>(2 * i) != sequence) {
+            ++torn;
+        }
+        if (i < previous) ++stale;
+        previous = i;
+    }
+    writer.join();
+    delete mailbox;
+    const bool ok = torn == 0 && stale == 0 && reads > 0;
+    std::printf("[result mailbox] %d publishes, %llu reads accepted, %llu torn, %llu out of order%s\n\n",
+                MAILBOX_PUBLISHES, static_cast<unsigned long long>(reads), static_cast<unsigned long long>(torn),
+                static_cast<unsigned long long>(stale), ok ? "" : "  FAILED");
+    if (!ok) std::fprintf(stderr, "result mailbox: the seqlock accepted an inconsistent copy\n");
+    return ok;
+}
+
+// --- Multi-Instance Engine ---
+// Collects every lane's pitch results; each lane is written by its own worker only.
+struct LaneCapture : AnalysisSink {
+    std::vector<PitchResult> results[MAX_ENGINE_LANES];
+    std::thread::id workers[MAX_ENGINE_LANES];
+
+    void onPitchResult(int lane, const PitchResult& result) override {
+        results[lane].push_back(result);
+        workers[lane] = std::this_thread::get_id();
+    }
+    void onStrumResult(int, const StrumResult&) override {}
+    void onStrobeResult(int, const StrobeResult&) override {}
+};
+
+// Checks one lane against a standalone PitchAnalyzer fed the same channel at the same A4: with
+// no backlog skipped the two must agree window for window, and most windows find the note.
+bool checkLane(const char* instance, int lane, float expected, const std::vector<float>& channel, float a4,
+               const AnalysisConfig& config, const std::vector<PitchResult>& results, const LaneMetrics& metrics) {
+    PitchAnalyzer reference;
+    if (!reference.configure(config)) return false;
+    std::vector<PitchResult> referenceResults;
+    PitchResult result;
+    for (size_t offset = 0; offset + config.hopSize <= channel.size(); offset += config.hopSize) {
+        if (reference.processHop(channel.data() + offset, a4, result)) referenceResults.push_back(result);
+    }
+    const bool skipped = metrics.skippedBacklogs.load() > 0;
+    bool identical = results.size() == referenceResults.size();
+    for (size_t i = 0; identical && i < results.size(); ++i) {
+        identical = results[i].frequency == referenceResults[i].frequency &&
+                    results[i].centsOffset == referenceResults[i].centsOffset;
+    }
+    int detected = 0;
+    for (const PitchResult& r : results) {
+        if (r.frequency > 0.0f && std::fabs(1200.0 * std::log2(r.frequency / expected)) <= GROSS_ERROR_CENTS) ++detected;
+    }
+    const float share = results.empty() ? 0.0f : static_cast<float>(detected) / results.size();
+    const bool ok = share >= ENGINE_MIN_DETECTED && (identical || skipped);
+    std::printf("  %s lane %d  %7.2f Hz @ A4 %.0f  %4zu windows  %5.1f%% found  %s  load %.2f%%%s\n",
+                instance, lane, expected, a4, results.size(), 100.0f * share,
+                skipped ? "backlog skipped, not compared" : identical ? "same as standalone" : "DIFFERS from standalone",
+                metrics.analysis.totalBudgetNanos.load() > 0
+                        ? 100.0 * metrics.analysis.totalNanos.load() / metrics.analysis.totalBudgetNanos.load() : 0.0,
+                ok ? "" : "  FAILED");
+    return ok;
+}
+
+// Two engine instances on one worker pool, as two interfaces would run in the app: a 4-channel
+// input with an instrument on every channel, and a stereo input analysing its right channel
+// against A4 = 432 Hz. The input is fed in device-sized blocks, faster than real time, from this
+// thread standing in for the audio callbacks. Every lane has to find its own note.
+bool verifyMultiInstance(AnalysisConfig config) {
+    using Clock = std::chrono::steady_clock;
+    config.method = DifferenceMethod::Sliding; // The app's single-note pipeline
+    const int rate = config.sampleRate;
+    const float detune = std::pow(2.0f, SYNTHETIC_DETUNE_CENTS / 1200.0f);
+    const float quad[] = {82.407f * detune, 110.0f * detune, 146.83f * detune, 196.0f * detune};
+    const float stereo = 440.0f;
+    const float stereoA4 = 432.0f;
+
+    EngineConfig quadConfig;
+    quadConfig.analysis = config;
+    quadConfig.channelCount = 4;
+    quadConfig.laneCount = 4;
+    for (int i = 0; i < 4; ++i) quadConfig.laneChannels[i] = i;
+    EngineConfig stereoConfig;
+    stereoConfig.analysis = config;
+    stereoConfig.channelCount = 2;
+    stereoConfig.laneCount = 1;
+    stereoConfig.laneChannels[0] = 1;
+    TunerEngine quadEngine;
+    TunerEngine stereoEngine;
+    if (!quadEngine.configure(quadConfig) || !stereoEngine.configure(stereoConfig)) return false;
+    stereoEngine.setA4(stereoA4);
+
+    // Interleaved input: one string per channel of the quad input, noise left and A4 right on the stereo one
+    const size_t frames = static_cast<size_t>(ENGINE_SECONDS * rate);
+    std::vector<float> strings[4];
+    std::vector<float> quadInput(4 * frames);
+    for (int c = 0; c < 4; ++c) {
+        strings[c] = synthesizeString(quad[c], rate, ENGINE_SECONDS, 1000 + c);
+        for (size_t i = 0; i < frames; ++i) quadInput[4 * i + c] = strings[c][i];
+    }
+    std::vector<float> stereoInput(2 * frames);
+    std::vector<float> left = synthesizeNoise(rate, ENGINE_SECONDS, ROOM_NOISE_RMS, ROOM_NOISE_SMOOTHING, 1010);
+    std::vector<float> right = synthesizeString(stereo, rate, ENGINE_SECONDS, 1011);
+    for (size_t i = 0; i < frames; ++i) {
+        stereoInput[2 * i] = left[i];
+        stereoInput[2 * i + 1] = right[i];
+    }
+
+    AnalysisWorkerPool pool(AnalysisWorkerPool::defaultThreadCount());
+    LaneCapture quadCapture;
+    LaneCapture stereoCapture;
+    quadEngine.start(pool, quadCapture);
+    stereoEngine.start(pool, stereoCapture);
+    const auto start = Clock::now();
+    for (size_t offset = 0; offset < frames; offset += ENGINE_BLOCK_FRAMES) {
+        const int count = static_cast<int>(std::min<size_t>(ENGINE_BLOCK_FRAMES, frames - offset));
+        std::this_thread::sleep_until(start + std::chrono::duration<double>(offset / (ENGINE_FEED_SPEEDUP * rate)));
+        quadEngine.onInput(quadInput.data() + 4 * offset, count);
+        stereoEngine.onInput(stereoInput.data() + 2 * offset, count);
+    }
+    // Let the workers drain whatever whole hops are left
+    auto drained = [](const TunerEngine& engine) {
+        for (int i = 0; i < engine.laneCount(); ++i) {
+            if (engine.lane(i).queuedSamples() >= static_cast<size_t>(engine.config().analysis.hopSize)) return false;
+        }
+        return true;
+    };
+    while (!drained(quadEngine) || !drained(stereoEngine)) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    quadEngine.stop();
+    stereoEngine.stop();
+
+    std::vector<std::thread::id> workers;
+    for (int i = 0; i < 4; ++i) workers.push_back(quadCapture.workers[i]);
+    workers.push_back(stereoCapture.workers[0]);
+    std::sort(workers.begin(), workers.end());
+    const size_t distinctWorkers = std::unique(workers.begin(), workers.end()) - workers.begin();
+    std::printf("[engine instances, pool of %d thread(s), %.0f s fed at %.0fx real time in %d-frame blocks]\n",
+                pool.threadCount(), ENGINE_SECONDS, ENGINE_FEED_SPEEDUP, ENGINE_BLOCK_FRAMES);
+    bool ok = true;
+    for (int i = 0; i < 4; ++i) {
+        ok &= checkLane("quad  ", i, quad[i], strings[i], 440.0f, config, quadCapture.results[i],
+                        quadEngine.lane(i).metrics());
+    }
+    ok &= checkLane("stereo", 0, stereo, right, stereoA4, config, stereoCapture.results[0], stereoEngine.lane(0).metrics());
+    const unsigned long long dropped = quadEngine.metrics().droppedInputFrames.load() +
+                                       stereoEngine.metrics().droppedInputFrames.load();
+    std::printf("  5 lanes on %zu worker(s), %llu input frame(s) dropped\n\n", distinctWorkers, dropped);
+    if (!ok) std::fprintf(stderr, "engine instances: a lane missed its note\n");
+    return ok && dropped == 0;
+}
+
+// --- Capture and Replay ---
+// A stereo input in callbacks of varying size written to a capture file whose rings wrap, with two
+// A4 changes recorded on the way, read back, and replayed inline through an engine analysing the
+// left channel. The held callbacks must come back intact, and two replays and a standalone analyzer
+// fed the held frames, switching A4 where the replay applies the change, must agree window for
+// window.
+bool verifyCaptureReplay(AnalysisConfig config) {
+    using Clock = std::chrono::steady_clock;
+    config.method = DifferenceMethod::Sliding;
+    const int rate = config.sampleRate;
+    const size_t frames = static_cast<size_t>(CAPTURE_INPUT_SECONDS * rate);
+    std::vector<float> left = synthesizeString(110.0f, rate, CAPTURE_INPUT_SECONDS / 2, 3000);
+    std::vector<float> second = synthesizeString(146.83f, rate, CAPTURE_INPUT_SECONDS / 2, 3001);
+    left.insert(left.end(), second.begin(), second.end());
+    left.resize(frames);
+    std::vector<float> right = synthesizeNoise(rate, CAPTURE_INPUT_SECONDS, ROOM_NOISE_RMS, ROOM_NOISE_SMOOTHING, 3002);
+    std::vector<float> input(2 * frames);
+    for (size_t i = 0; i < frames; ++i) {
+        input[2 * i] = left[i];
+        input[2 * i + 1] = right[i];
+    }
+
+    const std::string path = (std::filesystem::temp_directory_path() / "afinador_bench.afcap").string();
+    std::vector<CaptureCallback> written;
+    std::vector<uint64_t> changeFrames; // Where each A4 change was recorded
+    double appendSeconds = 0.0;
+    {
+        CaptureWriter writer;
+        if (!writer.open(path.c_str(), rate, 2, CAPTURE_RING_SECONDS, config)) return false;
+        const int laneChannel = 0;
+        LaneSettings settings;
+        writer.setLanes(1, &laneChannel, &settings);
+        size_t offset = 0;
+        size_t changes = 0;
+        for (size_t n = 0; offset < frames; ++n) {
+            if (changes < 2 && offset >= CAPTURE_A4_CHANGE_SECONDS[changes] * rate) {
+                settings.a4Frequency = CAPTURE_A4_CHANGES[changes++];
+                writer.recordSettings(0, settings);
+                changeFrames.push_back(offset);
+            }
+            const int size = CAPTURE_CALLBACK_FRAMES[n % (sizeof(CAPTURE_CALLBACK_FRAMES) / sizeof(int))];
+            const int count = static_cast<int>(std::min<size_t>(size, frames - offset));
+            const int64_t time = static_cast<int64_t>(1e9 * offset / rate);
+            const auto start = Clock::now();
+            writer.append(input.data() + 2 * offset, count, time, static_cast<int32_t>(n / 1000));
+            appendSeconds += std::chrono::duration<double>(Clock::now() - start).count();
+            written.push_back({time, offset, count, static_cast<int32_t>(n / 1000)});
+            offset += count;
+        }
+    }
+
+    CaptureReader reader;
+    if (!reader.open(path.c_str())) return false;
+    const size_t held = reader.callbackCount();
+    const size_t skipped = written.size() - held;
+    const uint64_t firstFrame = held > 0 ? reader.callback(0).firstFrame : 0;
+    bool intact = held > 0 && held <= written.size() && changeFrames.size() == 2 && changeFrames[0] < firstFrame &&
+                  changeFrames[1] > firstFrame && reader.settingsChangeCount() == 2 &&
+                  reader.lostSettingsChanges() == 0 && reader.laneCount() == 1 &&
+                  reader.laneSettings(0, firstFrame).a4Frequency == CAPTURE_A4_CHANGES[0];
+    std::vector<float> callbackFrames(2 * static_cast<size_t>(reader.maxFrameCount()));
+    std::vector<float> heldLeft;
+    for (size_t i = 0; intact && i < held; ++i) {
+        const CaptureCallback& record = reader.callback(i);
+        const CaptureCallback& expected = written[skipped + i];
+        reader.readFrames(i, callbackFrames.data());
+        intact = record.timeNanos == expected.timeNanos && record.firstFrame == expected.firstFrame &&
+                 record.frameCount == expected.frameCount && record.xRunCount == expected.xRunCount &&
+                 std::memcmp(callbackFrames.data(), input.data() + 2 * expected.firstFrame,
+                             2 * expected.frameCount * sizeof(float)) == 0;
+        for (int f = 0; f < record.frameCount; ++f) heldLeft.push_back(callbackFrames[2 * f]);
+    }
+
+    // Two inline replays, then the standalone reference
+    std::vector<PitchResult> replays[2];
+    ReplayStats stats;
+    for (std::vector<PitchResult>& replay : replays) {
+        EngineConfig engineConfig;
+        engineConfig.analysis = reader.analysisConfig();
+        engineConfig.channelCount = 2;
+        TunerEngine engine;
+        LaneCapture sink;
+        ReplayOptions options;
+        options.inlineSink = &sink;
+        if (!engine.configure(engineConfig) || !replayCapture(reader, engine, options, &stats)) return false;
+        replay = std::move(sink.results[0]);
+    }
+    const bool settingsApplied = stats.settingsChanges == 1;
+    PitchAnalyzer reference;
+    if (!reference.configure(reader.analysisConfig())) return false;
+    PitchResult result;
+    size_t same = 0;
+    size_t windows = 0;
+    for (size_t offset = 0; offset + config.hopSize <= heldLeft.size(); offset += config.hopSize) {
+        // Hops completed by the callback the second change was applied before, or later, use it
+        const bool changed = !changeFrames.empty() && firstFrame + offset + config.hopSize > changeFrames.back();
+        const float a4 = CAPTURE_A4_CHANGES[changed ? 1 : 0];
+        if (!reference.processHop(heldLeft.data() + offset, a4, result)) continue;
+        if (windows < replays[0].size() && replays[0][windows].frequency == result.frequency &&
+            replays[0][windows].centsOffset == result.centsOffset) {
+            ++same;
+        }
+        ++windows;
+    }
+    bool repeatable = replays[0].size() == replays[1].size();
+    for (size_t i = 0; repeatable && i < replays[0].size(); ++i) {
+        repeatable = replays[0][i].frequency == replays[1][i].frequency &&
+                     replays[0][i].centsOffset == replays[1][i].centsOffset;
+    }
+    const bool standalone = same == windows && windows == replays[0].size();
+    reader.close();
+    std::remove(path.c_str());
+
+    std::printf("[capture and replay, %.0f s stereo in 37..480-frame callbacks, %.0f s capture ring]\n",
+                CAPTURE_INPUT_SECONDS, CAPTURE_RING_SECONDS);
+    std::printf("  %zu of %zu callbacks held (%.1f s), %s  append mean %.0f ns per callback\n", held, written.size(),
+                static_cast<double>(heldLeft.size()) / rate, intact ? "frames and records intact" : "CORRUPT",
+                1e9 * appendSeconds / written.size());
+    std::printf("  inline replay %.0fx real time, %zu windows, %zu A4 change(s) applied, %s, %s\n\n",
+                stats.seconds > 0.0 ? stats.capturedSeconds / stats.seconds : 0.0, replays[0].size(),
+                stats.settingsChanges, standalone ? "same as standalone" : "DIFFERS from standalone",
+                repeatable ? "repeat run identical" : "repeat run DIFFERS");
+    const bool ok = intact && settingsApplied && standalone && repeatable;
+    if (!ok) std::fprintf(stderr, "capture and replay: the replay does not reproduce the capture\n");
+    return ok;
+}
+
+// --- Batch Pitch Track ---
+// A take of near silence followed by consecutive notes, tracked by one serial analyzer and by the
+// parallel batch tracker on BATCH_THREADS threads whatever the host has. The first run dealt out is
+// the quiet part, so its thread runs dry early and must steal. Reports both speeds and how many
+// windows came out the same, and checks that segments were stolen and that past the pre-roll after
+// each segment start every window has the serial run's gate decision and pitch. A note held over a
+// segment start may still be refined on another full-search cadence until the next onset, so the
+// pitch only has to agree within BATCH_HELD_NOTE_CENTS there.
+bool verifyBatchTrack(AnalysisConfig config) {
+    using Clock = std::chrono::steady_clock;
+    config.method = DifferenceMethod::Sliding;
+    const int rate = config.sampleRate;
+    const float notes[] = {82.41f, 110.0f, 146.83f, 196.0f, 246.94f, 329.63f, 41.2f, 55.0f};
+    std::vector<float> take = synthesizeNoise(rate, TAKE_SECONDS, TAKE_SILENCE_RMS, 1.0f, 1999);
+    const size_t quietSamples = static_cast<size_t>(TAKE_SECONDS / BATCH_THREADS * rate);
+    for (int n = 0; quietSamples + n * TAKE_NOTE_SECONDS * rate < take.size(); ++n) {
+        const float detune = std::pow(2.0f, ((n * 7) % 21 - 10) / 1200.0f); // Within 10 cents
+        const std::vector<float> note = synthesizeString(notes[n % 8] * detune, rate, TAKE_NOTE_SECONDS, 2000 + n);
+        const size_t start = quietSamples + static_cast<size_t>(n * TAKE_NOTE_SECONDS * rate);
+        for (size_t i = 0; i < note.size() && start + i < take.size(); ++i) take[start + i] += note[i];
+    }
+
+    PitchTrackConfig trackConfig;
+    trackConfig.analysis = config;
+    trackConfig.threadCount = BATCH_THREADS;
+    std::vector<PitchTrackRecord> serial(pitchTrackRecordCount(take.size(), config));
+    PitchAnalyzer analyzer;
+    if (!analyzer.configure(config)) return false;
+    PitchResult result;
+    size_t record = 0;
+    auto start = Clock::now();
+    for (size_t offset = 0; offset + config.hopSize <= take.size(); offset += config.hopSize) {
+        if (!analyzer.processHop(take.data() + offset, trackConfig.a4Frequency, result)) continue;
+        serial[record].frequency = result.noteIndex != NOTE_INDEX_NOT_AVAILABLE ? result.frequency : 0.0f;
+        serial[record++].centsOffset = result.centsOffset;
+    }
+    const double serialSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<PitchTrackRecord> batch(serial.size());
+    PitchTrackStats stats;
+    if (!computePitchTrack(take.data(), take.size(), trackConfig, batch.data(), &stats)) return false;
+
+    // Same segment length as computePitchTrack; within the pre-roll length after a segment start
+    // the gate may not have reached the serial run's state yet
+    const double hopsPerSecond = static_cast<double>(rate) / config.hopSize;
+    const size_t segmentRecords = std::max<size_t>(1, static_cast<size_t>(trackConfig.segmentSeconds * hopsPerSecond));
+    const size_t settleRecords = static_cast<size_t>(std::ceil(trackConfig.preRollSeconds * hopsPerSecond));
+    size_t same = 0;
+    size_t differing = 0;     // Past the pre-roll
+    double worstCents = 0.0;  // Past the pre-roll, between windows both found pitched
+    for (size_t i = 0; i < serial.size(); ++i) {
+        const bool pitched = serial[i].frequency != 0.0f;
+        if (pitched ? std::fabs(batch[i].centsOffset - serial[i].centsOffset) < 0.01f : batch[i].frequency == 0.0f) {
+            ++same;
+            continue;
+        }
+        if (i % segmentRecords < settleRecords) continue;
+        if (pitched != (batch[i].frequency != 0.0f)) {
+            ++differing;
+            continue;
+        }
+        const double cents = std::fabs(1200.0 * std::log2(batch[i].frequency / serial[i].frequency));
+        worstCents = std::max(worstCents, cents);
+        if (cents > BATCH_HELD_NOTE_CENTS) ++differing;
+    }
+    std::printf("[batch pitch track, %s, hop %d, %.0f s take, %zu windows]\n", methodName(config.method),
+                config.hopSize, TAKE_SECONDS, serial.size());
+    std::printf("  serial %.2f s (%.0fx real time)  batch %.2f s on %d thread(s) (%.0fx, %d segments, %d stolen)\n",
+                serialSeconds, TAKE_SECONDS / serialSeconds, stats.seconds, stats.threads, TAKE_SECONDS / stats.seconds,
+                stats.segments, stats.stolenSegments);
+    std::printf("  5-minute take in %.1f s  same as serial %.2f%% of windows, past the pre-roll %zu differ, "
+                "worst %.1f cents\n\n", 300.0 / TAKE_SECONDS * stats.seconds,
+                serial.empty() ? 0.0 : 100.0 * same / serial.size(), differing, worstCents);
+    const bool ok = stats.threads == BATCH_THREADS && stats.stolenSegments > 0 && differing == 0;
+    if (!ok) std::fprintf(stderr, "batch pitch track: no segment stolen or windows differ from the serial run\n");
+    return ok;
+}
+
+// --- Duty Cycle ---
+// Counts one lane's pitch results; the lane is driven from this thread.
+struct DutyCycleSink : AnalysisSink {
+    int results = 0;
+    PitchResult last;
+
+    void onPitchResult(int, const PitchResult& result) override {
+        ++results;
+        last = result;
+    }
+    void onStrumResult(int, const StrumResult&) override {}
+    void onStrobeResult(int, const StrobeResult&) override {}
+};
+
+// A practice session (silence, a held E2, the same string plucked again while it rings, an A2,
+// silence) fed hop by hop through a lane with the duty cycle off and on. Reports the analysis rate,
+// the time spent in each scheduler state and the CPU saved, and checks that every onset is found
+// on the same hop as at the full rate and that the windows both runs analysed find the same note.
+bool verifyDutyCycle(AnalysisConfig config) {
+    using Clock = std::chrono::steady_clock;
+    config.method = DifferenceMethod::Sliding;
+    const int rate = config.sampleRate;
+    const int hop = config.hopSize;
+    struct Onset { float seconds; float frequency; bool newNote; }; // A re-pluck keeps the reading
+    const Onset onsets[] = {{1.0f, 82.41f, true}, {3.0f, 82.41f, false}, {5.0f, 110.0f, true}};
+    std::vector<float> session = synthesizeNoise(rate, DUTY_SESSION_SECONDS, DUTY_SILENCE_RMS, 1.0f, 4000);
+    const float lengths[] = {2.0f, 2.0f, 2.0f}; // The last note stops dead, as when muted
+    for (int n = 0; n < 3; ++n) {
+        const std::vector<float> note = synthesizeString(onsets[n].frequency, rate, lengths[n], 4001 + n);
+        const size_t start = static_cast<size_t>(onsets[n].seconds * rate);
+        for (size_t i = 0; i < note.size() && start + i < session.size(); ++i) session[start + i] += note[i];
+    }
+    const size_t hops = session.size() / hop;
+
+    // Per hop and run: the result, if the window was analysed
+    std::vector<PitchResult> results[2];
+    std::vector<bool> analysed[2];
+    std::vector<int> states(hops); // Duty-cycled run's SchedulerState after each hop
+    int stateHops[2][3] = {};
+    double seconds[2] = {};
+    uint64_t savedNanos = 0;
+    uint64_t skippedHops = 0;
+    for (int run = 0; run < 2; ++run) {
+        AnalysisLane lane;
+        if (!lane.configure(0, config, 4 * static_cast<size_t>(config.windowSize))) return false;
+        DutyCyclePolicy policy;
+        policy.enabled = run == 1;
+        lane.setDutyCycle(policy);
+        DutyCycleSink sink;
+        results[run].resize(hops);
+        analysed[run].assign(hops, false);
+        for (size_t h = 0; h < hops; ++h) {
+            lane.write(session.data() + h * hop, hop, 1);
+            const int before = sink.results;
+            const auto start = Clock::now();
+            lane.analyseNext(sink);
+            seconds[run] += std::chrono::duration<double>(Clock::now() - start).count();
+            if (sink.results != before) {
+                analysed[run][h] = true;
+                results[run][h] = sink.last;
+            }
+            states[h] = lane.metrics().schedulerState.load();
+            ++stateHops[run][states[h]];
+        }
+        if (run == 1) {
+            savedNanos = lane.metrics().cpuSavedNanos.load();
+            skippedHops = lane.metrics().dutyCycledHops.load();
+        }
+    }
+
+    // In hops from the hop holding each onset: the first window that finds its note, and the
+    // duty-cycled run's return to the full rate
+    auto onsetHop = [&](const Onset& onset) { return static_cast<size_t>(onset.seconds * rate) / hop; };
+    auto detectedAfter = [&](int run, const Onset& onset) {
+        const size_t first = onsetHop(onset);
+        for (size_t h = first; h < hops; ++h) {
+            const PitchResult& r = results[run][h];
+            if (analysed[run][h] && r.noteIndex != NOTE_INDEX_NOT_AVAILABLE &&
+                std::fabs(1200.0 * std::log2(r.frequency / onset.frequency)) <= GROSS_ERROR_CENTS) {
+                return static_cast<long>(h - first);
+            }
+        }
+        return -1L;
+    };
+    auto fullRateAfter = [&](const Onset& onset) {
+        const size_t first = onsetHop(onset);
+        for (size_t h = first; h < hops; ++h) {
+            if (states[h] == static_cast<int>(SchedulerState::Full)) return static_cast<long>(h - first);
+        }
+        return -1L;
+    };
+    // Windows analysed by both runs must find the same note. The skipped hops leave the sliding
+    // curve and the local search with other history, so readings may move within the detector's
+    // own jitter, which grows as a note dies away.
+    int both = 0;
+    int sameNote = 0;
+    int close = 0;
+    double worstCents = 0.0;
+    for (size_t h = 0; h < hops; ++h) {
+        if (!analysed[0][h] || !analysed[1][h]) continue;
+        ++both;
+        const PitchResult& full = results[0][h];
+        const PitchResult& cycled = results[1][h];
+        if (full.noteIndex != cycled.noteIndex || full.octave != cycled.octave) continue;
+        ++sameNote;
+        if (full.noteIndex == NOTE_INDEX_NOT_AVAILABLE) {
+            ++close;
+            continue;
+        }
+        const double cents = std::fabs(1200.0 * std::log2(cycled.frequency / full.frequency));
+        worstCents = std::max(worstCents, cents);
+        if (cents <= DUTY_AGREEMENT_CENTS) ++close;
+    }
+    size_t windows[2] = {};
+    for (int run = 0; run < 2; ++run) windows[run] = std::count(analysed[run].begin(), analysed[run].end(), true);
+    const double fullRate = static_cast<double>(rate) / hop;
+    std::printf("[duty cycle, %s, hop %d, %.0f s session, full rate %.0f windows/s]\n", methodName(config.method),
+                hop, DUTY_SESSION_SECONDS, fullRate);
+    for (int run = 0; run < 2; ++run) {
+        std::printf("  %-4s %5zu windows (%.0f/s)  full %.0f%% silent %.0f%% held %.0f%% of hops  %.2f ms\n",
+                    run == 1 ? "on" : "off", windows[run], windows[run] / DUTY_SESSION_SECONDS,
+                    100.0 * stateHops[run][0] / hops, 100.0 * stateHops[run][1] / hops,
+                    100.0 * stateHops[run][2] / hops, 1e3 * seconds[run]);
+    }
+    std::printf("  cpu saved %.0f%% (wall), %.2f ms over %llu skipped hops (lane estimate)\n",
+                seconds[0] > 0.0 ? 100.0 * (1.0 - seconds[1] / seconds[0]) : 0.0, savedNanos / 1e6,
+                static_cast<unsigned long long>(skippedHops));
+    bool onTime = true;
+    std::printf("  onsets (hops to full rate, note found off/on):");
+    for (const Onset& onset : onsets) {
+        // The hop holding the onset may not have enough of it to stand out
+        const long full = fullRateAfter(onset);
+        onTime &= full >= 0 && full <= 1;
+        std::printf("  %.1f s %ld", onset.seconds, full);
+        if (!onset.newNote) continue;
+        const long off = detectedAfter(0, onset);
+        const long on = detectedAfter(1, onset);
+        onTime &= off >= 0 && on == off;
+        std::printf(", %ld/%ld", off, on);
+    }
+    const bool agree = both > 0 && sameNote == both;
+    std::printf("\n  windows analysed by both runs: %d, same note %d, within %.0f cent %.1f%%, max |cents| apart %.3f%s\n\n",
+                both, sameNote, DUTY_AGREEMENT_CENTS, 100.0 * close / std::max(both, 1), worstCents,
+                onTime && agree ? "" : "  FAILED");
+    if (!onTime) std::fprintf(stderr, "duty cycle: an onset was answered later than at the full rate\n");
+    if (!agree) std::fprintf(stderr, "duty cycle: analysed windows differ from the full-rate run\n");
+    return onTime && agree;
+}
+
+// --- Sliding Difference ---
+// Runs the sliding curve over a decaying string for SLIDING_REFRESH_HOPS hops (the longest stretch
+// between full recomputes) and reports its drift from a fresh direct curve, in units of the
+// window energy (the scale of the 0.15 YIN threshold), plus the cost of one update.
+void measureSlidingDrift(const AnalysisConfig& config) {
+    using Clock = std::chrono::steady_clock;
+    const DspKernels& kernels = dspKernels();
+    const int n = config.windowSize;
+    const int hop = config.hopSize;
+    const int tauMin = std::max(2, static_cast<int>(config.sampleRate / MAX_EXPECTED_FREQUENCY));
+    const int tauMax = std::min(static_cast<int>(config.sampleRate / MIN_VALID_FREQUENCY), n / 2 - 1);
+    if (2 * hop >= n || tauMax <= tauMin) return;
+    std::vector<float> signal = synthesizeString(82.41f, config.sampleRate,
+                                                 static_cast<float>(n + SLIDING_REFRESH_HOPS * hop) / config.sampleRate, 3);
+    std::vector<float> slid(n / 2, 0.0f);
+    std::vector<float> direct(n / 2, 0.0f);
+    kernels.difference(signal.data(), n, tauMin, tauMax, slid.data());
+
+    double updateSeconds = 0.0;
+    double worstDrift = 0.0;
+    for (int h = 0; h < SLIDING_REFRESH_HOPS; ++h) {
+        const float* history = signal.data() + h * hop;
+        auto start = Clock::now();
+        kernels.slideDifference(history, n, hop, tauMin, tauMax, slid.data());
+        updateSeconds += std::chrono::duration<double>(Clock::now() - start).count();
+        kernels.difference(history + hop, n, tauMin, tauMax, direct.data());
+        const double energy = 2.0 * kernels.sumOfSquares(history + hop, n);
+        for (int tau = tauMin; tau < tauMax; ++tau) {
+            worstDrift = std::max(worstDrift, std::fabs(slid[tau] - direct[tau]) / energy);
+        }
+    }
+    const double fullMicros = differenceMicros(kernels, std::vector<float>(signal.begin(), signal.begin() + n),
+                                               tauMax, direct);
+    const double updateMicros = 1e6 * updateSeconds / SLIDING_REFRESH_HOPS;
+    std::printf("[sliding difference, hop %d] update %.1f us vs full %.1f us (%.1fx)  drift after %d hops %.2e\n\n",
+                hop, updateMicros, fullMicros, updateMicros > 0 ? fullMicros / updateMicros : 0.0,
+                SLIDING_REFRESH_HOPS, worstDrift);
+}
+
+void printUsage() {
+    std::fprintf(stderr,
+                 "usage: afinador_bench [--method direct|fft|sliding|all] [--window N] [--hop N] [--rate HZ]\n"
+                 "                      [--seconds S] [--narrow SEMITONES] [--decimate M] [--low-window N]\n"
+                 "                      [--no-cascade] [recording.wav:EXPECTED_HZ ...]\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    AnalysisConfig config;
+    std::vector<DifferenceMethod> methods = {DifferenceMethod::Direct, DifferenceMethod::Fft, DifferenceMethod::Sliding};
+    float seconds = 2.0f;
+    float narrowSemitones = 0.0f; // 0: full scan only
+    std::vector<std::string> recordings;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(arg, "--method") == 0 && hasValue) {
+            std::string name = argv[++i];
+            if (name == "direct") methods = {DifferenceMethod::Direct};
+            else if (name == "fft") methods = {DifferenceMethod::Fft};
+            else if (name == "sliding") methods = {DifferenceMethod::Sliding};
+            else if (name != "all") { printUsage(); return 2; }
+        } else if (std::strcmp(arg, "--window") == 0 && hasValue) {
+            config.windowSize = std::atoi(argv[++i]);
+        } else if (std::strcmp(arg, "--hop") == 0 && hasValue) {
+            config.hopSize = std::atoi(argv[++i]);
+        } else if (std::strcmp(arg, "--rate") == 0 && hasValue) {
+            config.sampleRate = std::atoi(argv[++i]);
+        } else if (std::strcmp(arg, "--seconds") == 0 && hasValue) {
+            seconds = static_cast<float>(std::atof(argv[++i]));
+        } else if (std::strcmp(arg, "--decimate") == 0 && hasValue) {
+            config.lowRegisterDecimation = std::atoi(argv[++i]);
+        } else if (std::strcmp(arg, "--low-window") == 0 && hasValue) {
+            config.lowRegisterWindowSize = std::atoi(argv[++i]);
+        } else if (std::strcmp(arg, "--narrow") == 0 && hasValue) {
+            narrowSemitones = static_cast<float>(std::atof(argv[++i]));
+        } else if (std::strcmp(arg, "--no-cascade") == 0) {
+            config.gatingCascade = false;
+        } else if (arg[0] == '-') {
+            printUsage();
+            return 2;
+        } else {
+            recordings.push_back(arg);
+        }
+    }
+
+    // Synthetic references: open strings of the bundled tunings, detuned so cents error is measurable
+    struct Note { const char* name; float frequency; };
+    const Note notes[] = {
+            {"B0", 30.868f}, {"E1", 41.203f}, {"A1", 55.0f},   {"E2", 82.407f},
+            {"A2", 110.0f},  {"D3", 146.83f}, {"G3", 196.0f},  {"B3", 246.94f},
+            {"E4", 329.63f}, {"A4", 440.0f},  {"E5", 659.26f}, {"A5", 880.0f},
+    };
+    const float detune = std::pow(2.0f, SYNTHETIC_DETUNE_CENTS / 1200.0f);
+    std::vector<ReferenceSignal> signals;
+    uint32_t seed = 1;
+    for (const Note& note : notes) {
+        ReferenceSignal signal;
+        signal.name = std::string("synth ") + note.name;
+        signal.sampleRate = config.sampleRate;
+        signal.frequency = note.frequency * detune;
+        signal.samples = synthesizeString(signal.frequency, signal.sampleRate, seconds, seed++);
+        signals.push_back(std::move(signal));
+    }
+    for (const std::string& spec : recordings) {
+        size_t colon = spec.rfind(':');
+        if (colon == std::string::npos) {
+            std::fprintf(stderr, "recording '%s' needs an expected frequency (file.wav:HZ)\n", spec.c_str());
+            return 2;
+        }
+        ReferenceSignal signal;
+        signal.name = spec.substr(0, colon);
+        signal.frequency = static_cast<float>(std::atof(spec.c_str() + colon + 1));
+        std::string error;
+        if (!readWavFile(signal.name, signal.samples, signal.sampleRate, error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+        signals.push_back(std::move(signal));
+    }
+
+    std::printf("afinador_bench: window %d, hop %d, %zu signals\n", config.windowSize, config.hopSize,
+                signals.size());
+    if (config.lowRegisterDecimation > 1) {
+        std::printf("low register: decimation %d, window %d\n", config.lowRegisterDecimation,
+                    config.lowRegisterWindowSize);
+    }
+    std::printf("\n");
+    if (!verifyKernels(config)) return 1;
+    if (!verifyMailbox()) return 1;
+    if (!verifyMultiInstance(config)) return 1;
+    if (!verifyCaptureReplay(config)) return 1;
+    if (!verifyDutyCycle(config)) return 1;
+    if (!verifyBatchTrack(config)) return 1;
+    compareNoteMapping();
+    measureSlidingDrift(config);
+    measureStrumMode(config.sampleRate, config.hopSize);
+    measureStrobeMode(config);
+    measureGatingCascade(config);
+    for (DifferenceMethod method : methods) {
+        std::printf("[%s]\n", methodName(method));
+        BenchStats total;
+        for (const ReferenceSignal& signal : signals) {
+            AnalysisConfig signalConfig = config;
+            signalConfig.sampleRate = signal.sampleRate;
+            signalConfig.method = method;
+            PitchAnalyzer analyzer;
+            if (!analyzer.configure(signalConfig)) return 1;
+            if (narrowSemitones > 0.0f) {
+                float spread = std::pow(2.0f, narrowSemitones / 12.0f);
+                FrequencyRange target = {signal.frequency / spread, signal.frequency * spread};
+                analyzer.setCandidateRanges(&target, 1);
+            }
+            BenchStats stats = runSignal(analyzer, signal);
+            printSignalLine(signal, stats);
+            total.merge(stats);
+        }
+        printSummary(methodName(method), total);
+    }
+    return 0;
+}
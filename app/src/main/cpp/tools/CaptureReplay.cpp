@@ -0,0 +1,241 @@
+// Replays an input capture recorded on a device (see CaptureFile.h) through the engine's audio
+// callback path, with the captured callback sizes and xrun counts, and writes one CSV row per
+// pitch result. By default everything follows the capture: the detector, the analysed channels,
+// and each lane's A4, candidate ranges, strum or strobe mode and duty cycle, including the changes
+// made while it was recording, at the frames they were made.
+//
+//   afinador_replay [--realtime] [--window N] [--hop N] [--method direct|fft|sliding] [--a4 HZ]
+//                   [--decimate M] [--low-window N] [--channels C[,C...]] [--duty-cycle]
+//                   [--no-settings] capture.afcap [output.csv]
+//
+// By default the callbacks are replayed as fast as possible and every lane is analysed on this
+// thread after each callback, so the output depends only on the capture and the settings: use it
+// for regression runs. --realtime paces the callbacks at their captured times and analyses on a
+// worker pool, as the app does, to reproduce timing problems. --channels picks the input channels
+// to analyse, one lane each. --a4 and --duty-cycle (the default DutyCyclePolicy, enabled) replace
+// the captured ones for the whole replay; with the duty cycle on the CSV only holds the windows it
+// analysed. --no-settings ignores the captured lane settings: single-note mode at 440 Hz.
+
+#include "AnalysisWorkerPool.h"
+#include "CaptureFile.h"
+#include "CaptureReplay.h"
+#include "TunerEngine.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static const char* const NOTE_NAMES[12] = {"C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"};
+
+static void printUsage() {
+    std::fprintf(stderr,
+                 "usage: afinador_replay [--realtime] [--window N] [--hop N] [--method direct|fft|sliding]\n"
+                 "                       [--a4 HZ] [--decimate M] [--low-window N] [--channels C[,C...]]\n"
+                 "                       [--duty-cycle] [--no-settings] capture.afcap [output.csv]\n");
+}
+
+// Keeps every lane's pitch results and the hop each one ended (counted from 1, as its lane's
+// metrics count it when the result arrives); each lane is written by one thread only.
+struct ReplayResults : AnalysisSink {
+    explicit ReplayResults(const TunerEngine& engine) : engine(engine) {}
+
+    const TunerEngine& engine;
+    std::vector<PitchResult> results[MAX_ENGINE_LANES];
+    std::vector<uint64_t> hops[MAX_ENGINE_LANES];
+
+    void onPitchResult(int lane, const PitchResult& result) override {
+        const LaneMetrics& metrics = engine.lane(lane).metrics();
+        results[lane].push_back(result);
+        hops[lane].push_back(metrics.analysis.count.load() + metrics.dutyCycledHops.load());
+    }
+    void onStrumResult(int, const StrumResult&) override {}
+    void onStrobeResult(int, const StrobeResult&) override {}
+};
+
+static double meanMicros(const LatencyHistogram& histogram) {
+    const uint64_t count = histogram.count.load();
+    return count > 0 ? histogram.totalNanos.load() / 1e3 / count : 0.0;
+}
+
+static double loadPercent(const LatencyHistogram& histogram) {
+    const uint64_t budget = histogram.totalBudgetNanos.load();
+    return budget > 0 ? 100.0 * histogram.totalNanos.load() / budget : 0.0;
+}
+
+int main(int argc, char** argv) {
+    bool realtime = false;
+    bool captureSettings = true;
+    bool dutyCycleOverridden = false;
+    DutyCyclePolicy dutyCycle;
+    AnalysisConfig overrides;
+    bool overridden[5] = {}; // window, hop, method, decimation, low window
+    float a4Frequency = 0.0f; // 0: as captured, or 440 Hz
+    std::vector<int> channels;
+    std::string inputPath;
+    std::string outputPath;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(arg, "--realtime") == 0) {
+            realtime = true;
+        } else if (std::strcmp(arg, "--duty-cycle") == 0) {
+            dutyCycle.enabled = true;
+            dutyCycleOverridden = true;
+        } else if (std::strcmp(arg, "--no-settings") == 0) {
+            captureSettings = false;
+        } else if (std::strcmp(arg, "--window") == 0 && hasValue) {
+            overrides.windowSize = std::atoi(argv[++i]);
+            overridden[0] = true;
+        } else if (std::strcmp(arg, "--hop") == 0 && hasValue) {
+            overrides.hopSize = std::atoi(argv[++i]);
+            overridden[1] = true;
+        } else if (std::strcmp(arg, "--method") == 0 && hasValue) {
+            std::string name = argv[++i];
+            if (name == "direct") overrides.method = DifferenceMethod::Direct;
+            else if (name == "fft") overrides.method = DifferenceMethod::Fft;
+            else if (name == "sliding") overrides.method = DifferenceMethod::Sliding;
+            else { printUsage(); return 2; }
+            overridden[2] = true;
+        } else if (std::strcmp(arg, "--decimate") == 0 && hasValue) {
+            overrides.lowRegisterDecimation = std::atoi(argv[++i]);
+            overridden[3] = true;
+        } else if (std::strcmp(arg, "--low-window") == 0 && hasValue) {
+            overrides.lowRegisterWindowSize = std::atoi(argv[++i]);
+            overridden[4] = true;
+        } else if (std::strcmp(arg, "--a4") == 0 && hasValue) {
+            a4Frequency = static_cast<float>(std::atof(argv[++i]));
+        } else if (std::strcmp(arg, "--channels") == 0 && hasValue) {
+            for (const char* p = argv[++i]; *p;) {
+                char* end = nullptr;
+                channels.push_back(static_cast<int>(std::strtol(p, &end, 10)));
+                if (end == p) { printUsage(); return 2; }
+                p = *end == ',' ? end + 1 : end;
+            }
+        } else if (arg[0] == '-') {
+            printUsage();
+            return 2;
+        } else if (inputPath.empty()) {
+            inputPath = arg;
+        } else if (outputPath.empty()) {
+            outputPath = arg;
+        } else {
+            printUsage();
+            return 2;
+        }
+    }
+    if (inputPath.empty() || channels.size() > static_cast<size_t>(MAX_ENGINE_LANES)) {
+        printUsage();
+        return 2;
+    }
+    CaptureReader capture;
+    if (!capture.open(inputPath.c_str())) return 1;
+    const CaptureHeader& header = capture.header();
+    for (int lane = 0; channels.empty() && lane < capture.laneCount(); ++lane) {
+        channels.push_back(capture.laneChannel(lane));
+    }
+    if (channels.empty()) channels.push_back(0);
+
+    EngineConfig engineConfig;
+    AnalysisConfig& config = engineConfig.analysis;
+    config = capture.analysisConfig();
+    if (overridden[0]) config.windowSize = overrides.windowSize;
+    if (overridden[1]) config.hopSize = overrides.hopSize;
+    if (overridden[2]) config.method = overrides.method;
+    if (overridden[3]) config.lowRegisterDecimation = overrides.lowRegisterDecimation;
+    if (overridden[4]) config.lowRegisterWindowSize = overrides.lowRegisterWindowSize;
+    engineConfig.channelCount = header.channelCount;
+    engineConfig.laneCount = static_cast<int>(channels.size());
+    std::copy(channels.begin(), channels.end(), engineConfig.laneChannels);
+    // Room for the largest captured callback on top of the device-sized ring the app uses
+    engineConfig.ringCapacity = std::max({4 * static_cast<size_t>(config.windowSize),
+                                          static_cast<size_t>(config.sampleRate / 2),
+                                          4 * static_cast<size_t>(capture.maxFrameCount())});
+    TunerEngine engine;
+    if (!engine.configure(engineConfig)) return 1;
+    // Captured settings, if used, are applied over these
+    engine.setA4(a4Frequency > 0.0f ? a4Frequency : 440.0f);
+    for (int lane = 0; lane < engine.laneCount(); ++lane) engine.setDutyCycle(lane, dutyCycle);
+
+    ReplayResults results(engine);
+    ReplayOptions options;
+    options.realtime = realtime;
+    options.captureSettings = captureSettings;
+    options.a4Override = a4Frequency;
+    options.dutyCycleOverride = dutyCycleOverridden ? &dutyCycle : nullptr;
+    ReplayStats stats;
+    bool replayed = false;
+    if (realtime) {
+        AnalysisWorkerPool pool(AnalysisWorkerPool::defaultThreadCount());
+        engine.start(pool, results);
+        replayed = replayCapture(capture, engine, options, &stats);
+        engine.stop(); // Whatever was still queued is left unanalysed, as when the app stops
+    } else {
+        options.inlineSink = &results;
+        replayed = replayCapture(capture, engine, options, &stats);
+    }
+    if (!replayed) return 1;
+
+    std::FILE* out = outputPath.empty() ? stdout : std::fopen(outputPath.c_str(), "w");
+    if (!out) {
+        std::fprintf(stderr, "cannot write %s\n", outputPath.c_str());
+        return 1;
+    }
+    // Window centres from the start of the captured stream (a wrapped capture holds only its end);
+    // backlogs skipped in --realtime runs shift later rows
+    const double firstFrame = capture.callbackCount() > 0 ? static_cast<double>(capture.callback(0).firstFrame) : 0.0;
+    std::fprintf(out, "lane,time_s,frequency_hz,note,octave,cents,confidence,rms\n");
+    for (int lane = 0; lane < engine.laneCount(); ++lane) {
+        for (size_t i = 0; i < results.results[lane].size(); ++i) {
+            const PitchResult& result = results.results[lane][i];
+            const double time = (firstFrame + static_cast<double>(results.hops[lane][i]) * config.hopSize -
+                                 config.windowSize / 2.0) / config.sampleRate;
+            if (result.noteIndex != NOTE_INDEX_NOT_AVAILABLE) {
+                std::fprintf(out, "%d,%.4f,%.3f,%s,%d,%.2f,%.3f,%.5f\n", lane, time, result.frequency,
+                             NOTE_NAMES[result.noteIndex], result.octave, result.centsOffset, result.confidence,
+                             result.rms);
+            } else {
+                std::fprintf(out, "%d,%.4f,0,,,,%.3f,%.5f\n", lane, time, result.confidence, result.rms);
+            }
+        }
+    }
+    if (out != stdout) std::fclose(out);
+
+    int minFrames = capture.maxFrameCount();
+    int32_t xRuns = 0;
+    for (size_t i = 0; i < capture.callbackCount(); ++i) {
+        minFrames = std::min(minFrames, capture.callback(i).frameCount);
+        xRuns = std::max(xRuns, capture.callback(i).xRunCount);
+    }
+    const EngineMetrics& metrics = engine.metrics();
+    std::fprintf(stderr, "%s: %d Hz, %d channel(s), %zu callbacks of %d..%d frames, %.1f s, %d xrun(s)",
+                 inputPath.c_str(), header.sampleRate, header.channelCount, stats.callbacks, minFrames,
+                 capture.maxFrameCount(), stats.capturedSeconds, xRuns);
+    if (header.rejectedCallbacks.load() > 0) {
+        std::fprintf(stderr, ", %llu callback(s) not captured",
+                     static_cast<unsigned long long>(header.rejectedCallbacks.load()));
+    }
+    if (captureSettings && capture.laneCount() > 0) {
+        std::fprintf(stderr, ", %zu settings change(s) applied", stats.settingsChanges);
+    }
+    std::fprintf(stderr, "\n  %s replay in %.2f s (%.0fx real time)  callbacks: mean %.1f us, max %.1f us, load %.3f%%\n",
+                 realtime ? "real-time" : "inline", stats.seconds,
+                 stats.seconds > 0.0 ? stats.capturedSeconds / stats.seconds : 0.0, meanMicros(metrics.callback),
+                 metrics.callback.maxNanos.load() / 1e3, loadPercent(metrics.callback));
+    for (int lane = 0; lane < engine.laneCount(); ++lane) {
+        const LaneMetrics& laneMetrics = engine.lane(lane).metrics();
+        std::fprintf(stderr, "  lane %d (channel %d): %zu windows, %llu with a pitch, %llu gated, %llu hop(s) not analysed, "
+                             "analysis mean %.1f us, max %.1f us, load %.2f%%, %llu backlog(s) skipped\n",
+                     lane, engineConfig.laneChannels[lane], results.results[lane].size(),
+                     static_cast<unsigned long long>(laneMetrics.detectedWindows.load()),
+                     static_cast<unsigned long long>(laneMetrics.gatedWindows.load()),
+                     static_cast<unsigned long long>(laneMetrics.dutyCycledHops.load()), meanMicros(laneMetrics.analysis), laneMetrics.analysis.maxNanos.load() / 1e3,
+                     loadPercent(laneMetrics.analysis),
+                     static_cast<unsigned long long>(laneMetrics.skippedBacklogs.load()));
+    }
+    const unsigned long long dropped = metrics.droppedInputFrames.load();
+    if (dropped > 0) std::fprintf(stderr, "  %llu input frame(s) dropped\n", dropped);
+    return 0;
+}
@@ -0,0 +1,186 @@
+// Offline pitch tracker: streams a WAV file through the same PitchAnalyzer the live engine uses
+// and writes one CSV row per analysed window.
+//
+//   afinador_wav_analyzer [--window N] [--hop N] [--method direct|fft|sliding] [--a4 HZ]
+//                         [--decimate M] [--low-window N] [--threads N] [--track FILE]
+//                         input.wav [output.csv]
+//
+// --threads loads the whole file and runs the batch tracker (PitchTrack.h) on N threads, 0 for
+// all cores, instead of streaming it; --track also writes its records as raw PitchTrackRecords.
+
+#include "PitchAnalyzer.h"
+#include "PitchTrack.h"
+#include "WavFile.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static const char* const NOTE_NAMES[12] = {"C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"};
+
+static void printUsage() {
+    std::fprintf(stderr,
+                 "usage: afinador_wav_analyzer [--window N] [--hop N] [--method direct|fft|sliding] [--a4 HZ]\n"
+                 "                             [--decimate M] [--low-window N] [--threads N] [--track FILE]\n"
+                 "                             input.wav [output.csv]\n");
+}
+
+// Batch mode: the whole file through computePitchTrack, then the same CSV rows.
+static int analyseBatch(const std::string& inputPath, std::FILE* out, const std::string& trackPath,
+                        PitchTrackConfig config) {
+    std::vector<float> samples;
+    std::string error;
+    if (!readWavFile(inputPath, samples, config.analysis.sampleRate, error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    std::vector<PitchTrackRecord> records(pitchTrackRecordCount(samples.size(), config.analysis));
+    PitchTrackStats stats;
+    if (!computePitchTrack(samples.data(), samples.size(), config, records.data(), &stats)) return 1;
+
+    int detected = 0;
+    for (const PitchTrackRecord& record : records) {
+        const double time = record.timeNanos / 1e9;
+        if (record.frequency > 0.0f) {
+            ++detected;
+            const DetectedNoteInfo note = getNoteInfoFromFrequency(record.frequency, config.a4Frequency);
+            std::fprintf(out, "%.4f,%.3f,%s,%d,%.2f,%.3f,%.5f\n", time, record.frequency,
+                         NOTE_NAMES[note.noteIndex], note.octave, record.centsOffset, record.confidence, record.rms);
+        } else {
+            std::fprintf(out, "%.4f,0,,,,%.3f,%.5f\n", time, record.confidence, record.rms);
+        }
+    }
+    if (!trackPath.empty()) {
+        std::FILE* track = std::fopen(trackPath.c_str(), "wb");
+        if (!track || std::fwrite(records.data(), sizeof(PitchTrackRecord), records.size(), track) != records.size()) {
+            std::fprintf(stderr, "cannot write %s\n", trackPath.c_str());
+            if (track) std::fclose(track);
+            return 1;
+        }
+        std::fclose(track);
+    }
+
+    const double audioSeconds = static_cast<double>(samples.size()) / config.analysis.sampleRate;
+    std::fprintf(stderr, "%s: %d Hz, %zu frames, %zu windows, %d with a pitch; %.2f s on %d threads (%.0fx real time, "
+                 "%d segments, %d stolen)\n", inputPath.c_str(), config.analysis.sampleRate, samples.size(),
+                 records.size(), detected, stats.seconds, stats.threads,
+                 stats.seconds > 0.0 ? audioSeconds / stats.seconds : 0.0, stats.segments, stats.stolenSegments);
+    return 0;
+}
+
+static bool parseMethod(const char* name, DifferenceMethod& method) {
+    if (std::strcmp(name, "direct") == 0) { method = DifferenceMethod::Direct; return true; }
+    if (std::strcmp(name, "fft") == 0) { method = DifferenceMethod::Fft; return true; }
+    if (std::strcmp(name, "sliding") == 0) { method = DifferenceMethod::Sliding; return true; }
+    return false;
+}
+
+int main(int argc, char** argv) {
+    AnalysisConfig config;
+    float a4Frequency = 440.0f;
+    int threadCount = -1; // -1: stream the file through one analyzer
+    std::string trackPath;
+    std::string inputPath;
+    std::string outputPath;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(arg, "--window") == 0 && hasValue) {
+            config.windowSize = std::atoi(argv[++i]);
+        } else if (std::strcmp(arg, "--hop") == 0 && hasValue) {
+            config.hopSize = std::atoi(argv[++i]);
+        } else if (std::strcmp(arg, "--method") == 0 && hasValue) {
+            if (!parseMethod(argv[++i], config.method)) { printUsage(); return 2; }
+        } else if (std::strcmp(arg, "--decimate") == 0 && hasValue) {
+            config.lowRegisterDecimation = std::atoi(argv[++i]);
+        } else if (std::strcmp(arg, "--low-window") == 0 && hasValue) {
+            config.lowRegisterWindowSize = std::atoi(argv[++i]);
+        } else if (std::strcmp(arg, "--a4") == 0 && hasValue) {
+            a4Frequency = static_cast<float>(std::atof(argv[++i]));
+        } else if (std::strcmp(arg, "--threads") == 0 && hasValue) {
+            threadCount = std::max(0, std::atoi(argv[++i]));
+        } else if (std::strcmp(arg, "--track") == 0 && hasValue) {
+            trackPath = argv[++i];
+        } else if (arg[0] == '-') {
+            printUsage();
+            return 2;
+        } else if (inputPath.empty()) {
+            inputPath = arg;
+        } else if (outputPath.empty()) {
+            outputPath = arg;
+        } else {
+            printUsage();
+            return 2;
+        }
+    }
+    if (inputPath.empty() || (!trackPath.empty() && threadCount < 0)) {
+        printUsage();
+        return 2;
+    }
+    if (threadCount >= 0) {
+        std::FILE* out = outputPath.empty() ? stdout : std::fopen(outputPath.c_str(), "w");
+        if (!out) {
+            std::fprintf(stderr, "cannot write %s\n", outputPath.c_str());
+            return 1;
+        }
+        std::fprintf(out, "time_s,frequency_hz,note,octave,cents,confidence,rms\n");
+        PitchTrackConfig trackConfig;
+        trackConfig.analysis = config;
+        trackConfig.a4Frequency = a4Frequency;
+        trackConfig.threadCount = threadCount;
+        const int status = analyseBatch(inputPath, out, trackPath, trackConfig);
+        if (out != stdout) std::fclose(out);
+        return status;
+    }
+
+    WavReader reader;
+    std::string error;
+    if (!reader.open(inputPath, error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    config.sampleRate = reader.sampleRate();
+    PitchAnalyzer analyzer;
+    if (!analyzer.configure(config)) return 1;
+
+    std::FILE* out = outputPath.empty() ? stdout : std::fopen(outputPath.c_str(), "w");
+    if (!out) {
+        std::fprintf(stderr, "cannot write %s\n", outputPath.c_str());
+        return 1;
+    }
+    std::fprintf(out, "time_s,frequency_hz,note,octave,cents,confidence,rms\n");
+
+    std::vector<float> hop(config.hopSize);
+    PitchResult result;
+    int64_t consumed = 0;
+    int windows = 0;
+    int detected = 0;
+    for (;;) {
+        int n = reader.read(hop.data(), config.hopSize);
+        if (n <= 0) break;
+        // Zero-pad the final partial hop so the tail of the file is still analysed once
+        std::fill(hop.begin() + n, hop.end(), 0.0f);
+        consumed += n;
+        if (!analyzer.processHop(hop.data(), a4Frequency, result)) continue;
+
+        ++windows;
+        // Timestamp at the centre of the analysed window
+        double time = (static_cast<double>(consumed) - config.windowSize / 2.0) / config.sampleRate;
+        if (result.noteIndex != NOTE_INDEX_NOT_AVAILABLE) {
+            ++detected;
+            std::fprintf(out, "%.4f,%.3f,%s,%d,%.2f,%.3f,%.5f\n", time, result.frequency,
+                         NOTE_NAMES[result.noteIndex], result.octave, result.centsOffset,
+                         result.confidence, result.rms);
+        } else {
+            std::fprintf(out, "%.4f,0,,,,%.3f,%.5f\n", time, result.confidence, result.rms);
+        }
+    }
+    if (out != stdout) std::fclose(out);
+
+    std::fprintf(stderr, "%s: %d Hz, %lld frames, %d windows, %d with a pitch\n", inputPath.c_str(),
+                 config.sampleRate, static_cast<long long>(consumed), windows, detected);
+    return 0;
+}
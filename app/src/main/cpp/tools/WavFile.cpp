@@ -0,0 +1,148 @@
+#include "WavFile.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+uint32_t readLe32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+uint16_t readLe16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+constexpr uint16_t WAVE_FORMAT_PCM = 1;
+constexpr uint16_t WAVE_FORMAT_IEEE_FLOAT = 3;
+constexpr uint16_t WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+
+} // namespace
+
+WavReader::~WavReader() {
+    close();
+}
+
+void WavReader::close() {
+    if (file_) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+bool WavReader::open(const std::string& path, std::string& error) {
+    close();
+    file_ = std::fopen(path.c_str(), "rb");
+    if (!file_) {
+        error = "cannot open " + path;
+        return false;
+    }
+    uint8_t riff[12];
+    if (std::fread(riff, 1, sizeof(riff), file_) != sizeof(riff) ||
+        std::memcmp(riff, "RIFF", 4) != 0 || std::memcmp(riff + 8, "WAVE", 4) != 0) {
+        error = path + " is not a RIFF/WAVE file";
+        close();
+        return false;
+    }
+
+    bool haveFormat = false;
+    uint16_t format = 0;
+    for (;;) {
+        uint8_t chunkHeader[8];
+        if (std::fread(chunkHeader, 1, sizeof(chunkHeader), file_) != sizeof(chunkHeader)) {
+            error = path + " has no data chunk";
+            close();
+            return false;
+        }
+        uint32_t chunkSize = readLe32(chunkHeader + 4);
+        if (std::memcmp(chunkHeader, "fmt ", 4) == 0) {
+            std::vector<uint8_t> fmt(chunkSize);
+            if (chunkSize < 16 || std::fread(fmt.data(), 1, chunkSize, file_) != chunkSize) {
+                error = path + " has a truncated fmt chunk";
+                close();
+                return false;
+            }
+            format = readLe16(fmt.data());
+            channels_ = readLe16(fmt.data() + 2);
+            sampleRate_ = static_cast<int>(readLe32(fmt.data() + 4));
+            bitsPerSample_ = readLe16(fmt.data() + 14);
+            if (format == WAVE_FORMAT_EXTENSIBLE && chunkSize >= 26) {
+                format = readLe16(fmt.data() + 24); // First two bytes of the sub-format GUID
+            }
+            haveFormat = true;
+            if (chunkSize & 1) std::fseek(file_, 1, SEEK_CUR);
+        } else if (std::memcmp(chunkHeader, "data", 4) == 0) {
+            if (!haveFormat) {
+                error = path + " has data before fmt";
+                close();
+                return false;
+            }
+            int bytesPerFrame = channels_ * (bitsPerSample_ / 8);
+            frameCount_ = bytesPerFrame > 0 ? chunkSize / bytesPerFrame : 0;
+            framesRemaining_ = frameCount_;
+            break;
+        } else {
+            std::fseek(file_, chunkSize + (chunkSize & 1), SEEK_CUR); // Skip unknown chunks
+        }
+    }
+
+    isFloat_ = format == WAVE_FORMAT_IEEE_FLOAT;
+    bool supported = channels_ > 0 && sampleRate_ > 0 &&
+                     ((format == WAVE_FORMAT_PCM && (bitsPerSample_ == 16 || bitsPerSample_ == 24 || bitsPerSample_ == 32)) ||
+                      (isFloat_ && bitsPerSample_ == 32));
+    if (!supported) {
+        error = path + ": unsupported WAV format (" + std::to_string(format) + ", " +
+                std::to_string(bitsPerSample_) + " bit)";
+        close();
+        return false;
+    }
+    return true;
+}
+
+int WavReader::read(float* output, int frames) {
+    if (!file_ || frames <= 0 || framesRemaining_ <= 0) return 0;
+    const int bytesPerSample = bitsPerSample_ / 8;
+    const int bytesPerFrame = bytesPerSample * channels_;
+    int toRead = static_cast<int>(std::min<int64_t>(frames, framesRemaining_));
+    raw_.resize(static_cast<size_t>(toRead) * bytesPerFrame);
+    int framesRead = static_cast<int>(std::fread(raw_.data(), bytesPerFrame, toRead, file_));
+    framesRemaining_ -= framesRead;
+
+    const float channelScale = 1.0f / static_cast<float>(channels_);
+    for (int i = 0; i < framesRead; ++i) {
+        float sum = 0.0f;
+        for (int c = 0; c < channels_; ++c) {
+            const uint8_t* p = raw_.data() + static_cast<size_t>(i) * bytesPerFrame + c * bytesPerSample;
+            float value = 0.0f;
+            if (isFloat_) {
+                uint32_t bits = readLe32(p);
+                std::memcpy(&value, &bits, sizeof(value));
+            } else if (bitsPerSample_ == 16) {
+                value = static_cast<int16_t>(readLe16(p)) / 32768.0f;
+            } else if (bitsPerSample_ == 24) {
+                int32_t v = static_cast<int32_t>((p[0] << 8) | (p[1] << 16) | (static_cast<uint32_t>(p[2]) << 24)) >> 8;
+                value = v / 8388608.0f;
+            } else {
+                value = static_cast<int32_t>(readLe32(p)) / 2147483648.0f;
+            }
+            sum += value;
+        }
+        output[i] = sum * channelScale;
+    }
+    return framesRead;
+}
+
+bool readWavFile(const std::string& path, std::vector<float>& samples, int& sampleRate, std::string& error) {
+    WavReader reader;
+    if (!reader.open(path, error)) return false;
+    sampleRate = reader.sampleRate();
+    samples.resize(static_cast<size_t>(reader.frameCount()));
+    int64_t total = 0;
+    while (total < reader.frameCount()) {
+        int n = reader.read(samples.data() + total, static_cast<int>(std::min<int64_t>(65536, reader.frameCount() - total)));
+        if (n <= 0) break;
+        total += n;
+    }
+    samples.resize(static_cast<size_t>(total));
+    return true;
+}
@@ -0,0 +1,43 @@
+#ifndef AFINADOR_WAV_FILE_H
+#define AFINADOR_WAV_FILE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// --- Streaming WAV Reader (host tools only) ---
+// Supports PCM 16/24/32-bit and IEEE float 32-bit files. Multi-channel input is mixed down to mono.
+class WavReader {
+public:
+    WavReader() = default;
+    ~WavReader();
+    WavReader(const WavReader&) = delete;
+    WavReader& operator=(const WavReader&) = delete;
+
+    // Returns false and fills 'error' if the file cannot be opened or is not a supported WAV.
+    bool open(const std::string& path, std::string& error);
+    void close();
+
+    int sampleRate() const { return sampleRate_; }
+    int channelCount() const { return channels_; }
+    int64_t frameCount() const { return frameCount_; }
+
+    // Reads up to 'frames' mono frames into 'output'. Returns the number read (0 at the end).
+    int read(float* output, int frames);
+
+private:
+    std::FILE* file_ = nullptr;
+    int sampleRate_ = 0;
+    int channels_ = 0;
+    int bitsPerSample_ = 0;
+    bool isFloat_ = false;
+    int64_t frameCount_ = 0;
+    int64_t framesRemaining_ = 0;
+    std::vector<uint8_t> raw_;
+};
+
+// Reads a whole file into memory as mono samples.
+bool readWavFile(const std::string& path, std::vector<float>& samples, int& sampleRate, std::string& error);
+
+#endif // AFINADOR_WAV_FILE_H
@@ -0,0 +1,96 @@
+package com.isaacbegue.afinador.analysis
+
+import android.util.Log
+import java.io.File
+import java.io.RandomAccessFile
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+import java.nio.channels.FileChannel
+
+// --- Constants ---
+// Same detector as the live tuner, with a coarser hop: ~5.8 ms between records at 44.1 kHz
+private const val TRACK_WINDOW_SIZE = 2048
+private const val TRACK_HOP_SIZE = 256
+private const val TRACK_LOW_REGISTER_DECIMATION = 8
+private const val TRACK_LOW_REGISTER_WINDOW_SIZE = 1024
+private const val DIFFERENCE_METHOD_SLIDING = 2 // Must match DifferenceMethod in YinDetector.h
+private const val ALL_CORES = 0
+// PitchTrackRecord layout in native byte order (must match PitchTrack.h)
+private const val PITCH_TRACK_RECORD_SIZE = 24
+private const val PITCH_TRACK_OFFSET_TIME = 0
+private const val PITCH_TRACK_OFFSET_FREQUENCY = 8
+private const val PITCH_TRACK_OFFSET_CENTS = 12
+private const val PITCH_TRACK_OFFSET_CONFIDENCE = 16
+private const val PITCH_TRACK_OFFSET_RMS = 20
+private const val CENTS_NOT_AVAILABLE = -1000.0f // Must match NoteMapping.h
+private const val BYTES_PER_SAMPLE = 4
+
+// Pitch track of a recorded take, one record per analysed window, read in place from the direct
+// buffer the native tracker filled.
+class PitchTrack internal constructor(private val records: ByteBuffer, val size: Int) {
+    // Centre of the window, from the start of the take
+    fun timeNanos(index: Int): Long = records.getLong(offset(index) + PITCH_TRACK_OFFSET_TIME)
+    // Hz, 0 when the window had no clear pitch
+    fun frequency(index: Int): Float = records.getFloat(offset(index) + PITCH_TRACK_OFFSET_FREQUENCY)
+    // Versus the closest chromatic note, null without a pitch
+    fun centsOffset(index: Int): Float? =
+        records.getFloat(offset(index) + PITCH_TRACK_OFFSET_CENTS).takeIf { it != CENTS_NOT_AVAILABLE }
+    fun confidence(index: Int): Float = records.getFloat(offset(index) + PITCH_TRACK_OFFSET_CONFIDENCE)
+    fun rms(index: Int): Float = records.getFloat(offset(index) + PITCH_TRACK_OFFSET_RMS)
+
+    private fun offset(index: Int): Int {
+        if (index !in 0 until size) throw IndexOutOfBoundsException("Record $index of $size")
+        return index * PITCH_TRACK_RECORD_SIZE
+    }
+}
+
+// Intonation analysis of recorded takes: the live detector run over a whole take on every core,
+// minutes of audio in seconds. Blocking; call it off the main thread.
+object PitchTracker {
+    init {
+        System.loadLibrary("afinador_native")
+    }
+
+    // pcm: direct buffer of mono floats in native byte order, analysed whole (position and limit
+    // are ignored). Null if the buffer or the parameters were rejected.
+    fun analyse(pcm: ByteBuffer, sampleRate: Int, a4Frequency: Float = 440.0f): PitchTrack? {
+        require(pcm.isDirect) { "PCM must be a direct buffer" }
+        val sampleCount = pcm.capacity().toLong() / BYTES_PER_SAMPLE
+        val recordCount = pitchTrackRecordCountNative(sampleCount, TRACK_WINDOW_SIZE, TRACK_HOP_SIZE)
+        if (recordCount * PITCH_TRACK_RECORD_SIZE > Int.MAX_VALUE) {
+            Log.e("PitchTracker", "Take too long for one track: $sampleCount samples")
+            return null
+        }
+        val records = ByteBuffer.allocateDirect((recordCount * PITCH_TRACK_RECORD_SIZE).toInt())
+            .order(ByteOrder.nativeOrder())
+        val written = computePitchTrackNative(
+            pcm, sampleCount, sampleRate, DIFFERENCE_METHOD_SLIDING, TRACK_WINDOW_SIZE, TRACK_HOP_SIZE,
+            TRACK_LOW_REGISTER_DECIMATION, TRACK_LOW_REGISTER_WINDOW_SIZE, a4Frequency, ALL_CORES, records
+        )
+        if (written < 0) return null
+        return PitchTrack(records, written.toInt())
+    }
+
+    // Raw mono float PCM file in native byte order, memory-mapped rather than read into the heap.
+    fun analyseFile(file: File, sampleRate: Int, a4Frequency: Float = 440.0f): PitchTrack? =
+        RandomAccessFile(file, "r").use { raf ->
+            val pcm = raf.channel.map(FileChannel.MapMode.READ_ONLY, 0, raf.length()).order(ByteOrder.nativeOrder())
+            analyse(pcm, sampleRate, a4Frequency) // The mapping outlives the channel
+        }
+
+    // --- JNI Declarations ---
+    private external fun pitchTrackRecordCountNative(sampleCount: Long, windowSize: Int, hopSize: Int): Long
+    private external fun computePitchTrackNative(
+        pcm: ByteBuffer,
+        sampleCount: Long,
+        sampleRate: Int,
+        differenceMethod: Int,
+        windowSize: Int,
+        hopSize: Int,
+        lowRegisterDecimation: Int,
+        lowRegisterWindowSize: Int,
+        a4Frequency: Float,
+        threadCount: Int,
+        output: ByteBuffer
+    ): Long
+}
@@ -0,0 +1,91 @@
+package com.isaacbegue.afinador.ui.composables
+
+import androidx.compose.foundation.layout.Column
+import androidx.compose.foundation.layout.padding
+import androidx.compose.material3.MaterialTheme
+import androidx.compose.material3.Surface
+import androidx.compose.material3.Text
+import androidx.compose.runtime.Composable
+import androidx.compose.runtime.LaunchedEffect
+import androidx.compose.runtime.getValue
+import androidx.compose.runtime.mutableStateOf
+import androidx.compose.runtime.remember
+import androidx.compose.runtime.setValue
+import androidx.compose.ui.Modifier
+import androidx.compose.ui.text.font.FontFamily
+import androidx.compose.ui.unit.dp
+import androidx.compose.ui.unit.sp
+import com.isaacbegue.afinador.viewmodel.EngineMetrics
+import com.isaacbegue.afinador.viewmodel.LatencyStats
+import kotlinx.coroutines.delay
+import java.util.Locale
+
+private const val METRICS_REFRESH_MS = 500L
+
+// Hidden diagnostics panel (long press on the title): stream parameters negotiated by the device,
+// callback/analysis timing against their deadlines, and the window counters.
+@Composable
+fun EngineMetricsOverlay(
+    readMetrics: () -> EngineMetrics?,
+    modifier: Modifier = Modifier
+) {
+    var metrics by remember { mutableStateOf<EngineMetrics?>(null) }
+    LaunchedEffect(Unit) {
+        while (true) {
+            metrics = readMetrics()
+            delay(METRICS_REFRESH_MS)
+        }
+    }
+
+    Surface(
+        modifier = modifier,
+        color = MaterialTheme.colorScheme.surfaceVariant.copy(alpha = 0.9f),
+        shape = MaterialTheme.shapes.small
+    ) {
+        Column(modifier = Modifier.padding(8.dp)) {
+            val current = metrics
+            if (current == null) {
+                MetricsLine("no engine metrics")
+                return@Column
+            }
+            MetricsLine(
+                "${current.sampleRate} Hz  ${if (current.isAAudio) "AAudio" else "OpenSL ES"}  " +
+                        if (current.isSharedStream) "shared" else "exclusive"
+            )
+            MetricsLine(
+                "burst ${current.framesPerBurst}  cb ${current.framesPerCallback.takeIf { it > 0 } ?: "var"}  " +
+                        "buffer ${current.bufferSizeFrames}"
+            )
+            MetricsLine(
+                "xruns ${current.xRunCount.takeIf { it >= 0 } ?: "n/a"}  dropped ${current.droppedInputFrames}  " +
+                        "behind ${current.skippedBacklogs}"
+            )
+            MetricsLine(latencyLine("callback", current.callback))
+            MetricsLine(latencyLine("analysis", current.analysis))
+            MetricsLine(
+                "windows: detected ${current.detectedWindows} (local ${current.localSearchWindows})  " +
+                        "rejected ${current.rejectedWindows}  aperiodic ${current.aperiodicWindows}  " +
+                        "gated ${current.gatedWindows}"
+            )
+            MetricsLine(
+                String.format(
+                    Locale.US, "duty cycle: %s %.0f/%.0f Hz (avg %.0f)  skipped %d  saved %.0f ms",
+                    current.schedulerState.name.lowercase(Locale.US), current.analysisRateHz,
+                    current.fullAnalysisRateHz, current.averageAnalysisRateHz, current.dutyCycledHops,
+                    current.cpuSavedMillis
+                )
+            )
+        }
+    }
+}
+
+private fun latencyLine(label: String, stats: LatencyStats): String = String.format(
+    Locale.US, "%s: mean %.0f us  p99 <%d us  max %.0f us  load %.1f%% (peak %.0f%%)",
+    label, stats.meanMicros, stats.percentileMicros(0.99f), stats.maxMicros,
+    stats.load * 100f, stats.peakLoad * 100f
+)
+
+@Composable
+private fun MetricsLine(text: String) {
+    Text(text = text, fontFamily = FontFamily.Monospace, fontSize = 10.sp, lineHeight = 12.sp)
+}
@@ -0,0 +1,124 @@
+package com.isaacbegue.afinador.ui.composables
+
+import androidx.compose.foundation.Canvas
+import androidx.compose.foundation.layout.Arrangement
+import androidx.compose.foundation.layout.Column
+import androidx.compose.foundation.layout.fillMaxWidth
+import androidx.compose.foundation.layout.padding
+import androidx.compose.material3.MaterialTheme
+import androidx.compose.material3.Surface
+import androidx.compose.material3.Text
+import androidx.compose.runtime.Composable
+import androidx.compose.runtime.LaunchedEffect
+import androidx.compose.runtime.getValue
+import androidx.compose.runtime.mutableFloatStateOf
+import androidx.compose.runtime.remember
+import androidx.compose.runtime.setValue
+import androidx.compose.runtime.withFrameNanos
+import androidx.compose.ui.Alignment
+import androidx.compose.ui.Modifier
+import androidx.compose.ui.geometry.Offset
+import androidx.compose.ui.geometry.Size
+import androidx.compose.ui.graphics.drawscope.clipRect
+import androidx.compose.ui.text.font.FontWeight
+import androidx.compose.ui.text.style.TextAlign
+import androidx.compose.ui.tooling.preview.Preview
+import androidx.compose.ui.unit.dp
+import androidx.compose.ui.unit.sp
+import com.isaacbegue.afinador.model.Pitch
+import com.isaacbegue.afinador.ui.theme.AfinadorTheme
+import com.isaacbegue.afinador.ui.theme.TunerGreen
+import com.isaacbegue.afinador.ui.theme.TunerRed
+import com.isaacbegue.afinador.ui.theme.TunerYellow
+import com.isaacbegue.afinador.viewmodel.StrobeReading
+import java.util.Locale
+import kotlin.math.PI
+import kotlin.math.abs
+
+// Umbrales del estroboscopio (más finos que NoteIndicators)
+private const val STROBE_CENTS_CLOSE_THRESHOLD = 5.0f
+private const val STROBE_STRIPES = 6 // Franjas de la banda fundamental; la banda h tiene h veces más
+private const val STROBE_MAX_EXTRAPOLATION_NANOS = 200_000_000L // Sin lecturas nuevas, la banda se detiene
+
+// Modo estroboscopio: bandas que giran a la velocidad de fase medida (quietas = afinado) y la
+// desviación con décimas de cent.
+@Composable
+fun StrobeDisplay(
+    target: Pitch,
+    reading: StrobeReading?,
+    modifier: Modifier = Modifier
+) {
+    val cents = reading?.centsOffset
+    val color = when {
+        cents == null -> MaterialTheme.colorScheme.onSurface.copy(alpha = 0.4f)
+        reading?.isTuned == true -> TunerGreen
+        abs(cents) < STROBE_CENTS_CLOSE_THRESHOLD -> TunerYellow
+        else -> TunerRed
+    }
+
+    // Posición de la banda en cada fotograma: fase publicada + velocidad x tiempo transcurrido
+    var phase by remember { mutableFloatStateOf(0f) }
+    LaunchedEffect(reading) {
+        if (reading == null) return@LaunchedEffect
+        while (true) {
+            withFrameNanos { frameNanos ->
+                val elapsed = (frameNanos - reading.timestampNanos).coerceIn(0L, STROBE_MAX_EXTRAPOLATION_NANOS)
+                phase = reading.phase + reading.phaseVelocity * elapsed / 1e9f
+            }
+        }
+    }
+
+    Column(
+        modifier = modifier.fillMaxWidth(),
+        horizontalAlignment = Alignment.CenterHorizontally,
+        verticalArrangement = Arrangement.spacedBy(12.dp)
+    ) {
+        Text(text = target.toString(), fontSize = 48.sp, fontWeight = FontWeight.Bold, color = color)
+        Text(
+            text = cents?.let { String.format(Locale.US, "%+.1f ¢", it) } ?: "Toca la nota $target",
+            fontSize = if (cents != null) 32.sp else 18.sp,
+            color = color,
+            textAlign = TextAlign.Center
+        )
+        val levels = reading?.bandLevels.orEmpty()
+        val stripeColor = if (reading?.isLocked == true) color else MaterialTheme.colorScheme.onSurface.copy(alpha = 0.2f)
+        Canvas(modifier = Modifier.fillMaxWidth().weight(1f).padding(vertical = 8.dp)) {
+            val bands = maxOf(levels.size, 1)
+            val bandHeight = size.height / bands
+            for (band in 0 until bands) {
+                val harmonic = band + 1
+                val stripeWidth = size.width / (2 * STROBE_STRIPES * harmonic)
+                // La banda h gira h veces más rápido pero con franjas h veces más estrechas
+                val shift = ((phase * harmonic / (2 * PI).toFloat()) % 1f) * 2 * stripeWidth
+                val alpha = (levels.getOrNull(band) ?: 0f).coerceIn(0.15f, 1f)
+                val top = band * bandHeight
+                clipRect(top = top, bottom = top + bandHeight * 0.9f) {
+                    var x = shift - 2 * stripeWidth
+                    while (x < size.width) {
+                        drawRect(
+                            color = stripeColor.copy(alpha = stripeColor.alpha * alpha),
+                            topLeft = Offset(x, top),
+                            size = Size(stripeWidth, bandHeight * 0.9f)
+                        )
+                        x += 2 * stripeWidth
+                    }
+                }
+            }
+        }
+    }
+}
+
+@Preview(showBackground = true, name = "Estroboscopio")
+@Composable
+private fun Preview_StrobeDisplay() {
+    AfinadorTheme { Surface(color = MaterialTheme.colorScheme.background) {
+        StrobeDisplay(
+            target = Pitch("A", 2),
+            reading = StrobeReading(
+                isLocked = true, centsOffset = -0.4f, phase = 1.2f, phaseVelocity = -0.16f,
+                timestampNanos = 0L, bandLevels = listOf(0.8f, 0.45f, 0.3f, 0.15f), isTuned = true
+            ),
+            modifier = Modifier.padding(16.dp)
+        )
+    }}
+}
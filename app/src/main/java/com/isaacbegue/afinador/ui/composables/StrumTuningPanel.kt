@@ -0,0 +1,133 @@
+package com.isaacbegue.afinador.ui.composables
+
+import androidx.compose.foundation.background
+import androidx.compose.foundation.layout.Arrangement
+import androidx.compose.foundation.layout.Box
+import androidx.compose.foundation.layout.Column
+import androidx.compose.foundation.layout.Row
+import androidx.compose.foundation.layout.fillMaxHeight
+import androidx.compose.foundation.layout.fillMaxWidth
+import androidx.compose.foundation.layout.height
+import androidx.compose.foundation.layout.padding
+import androidx.compose.foundation.layout.width
+import androidx.compose.foundation.shape.CircleShape
+import androidx.compose.material3.MaterialTheme
+import androidx.compose.material3.Surface
+import androidx.compose.material3.Text
+import androidx.compose.runtime.Composable
+import androidx.compose.ui.Alignment
+import androidx.compose.ui.BiasAlignment
+import androidx.compose.ui.Modifier
+import androidx.compose.ui.draw.clip
+import androidx.compose.ui.graphics.Color
+import androidx.compose.ui.text.font.FontWeight
+import androidx.compose.ui.text.style.TextAlign
+import androidx.compose.ui.tooling.preview.Preview
+import androidx.compose.ui.unit.dp
+import androidx.compose.ui.unit.sp
+import com.isaacbegue.afinador.model.Tunings
+import com.isaacbegue.afinador.ui.theme.AfinadorTheme
+import com.isaacbegue.afinador.ui.theme.TunerGreen
+import com.isaacbegue.afinador.ui.theme.TunerRed
+import com.isaacbegue.afinador.ui.theme.TunerYellow
+import com.isaacbegue.afinador.viewmodel.StringTuning
+import java.util.Locale
+import kotlin.math.abs
+
+// Umbrales (mismos que NoteIndicators)
+private const val CENTS_CLOSE_THRESHOLD = 25.0f
+private const val CENTS_RANGE_FOR_BAR = 50.0f
+
+// Modo rasgueo: una fila por cuerda con su desviación respecto a la afinación objetivo.
+@Composable
+fun StrumTuningPanel(
+    strings: List<StringTuning>,
+    modifier: Modifier = Modifier
+) {
+    Column(
+        modifier = modifier.fillMaxWidth(),
+        verticalArrangement = Arrangement.spacedBy(10.dp)
+    ) {
+        Text(
+            text = "Rasguea todas las cuerdas al aire",
+            style = MaterialTheme.typography.bodyMedium,
+            color = MaterialTheme.colorScheme.onSurface.copy(alpha = 0.7f),
+            textAlign = TextAlign.Center,
+            modifier = Modifier.fillMaxWidth()
+        )
+        // Cuerda más aguda arriba, como se ve la guitarra al mirar hacia abajo
+        strings.asReversed().forEach { string -> StringRow(string) }
+    }
+}
+
+@Composable
+private fun StringRow(string: StringTuning) {
+    val cents = string.centsOffset
+    val color = when {
+        cents == null -> MaterialTheme.colorScheme.onSurface.copy(alpha = 0.4f)
+        string.isTuned -> TunerGreen
+        abs(cents) < CENTS_CLOSE_THRESHOLD -> TunerYellow
+        else -> TunerRed
+    }
+    Row(
+        modifier = Modifier.fillMaxWidth().height(36.dp),
+        verticalAlignment = Alignment.CenterVertically
+    ) {
+        Text(
+            text = string.pitch.toString(),
+            fontSize = 20.sp,
+            fontWeight = FontWeight.Bold,
+            color = color,
+            modifier = Modifier.width(56.dp)
+        )
+        CentsBar(cents = cents, color = color, modifier = Modifier.weight(1f).fillMaxHeight())
+        Text(
+            text = cents?.let { String.format(Locale.US, "%+.0f ¢", it) + if (string.isShared) "~" else "" } ?: "--",
+            fontSize = 16.sp,
+            color = color,
+            textAlign = TextAlign.End,
+            modifier = Modifier.width(72.dp)
+        )
+    }
+}
+
+// Barra de +/- CENTS_RANGE_FOR_BAR cents con el centro marcado
+@Composable
+private fun CentsBar(cents: Float?, color: Color, modifier: Modifier = Modifier) {
+    Box(modifier = modifier.padding(horizontal = 8.dp, vertical = 14.dp)) {
+        Box(
+            modifier = Modifier.fillMaxWidth().fillMaxHeight().clip(CircleShape)
+                .background(MaterialTheme.colorScheme.onSurface.copy(alpha = 0.1f))
+        )
+        Box(
+            modifier = Modifier.align(Alignment.Center).width(2.dp).fillMaxHeight()
+                .background(MaterialTheme.colorScheme.onSurface.copy(alpha = 0.5f))
+        )
+        if (cents != null) {
+            val position = (cents / CENTS_RANGE_FOR_BAR).coerceIn(-1f, 1f) // -1 (izquierda) .. 1 (derecha)
+            Box(
+                modifier = Modifier.align(BiasAlignment(horizontalBias = position, verticalBias = 0f)).width(8.dp).fillMaxHeight()
+                    .clip(CircleShape).background(color)
+            )
+        }
+    }
+}
+
+@Preview(showBackground = true, name = "Rasgueo - Guitarra")
+@Composable
+private fun Preview_StrumTuningPanel() {
+    AfinadorTheme { Surface(color = MaterialTheme.colorScheme.background) {
+        val pitches = Tunings.GUITAR_STANDARD.pitches
+        StrumTuningPanel(
+            strings = listOf(
+                StringTuning(pitches[0], centsOffset = -3.2f, isTuned = true),
+                StringTuning(pitches[1], centsOffset = 14.5f),
+                StringTuning(pitches[2], centsOffset = -31.0f),
+                StringTuning(pitches[3]),
+                StringTuning(pitches[4], centsOffset = 6.1f, isTuned = true),
+                StringTuning(pitches[5], centsOffset = -8.8f, isTuned = true, isShared = true)
+            ),
+            modifier = Modifier.padding(16.dp)
+        )
+    }}
+}
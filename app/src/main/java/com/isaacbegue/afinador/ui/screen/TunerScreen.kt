@@ -1,6 +1,7 @@
 package com.isaacbegue.afinador.ui.screen
 
 import android.Manifest
+import androidx.compose.foundation.gestures.detectTapGestures
 import androidx.compose.foundation.layout.*
 import androidx.compose.material.icons.Icons
 import androidx.compose.material.icons.filled.Settings
@@ -8,6 +9,7 @@ import androidx.compose.material3.*
 import androidx.compose.runtime.*
 import androidx.compose.ui.Alignment
 import androidx.compose.ui.Modifier
+import androidx.compose.ui.input.pointer.pointerInput
 import androidx.compose.ui.text.style.TextAlign
 import androidx.compose.ui.tooling.preview.Preview
 import androidx.compose.ui.unit.dp
@@ -22,7 +24,10 @@ import com.isaacbegue.afinador.model.CHROMATIC_MODE_NAME // <- Import actualizad
 import com.isaacbegue.afinador.model.Pitch
 import com.isaacbegue.afinador.model.FREE_SINGING_MODE_NAME // <- Import actualizado
 import com.isaacbegue.afinador.model.Tunings
+import com.isaacbegue.afinador.ui.composables.EngineMetricsOverlay
 import com.isaacbegue.afinador.ui.composables.NoteIndicators
+import com.isaacbegue.afinador.ui.composables.StrobeDisplay
+import com.isaacbegue.afinador.ui.composables.StrumTuningPanel
 import com.isaacbegue.afinador.ui.composables.TargetNoteSelector
 import com.isaacbegue.afinador.ui.composables.TuningVisualizer
 import com.isaacbegue.afinador.ui.theme.AfinadorTheme
@@ -41,6 +46,7 @@ fun TunerScreen(
     )
     val uiState by tunerViewModel.uiState.collectAsStateWithLifecycle()
     var showSettingsScreen by remember { mutableStateOf(false) }
+    var showEngineMetrics by remember { mutableStateOf(false) } // Hidden: long press on the title
 
     LaunchedEffect(audioPermissionState.status) {
         tunerViewModel.updatePermissionStatus(audioPermissionState.status == PermissionStatus.Granted)
@@ -50,7 +56,14 @@ fun TunerScreen(
         modifier = modifier,
         topBar = {
             TopAppBar(
-                title = { Text("Afinador") },
+                title = {
+                    Text(
+                        "Afinador",
+                        modifier = Modifier.pointerInput(Unit) {
+                            detectTapGestures(onLongPress = { showEngineMetrics = !showEngineMetrics })
+                        }
+                    )
+                },
                 colors = TopAppBarDefaults.topAppBarColors(
                     containerColor = MaterialTheme.colorScheme.surface,
                     titleContentColor = MaterialTheme.colorScheme.onSurface,
@@ -71,13 +84,23 @@ fun TunerScreen(
                 onNavigateBack = { showSettingsScreen = false }
             )
         } else {
-            TunerScreenContent(
-                modifier = Modifier.fillMaxSize().padding(paddingValues).padding(horizontal = 16.dp, vertical = 8.dp),
-                uiState = uiState,
-                onTuningModeSelected = tunerViewModel::selectTuningMode,
-                onTargetPitchSelected = tunerViewModel::setTargetPitch,
-                audioPermissionState = audioPermissionState
-            )
+            Box(modifier = Modifier.fillMaxSize().padding(paddingValues)) {
+                TunerScreenContent(
+                    modifier = Modifier.fillMaxSize().padding(horizontal = 16.dp, vertical = 8.dp),
+                    uiState = uiState,
+                    onTuningModeSelected = tunerViewModel::selectTuningMode,
+                    onTargetPitchSelected = tunerViewModel::setTargetPitch,
+                    onStrumModeToggled = tunerViewModel::toggleStrumMode,
+                    onStrobeModeToggled = tunerViewModel::toggleStrobeMode,
+                    audioPermissionState = audioPermissionState
+                )
+                if (showEngineMetrics) {
+                    EngineMetricsOverlay(
+                        readMetrics = tunerViewModel::readEngineMetrics,
+                        modifier = Modifier.align(Alignment.BottomCenter).padding(8.dp)
+                    )
+                }
+            }
         }
     }
 }
@@ -89,6 +112,8 @@ private fun TunerScreenContent(
     uiState: TunerUiState,
     onTuningModeSelected: (String) -> Unit,
     onTargetPitchSelected: (Pitch?) -> Unit,
+    onStrumModeToggled: () -> Unit = {},
+    onStrobeModeToggled: () -> Unit = {},
     audioPermissionState: PermissionState
 ) {
     Column(
@@ -104,8 +129,44 @@ private fun TunerScreenContent(
                     onTargetPitchSelected = onTargetPitchSelected
                 )
 
+                val isInstrumentMode = uiState.selectedTuningModeName != CHROMATIC_MODE_NAME &&
+                        uiState.selectedTuningModeName != FREE_SINGING_MODE_NAME
+                if (isInstrumentMode) {
+                    Row(
+                        modifier = Modifier.fillMaxWidth(),
+                        verticalAlignment = Alignment.CenterVertically,
+                        horizontalArrangement = Arrangement.End
+                    ) {
+                        Text("Rasgueo (todas las cuerdas)", style = MaterialTheme.typography.bodyMedium)
+                        Spacer(modifier = Modifier.width(8.dp))
+                        Switch(checked = uiState.isStrumMode, onCheckedChange = { onStrumModeToggled() })
+                    }
+                }
+                // Estroboscopio: solo con una nota objetivo (no en modo canto)
+                if (uiState.selectedTuningModeName != FREE_SINGING_MODE_NAME) {
+                    Row(
+                        modifier = Modifier.fillMaxWidth(),
+                        verticalAlignment = Alignment.CenterVertically,
+                        horizontalArrangement = Arrangement.End
+                    ) {
+                        Text("Estroboscopio (precisión)", style = MaterialTheme.typography.bodyMedium)
+                        Spacer(modifier = Modifier.width(8.dp))
+                        Switch(checked = uiState.isStrobeMode, onCheckedChange = { onStrobeModeToggled() })
+                    }
+                }
+
                 Spacer(modifier = Modifier.height(16.dp))
 
+                if (uiState.isStrumMode) {
+                    StrumTuningPanel(strings = uiState.strumStrings, modifier = Modifier.weight(1f))
+                    return@Column
+                }
+                val strobeTarget = uiState.targetPitch
+                if (uiState.isStrobeMode && strobeTarget != null) {
+                    StrobeDisplay(target = strobeTarget, reading = uiState.strobe, modifier = Modifier.weight(1f))
+                    return@Column
+                }
+
                 val targetNoteStringToDisplay = when (uiState.selectedTuningModeName) {
                     FREE_SINGING_MODE_NAME -> uiState.displayedNoteName?.let { "$it${uiState.displayedOctave ?: ""}${uiState.outsideRangeIndicator ?: ""}" } ?: "--" // <- Constante actualizada
                     CHROMATIC_MODE_NAME -> uiState.targetPitch?.toString() ?: CHROMATIC_MODE_NAME // <- Constante actualizada
@@ -4,6 +4,7 @@ import android.Manifest
 import android.app.Application
 import android.content.pm.PackageManager
 import android.util.Log // Keep essential logs
+import android.view.Choreographer
 import androidx.annotation.Keep
 import androidx.core.app.ActivityCompat
 import androidx.lifecycle.AndroidViewModel
@@ -16,8 +17,11 @@ import com.isaacbegue.afinador.model.STANDARD_NOTES
 import com.isaacbegue.afinador.model.FREE_SINGING_MODE_NAME
 import com.isaacbegue.afinador.model.InstrumentTuning
 import com.isaacbegue.afinador.model.Tunings
+import kotlinx.coroutines.CoroutineScope
 import kotlinx.coroutines.Dispatchers
 import kotlinx.coroutines.Job
+import kotlinx.coroutines.SupervisorJob
+import kotlinx.coroutines.asCoroutineDispatcher
 import kotlinx.coroutines.delay
 import kotlinx.coroutines.flow.MutableStateFlow
 import kotlinx.coroutines.flow.SharingStarted
@@ -31,6 +35,10 @@ import kotlinx.coroutines.flow.update
 import kotlinx.coroutines.launch
 import kotlinx.coroutines.withContext
 import kotlinx.coroutines.isActive
+import java.io.File
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+import java.util.concurrent.Executors
 import kotlin.math.abs
 import kotlin.math.log2
 import kotlin.math.pow
@@ -38,8 +46,105 @@ import kotlin.math.roundToInt
 
 // --- Constants ---
 private const val SAMPLE_RATE = 44100
-// Increased buffer size for better low-frequency detection
-private const val BUFFER_SIZE = 2048 // Adjusted from 1024
+// Frames per Oboe callback. 0 lets the device use its burst size: the callback only feeds
+// the native ring buffer, so it no longer limits the analysis window.
+private const val BUFFER_SIZE = 0 // Adjusted from 2048
+// Analysis window and hop: ~46 ms at 44.1 kHz (down to ~43 Hz), updated every ~3 ms
+private const val ANALYSIS_WINDOW_SIZE = 2048
+private const val ANALYSIS_HOP_SIZE = 128
+// Low-register path: input decimated 8x (5.5 kHz) over 1024 samples (~186 ms), down to 20 Hz,
+// so low bass strings (B0, E1) are detected without a long full-rate window. 1 disables it.
+private const val LOW_REGISTER_DECIMATION = 8
+private const val LOW_REGISTER_WINDOW_SIZE = 1024
+// Input: default device, mono, analysed as one lane. The native engine takes several channels (one
+// lane each) and several instances; this screen tunes one instrument.
+private const val INPUT_DEVICE_ID = 0 // 0 = default input
+private const val INPUT_CHANNEL_COUNT = 1
+private const val TUNER_LANE = 0
+private const val INPUT_CAPTURE_SECONDS = 15.0f // Newest input kept by an input capture (native maximum)
+private val ANALYSED_CHANNELS = intArrayOf(0) // Input channel of each lane
+// YIN difference function backends (must match DifferenceMethod in NativeAudioEngine.cpp)
+private const val DIFFERENCE_METHOD_DIRECT = 0
+private const val DIFFERENCE_METHOD_FFT = 1 // O(N log N), same tau estimates as the direct loop
+// O(hop * tau) per hop: updates the previous window's curve, cheapest with a small hop
+private const val DIFFERENCE_METHOD_SLIDING = 2
+private const val DIFFERENCE_METHOD = DIFFERENCE_METHOD_SLIDING
+// Result delivery (must match ResultDelivery in NativeAudioEngine.cpp)
+private const val RESULT_DELIVERY_CALLBACK = 0
+private const val RESULT_DELIVERY_MAILBOX = 1 // Native fills a shared buffer, the UI polls it every frame
+private const val RESULT_DELIVERY = RESULT_DELIVERY_MAILBOX
+// Seqlock mailboxes (Mailbox in ResultMailbox.h): a sequence word, then the payload from
+// MAILBOX_PAYLOAD_OFFSET. readMailboxNative copies a consistent payload out.
+private const val MAILBOX_PAYLOAD_OFFSET = 8
+// Result payload (MailboxResult in ResultMailbox.h), native byte order
+private const val RESULT_PAYLOAD_SIZE_BYTES = 32
+private const val RESULT_PAYLOAD_NOTE_INDEX = 0
+private const val RESULT_PAYLOAD_OCTAVE = 4
+private const val RESULT_PAYLOAD_FREQUENCY = 8
+private const val RESULT_PAYLOAD_CENTS = 12
+private const val RESULT_PAYLOAD_CONFIDENCE = 16
+private const val RESULT_PAYLOAD_RMS = 20
+private const val RESULT_PAYLOAD_TIMESTAMP = 24
+private const val MAILBOX_SIZE_BYTES = MAILBOX_PAYLOAD_OFFSET + RESULT_PAYLOAD_SIZE_BYTES
+// Strum payload (native StrumPayload in ResultMailbox.h): header, then MAX_STRUM_STRINGS entries
+private const val MAX_STRUM_STRINGS = 12 // Must match MAX_STRUM_STRINGS in StrumAnalyzer.h
+private const val STRUM_PAYLOAD_STRING_COUNT = 0
+private const val STRUM_PAYLOAD_STRINGS = 24
+private const val STRUM_PAYLOAD_STRING_SIZE = 16
+private const val STRUM_PAYLOAD_SIZE_BYTES = STRUM_PAYLOAD_STRINGS + MAX_STRUM_STRINGS * STRUM_PAYLOAD_STRING_SIZE
+private const val STRUM_MAILBOX_SIZE_BYTES = MAILBOX_PAYLOAD_OFFSET + STRUM_PAYLOAD_SIZE_BYTES
+private const val STRUM_STRING_OFFSET_CENTS = 4
+private const val STRUM_STRING_OFFSET_FLAGS = 12
+private const val STRUM_STRING_DETECTED = 1
+private const val STRUM_STRING_SHARED = 2
+private const val STRUM_HOLD_MS = 3000L // A string keeps its last reading this long after it stops ringing
+// Strobe payload (native StrobePayload in ResultMailbox.h)
+private const val STROBE_MAX_HARMONICS = 4 // Must match STROBE_MAX_HARMONICS in StrobeAnalyzer.h
+private const val STROBE_PAYLOAD_FLAGS = 0
+private const val STROBE_PAYLOAD_CENTS = 12
+private const val STROBE_PAYLOAD_PHASE = 16
+private const val STROBE_PAYLOAD_PHASE_VELOCITY = 20
+private const val STROBE_PAYLOAD_BAND_COUNT = 32
+private const val STROBE_PAYLOAD_TIMESTAMP = 40
+private const val STROBE_PAYLOAD_BAND_LEVELS = 48
+private const val STROBE_PAYLOAD_SIZE_BYTES = STROBE_PAYLOAD_BAND_LEVELS + 4 * STROBE_MAX_HARMONICS
+private const val STROBE_MAILBOX_SIZE_BYTES = MAILBOX_PAYLOAD_OFFSET + STROBE_PAYLOAD_SIZE_BYTES
+private const val STROBE_MAILBOX_LOCKED = 2
+private const val STROBE_CENTS_IN_TUNE_THRESHOLD = 1.0f // Strobe readings are for fine work
+// Engine metrics snapshot layout (must match EngineMetrics.h)
+private const val METRICS_SAMPLE_RATE = 0
+private const val METRICS_FRAMES_PER_BURST = 1
+private const val METRICS_FRAMES_PER_CALLBACK = 2
+private const val METRICS_BUFFER_SIZE_FRAMES = 3
+private const val METRICS_SHARING_MODE = 4
+private const val METRICS_AUDIO_API = 5
+private const val METRICS_XRUN_COUNT = 6
+private const val METRICS_DROPPED_INPUT_FRAMES = 7
+private const val METRICS_SKIPPED_BACKLOGS = 8
+private const val METRICS_GATED_WINDOWS = 9
+private const val METRICS_DETECTED_WINDOWS = 10
+private const val METRICS_REJECTED_WINDOWS = 11
+private const val METRICS_APERIODIC_WINDOWS = 12
+private const val METRICS_LOCAL_SEARCH_WINDOWS = 13
+private const val METRICS_CALLBACK_HISTOGRAM = 14
+private const val METRICS_ANALYSIS_HISTOGRAM = 36
+private const val METRICS_SCHEDULER_STATE = 58
+private const val METRICS_FULL_ANALYSIS_RATE_MILLIHZ = 59
+private const val METRICS_ANALYSIS_RATE_MILLIHZ = 60
+private const val METRICS_DUTY_CYCLED_HOPS = 61
+private const val METRICS_CPU_SAVED_NANOS = 62
+private const val METRICS_FIELD_COUNT = 63
+private const val HISTOGRAM_COUNT = 0
+private const val HISTOGRAM_TOTAL_NANOS = 1
+private const val HISTOGRAM_MAX_NANOS = 2
+private const val HISTOGRAM_TOTAL_BUDGET_NANOS = 3
+private const val HISTOGRAM_PEAK_LOAD_PERMILLE = 4
+private const val HISTOGRAM_BUCKETS = 6
+const val LATENCY_HISTOGRAM_BUCKETS = 16 // Bucket b holds durations in [2^b, 2^(b+1)) microseconds
+
+// Narrowed native search: expected pitches +/- this many semitones (full scan when nothing fits)
+private const val CANDIDATE_RANGE_SEMITONES = 3
+private const val MAX_CANDIDATE_RANGES = 16 // Must match MAX_CANDIDATE_RANGES in YinDetector.h
 private const val MIN_VALID_FREQUENCY = 20.0f
 private const val CENTS_IN_TUNE_THRESHOLD = 10.0f
 private const val CENTS_RANGE_FOR_VISUALIZER = 50.0f // Visual range +/- 50 cents
@@ -68,7 +173,105 @@ data class TunerUiState(
     val tuningHistory: List<Pair<Long, Float?>> = emptyList(),
     val isGraphCenteringDynamic: Boolean = false,
     val hasAudioPermission: Boolean = false,
-    val isRecording: Boolean = false
+    val isRecording: Boolean = false,
+    val isStrumMode: Boolean = false, // Instrument modes only: all strings from one strum
+    val strumStrings: List<StringTuning> = emptyList(),
+    val isStrobeMode: Boolean = false, // Phase tracking at the selected target instead of detection
+    val strobe: StrobeReading? = null  // Latest strobe reading, null until the first one
+)
+
+// --- Strobe Mode: latest reading at the selected target ---
+data class StrobeReading(
+    val isLocked: Boolean,
+    val centsOffset: Float?,  // Versus the target; null until locked
+    val phase: Float,         // Strobe position of the fundamental, radians
+    val phaseVelocity: Float, // radians/s, 0 until locked
+    val timestampNanos: Long, // System.nanoTime base, to extrapolate the phase between frames
+    val bandLevels: List<Float>, // One per band (target x 1, 2, ...), amplitude over the input RMS
+    val isTuned: Boolean = false
+)
+
+// --- Strum Mode: latest reading of one string ---
+data class StringTuning(
+    val pitch: Pitch,
+    val centsOffset: Float? = null, // Versus the string's target; null until it is heard
+    val isTuned: Boolean = false,
+    val isShared: Boolean = false, // Every partial overlaps another string's, so the reading is approximate
+    val lastHeardMillis: Long = 0L
+)
+
+// --- Native Result (as published in the result mailbox) ---
+data class NativeResult(
+    val noteIndex: Int,
+    val octave: Int,
+    val frequencyHz: Float,
+    val centsOffset: Float,
+    val confidence: Float,
+    val rms: Float,
+    val timestampNanos: Long
+)
+
+// --- Engine Metrics (snapshot from the native engine, for diagnostics) ---
+data class LatencyStats(
+    val count: Long,
+    val meanMicros: Float,
+    val maxMicros: Float,
+    val load: Float,     // Total processing time / total deadline
+    val peakLoad: Float, // Worst single duration / its deadline
+    val buckets: List<Long>
+) {
+    // Upper bound in microseconds of the histogram bucket holding the given fraction of samples
+    fun percentileMicros(fraction: Float): Long {
+        val rank = (count * fraction).toLong().coerceIn(1L, maxOf(count, 1L))
+        var seen = 0L
+        buckets.forEachIndexed { bucket, bucketCount ->
+            seen += bucketCount
+            if (seen >= rank) return 1L shl (bucket + 1)
+        }
+        return 1L shl LATENCY_HISTOGRAM_BUCKETS
+    }
+}
+
+data class EngineMetrics(
+    val sampleRate: Int,
+    val framesPerBurst: Int,
+    val framesPerCallback: Int, // 0 = device burst
+    val bufferSizeFrames: Int,
+    val isSharedStream: Boolean,
+    val isAAudio: Boolean,
+    val xRunCount: Int, // -1 when the audio API does not report xruns
+    val droppedInputFrames: Long,
+    val skippedBacklogs: Long,
+    val gatedWindows: Long, // Below the adaptive noise gate
+    val aperiodicWindows: Long, // Stopped by the periodicity pre-check before YIN
+    val detectedWindows: Long,
+    val localSearchWindows: Long, // Of detectedWindows, found by searching around the held note only
+    val rejectedWindows: Long,
+    val callback: LatencyStats,
+    val analysis: LatencyStats,
+    val schedulerState: SchedulerState,
+    val fullAnalysisRateHz: Float,  // One window per hop
+    val analysisRateHz: Float,      // Current rate set by the duty cycle
+    val dutyCycledHops: Long,       // Hops that entered the window without being analysed
+    val cpuSavedMillis: Float       // Estimated analysis time the duty cycle saved
+) {
+    // Windows analysed per second over the whole run
+    val averageAnalysisRateHz: Float
+        get() {
+            val hops = analysis.count + dutyCycledHops
+            return if (hops > 0) fullAnalysisRateHz * analysis.count / hops else fullAnalysisRateHz
+        }
+}
+
+// --- Duty Cycle (mirrors SchedulerState and DutyCyclePolicy in AnalysisScheduler.h) ---
+enum class SchedulerState { FULL, SILENT, HELD }
+
+data class DutyCyclePolicy(
+    val enabled: Boolean = true,
+    val silentInterval: Int = 8,     // Hops per analysed window during silence
+    val heldInterval: Int = 4,       // Hops per analysed window while a note is held
+    val heldCents: Float = 1.0f,     // A held note stays within this of where it settled
+    val settleSeconds: Float = 0.25f // Silence or a steady note this long before the rate drops
 )
 
 // --- ViewModel ---
@@ -90,6 +293,57 @@ class TunerViewModel(application: Application) : AndroidViewModel(application) {
     private var noDetectionJob: Job? = null
     private var startJob: Job? = null
     private var lastDetectedMidiNote: Int? = null
+    // Lower analysis rate during silence and held notes, for long sessions on battery
+    private var dutyCyclePolicy = DutyCyclePolicy()
+
+    // Native engine instance owned by this ViewModel (0 if the library failed to load)
+    private val engineHandle: Long = try {
+        createNativeEngine()
+    } catch (t: Throwable) {
+        Log.e("TunerViewModel", "Failed to create native engine", t)
+        0L
+    }
+    // Every call that starts, stops, configures or destroys the engine runs on this one thread, in
+    // the order it was queued: a JNI call cannot be cancelled, so this is what keeps destroy from
+    // freeing the engine under a start or stop still in progress. Not tied to viewModelScope, so
+    // the stop and destroy queued by onCleared still run.
+    private val engineDispatcher = Executors.newSingleThreadExecutor { Thread(it, "TunerEngineControl") }
+        .asCoroutineDispatcher()
+    private val engineScope = CoroutineScope(SupervisorJob() + engineDispatcher)
+    // Set on the main thread by onCleared, before destroy is queued: main-thread reads check it
+    // directly, queued engine calls check it when they run
+    @Volatile private var engineReleased = false
+
+    // Shared with the native engine in mailbox delivery mode, one mailbox per lane (8-byte aligned by ART)
+    private val resultMailbox: ByteBuffer =
+        ByteBuffer.allocateDirect(MAILBOX_SIZE_BYTES).order(ByteOrder.nativeOrder())
+    private var lastMailboxSequence = 0
+    private val resultPayload = ByteArray(RESULT_PAYLOAD_SIZE_BYTES)
+    private val resultPayloadView: ByteBuffer = ByteBuffer.wrap(resultPayload).order(ByteOrder.nativeOrder())
+    // Strum mode results, published by native as one batch whatever RESULT_DELIVERY is
+    private val strumMailbox: ByteBuffer =
+        ByteBuffer.allocateDirect(STRUM_MAILBOX_SIZE_BYTES).order(ByteOrder.nativeOrder())
+    private var lastStrumMailboxSequence = 0
+    private val strumPayload = ByteArray(STRUM_PAYLOAD_SIZE_BYTES)
+    private val strumPayloadView: ByteBuffer = ByteBuffer.wrap(strumPayload).order(ByteOrder.nativeOrder())
+    // Strobe mode readings, likewise published by native whatever RESULT_DELIVERY is
+    private val strobeMailbox: ByteBuffer =
+        ByteBuffer.allocateDirect(STROBE_MAILBOX_SIZE_BYTES).order(ByteOrder.nativeOrder())
+    private var lastStrobeMailboxSequence = 0
+    private val strobePayload = ByteArray(STROBE_PAYLOAD_SIZE_BYTES)
+    private val strobePayloadView: ByteBuffer = ByteBuffer.wrap(strobePayload).order(ByteOrder.nativeOrder())
+    private var isPollingMailbox = false
+    private val mailboxFrameCallback = object : Choreographer.FrameCallback {
+        override fun doFrame(frameTimeNanos: Long) {
+            if (!isPollingMailbox) return
+            if (RESULT_DELIVERY == RESULT_DELIVERY_MAILBOX) {
+                readResultMailbox()?.let { processNativeResult(it.noteIndex, it.octave, it.centsOffset) }
+            }
+            readStrumMailbox()?.let { processStrumResult(it) }
+            readStrobeMailbox()?.let { processStrobeResult(it) }
+            Choreographer.getInstance().postFrameCallback(this)
+        }
+    }
 
 
     init {
@@ -151,22 +405,36 @@ class TunerViewModel(application: Application) : AndroidViewModel(application) {
         }
         if (!_uiState.value.hasAudioPermission) { _uiState.update { it.copy(hasAudioPermission = true)} }
 
-        startJob = viewModelScope.launch(Dispatchers.IO) {
-            Log.i("TunerViewModel", "[IO Thread] Requesting to start native audio engine...")
-            setA4Native(_uiState.value.a4Frequency)
+        // Queued ahead of the start, so the first run already has them
+        val a4Frequency = _uiState.value.a4Frequency
+        onEngine { setA4Native(it, a4Frequency) }
+        updateCandidateRanges()
+        updateStrumStrings()
+        updateStrobeTarget()
+        updateDutyCycle()
+        startJob = engineScope.launch {
+            if (engineReleased) return@launch
+            Log.i("TunerViewModel", "[Engine Thread] Requesting to start native audio engine...")
             // Pass the updated BUFFER_SIZE constant here
             val started = try {
-                startNativeAudioEngine(SAMPLE_RATE, BUFFER_SIZE)
+                startNativeAudioEngine(
+                    engineHandle, INPUT_DEVICE_ID, SAMPLE_RATE, BUFFER_SIZE, DIFFERENCE_METHOD, ANALYSIS_WINDOW_SIZE,
+                    ANALYSIS_HOP_SIZE, LOW_REGISTER_DECIMATION, LOW_REGISTER_WINDOW_SIZE, INPUT_CHANNEL_COUNT,
+                    ANALYSED_CHANNELS, RESULT_DELIVERY, resultMailbox, strumMailbox, strobeMailbox
+                )
             } catch (e: Throwable) {
-                Log.e("TunerViewModel", "[IO Thread] Error starting engine", e)
+                Log.e("TunerViewModel", "[Engine Thread] Error starting engine", e)
                 false
             }
 
             if (started) {
-                Log.i("TunerViewModel", "[IO Thread] Native engine started successfully.")
-                withContext(Dispatchers.Main) { _uiState.update { it.copy(isRecording = true) } }
+                Log.i("TunerViewModel", "[Engine Thread] Native engine started successfully.")
+                withContext(Dispatchers.Main) {
+                    _uiState.update { it.copy(isRecording = true) }
+                    startMailboxPolling()
+                }
             } else {
-                Log.e("TunerViewModel", "[IO Thread] Failed to start native engine.")
+                Log.e("TunerViewModel", "[Engine Thread] Failed to start native engine.")
                 withContext(Dispatchers.Main) {
                     _uiState.update { it.copy(isRecording = false, hasAudioPermission = checkPermission()) }
                 }
@@ -193,25 +461,37 @@ class TunerViewModel(application: Application) : AndroidViewModel(application) {
         if (!_uiState.value.isRecording) {
             Log.w("TunerViewModel", "Stop ignored: Engine not recording.")
             // Still attempt to stop native engine just in case it's in a weird state
-            viewModelScope.launch(Dispatchers.IO) { tryStopNativeEngine() }
+            engineScope.launch { tryStopNativeEngine() }
             return
         }
 
         Log.i("TunerViewModel", "Stopping audio processing...")
         _uiState.update { it.copy(isRecording = false) }
-        viewModelScope.launch(Dispatchers.IO) { tryStopNativeEngine() }
+        stopMailboxPolling()
+        engineScope.launch { tryStopNativeEngine() } // After a start still in progress
 
         resetDetectionState()
         cancelNoDetectionTimer()
     }
 
-    private suspend fun tryStopNativeEngine() {
+    // Engine thread only.
+    private fun tryStopNativeEngine() {
+        if (engineReleased) return // destroyNativeEngine stops it
         try {
-            Log.i("TunerViewModel", "[IO Thread] Requesting to stop native audio engine...")
-            stopNativeAudioEngine()
-            Log.i("TunerViewModel", "[IO Thread] Native engine stop requested.")
+            Log.i("TunerViewModel", "[Engine Thread] Requesting to stop native audio engine...")
+            stopNativeAudioEngine(engineHandle)
+            Log.i("TunerViewModel", "[Engine Thread] Native engine stop requested.")
         } catch (t: Throwable) {
-            Log.e("TunerViewModel", "[IO Thread] Error stopping native engine", t)
+            Log.e("TunerViewModel", "[Engine Thread] Error stopping native engine", t)
+        }
+    }
+
+    // Queues a call on the engine thread, behind any start or stop already queued. Dropped once
+    // the engine is released.
+    private fun onEngine(call: (handle: Long) -> Unit) {
+        if (engineHandle == 0L || engineReleased) return
+        engineScope.launch {
+            if (!engineReleased) call(engineHandle)
         }
     }
 
@@ -223,8 +503,11 @@ class TunerViewModel(application: Application) : AndroidViewModel(application) {
             _uiState.update { it.copy(a4Frequency = clampedFreq) }
             // Update native engine only if it's running or starting
             if (_uiState.value.isRecording || startJob?.isActive == true) {
-                setA4Native(clampedFreq)
+                onEngine { setA4Native(it, clampedFreq) }
             }
+            updateCandidateRanges() // Ranges are in Hz, so they follow A4
+            updateStrumStrings()
+            updateStrobeTarget()
         }
     }
 
@@ -241,6 +524,8 @@ class TunerViewModel(application: Application) : AndroidViewModel(application) {
             // Reset display immediately when target changes manually
             cancelNoDetectionTimer()
             resetDetectionState(keepTarget = true)
+            updateCandidateRanges()
+            updateStrobeTarget() // In strobe mode the new target is tracked right away
         }
     }
 
@@ -284,15 +569,108 @@ class TunerViewModel(application: Application) : AndroidViewModel(application) {
 
         // Update state in one go
         _uiState.update {
+            val keepStrumMode = it.isStrumMode && isInstrumentMode
             it.copy(
                 selectedTuningModeName = modeName,
                 targetPitch = initialPitchForMode, // Use the determined target
-                isGraphCenteringDynamic = isDynamicCentering
+                isGraphCenteringDynamic = isDynamicCentering,
+                isStrumMode = keepStrumMode,
+                strumStrings = if (keepStrumMode) selectedTuning?.pitches.orEmpty().map { pitch -> StringTuning(pitch) } else emptyList()
             )
         }
 
         resetDetectionState(keepTarget = initialPitchForMode != null) // Reset display, keep target if mode has one
         cancelNoDetectionTimer()
+        updateCandidateRanges()
+        updateStrumStrings()
+        updateStrobeTarget()
+    }
+
+    // Tells the native detector which pitches to expect: every string in instrument modes, the
+    // target in chromatic mode, nothing (full range) when singing. Safe while the engine is stopped.
+    private fun updateCandidateRanges() {
+        val state = _uiState.value
+        val expectedPitches = when (state.selectedTuningModeName) {
+            FREE_SINGING_MODE_NAME -> emptyList()
+            CHROMATIC_MODE_NAME -> listOfNotNull(state.targetPitch)
+            else -> Tunings.ALL_TUNINGS.find { it.name == state.selectedTuningModeName }?.pitches ?: emptyList()
+        }
+        val spread = TWELFTH_ROOT_OF_TWO.pow(CANDIDATE_RANGE_SEMITONES)
+        val ranges = expectedPitches.take(MAX_CANDIDATE_RANGES).flatMap { pitch ->
+            val frequency = calculateFrequency(pitch, state.a4Frequency)
+            listOf(frequency / spread, frequency * spread)
+        }.toFloatArray()
+        onEngine { setCandidateRangesNative(it, TUNER_LANE, ranges) }
+    }
+
+    // Strum mode: tune every string of the selected instrument from one strummed chord.
+    fun toggleStrumMode() {
+        val state = _uiState.value
+        val tuning = Tunings.ALL_TUNINGS.find { it.name == state.selectedTuningModeName }
+        if (!state.isStrumMode && (tuning == null || tuning.pitches.isEmpty())) return // Instrument modes only
+        _uiState.update {
+            it.copy(
+                isStrumMode = !it.isStrumMode,
+                strumStrings = if (it.isStrumMode) emptyList() else tuning?.pitches.orEmpty().map { pitch -> StringTuning(pitch) },
+                isStrobeMode = it.isStrobeMode && it.isStrumMode, // The two modes are exclusive
+                strobe = null
+            )
+        }
+        resetDetectionState(keepTarget = true)
+        updateStrumStrings()
+        updateStrobeTarget()
+    }
+
+    // Hands the strings of the selected instrument to the native strum analysis (empty: single-note
+    // mode). Safe while the engine is stopped.
+    private fun updateStrumStrings() {
+        val state = _uiState.value
+        val frequencies = if (state.isStrumMode) {
+            state.strumStrings.take(MAX_STRUM_STRINGS).map { calculateFrequency(it.pitch, state.a4Frequency) }.toFloatArray()
+        } else {
+            FloatArray(0)
+        }
+        onEngine { setStrumStringsNative(it, TUNER_LANE, frequencies) }
+    }
+
+    // Strobe mode: sub-cent reading against the selected target (setTargetPitch picks what is tracked).
+    fun toggleStrobeMode() {
+        _uiState.update {
+            it.copy(
+                isStrobeMode = !it.isStrobeMode,
+                isStrumMode = false,
+                strumStrings = emptyList(),
+                strobe = null
+            )
+        }
+        resetDetectionState(keepTarget = true)
+        updateStrumStrings()
+        updateStrobeTarget()
+    }
+
+    // Hands the selected target to the native strobe analysis (0 Hz: single-note detection). The
+    // previous reading belongs to the old target, so it is dropped. Safe while the engine is stopped.
+    private fun updateStrobeTarget() {
+        val state = _uiState.value
+        val target = state.targetPitch
+        val frequency = if (state.isStrobeMode && target != null) calculateFrequency(target, state.a4Frequency) else 0.0f
+        if (state.strobe != null) _uiState.update { it.copy(strobe = null) }
+        onEngine { setStrobeTargetNative(it, TUNER_LANE, frequency) }
+    }
+
+    fun setDutyCyclePolicy(policy: DutyCyclePolicy) {
+        dutyCyclePolicy = policy
+        updateDutyCycle() // Taken up by the running engine before its next hop
+    }
+
+    private fun updateDutyCycle() {
+        val policy = dutyCyclePolicy
+        onEngine {
+            setDutyCycleNative(
+                it, TUNER_LANE, policy.enabled, policy.silentInterval, policy.heldInterval, policy.heldCents,
+                policy.settleSeconds
+            )
+        }
     }
 
     fun toggleMicrotoneDisplay() {
@@ -303,7 +681,16 @@ class TunerViewModel(application: Application) : AndroidViewModel(application) {
     // --- Native Callback Processing ---
 
     @Keep // Ensure Proguard doesn't remove this method called from JNI
-    private fun onNativeResult(noteIndex: Int, octave: Int, centsOffsetVsDetectedChromatic: Float) {
+    private fun onNativeResult(lane: Int, noteIndex: Int, octave: Int, centsOffsetVsDetectedChromatic: Float) {
+        // Callback delivery: invoked on a native analysis worker for every analysed window
+        if (lane != TUNER_LANE) return
+        viewModelScope.launch(Dispatchers.Main) {
+            processNativeResult(noteIndex, octave, centsOffsetVsDetectedChromatic)
+        }
+    }
+
+    // Applies one native detection result to the UI state. Main thread only.
+    private fun processNativeResult(noteIndex: Int, octave: Int, centsOffsetVsDetectedChromatic: Float) {
         val currentTime = System.currentTimeMillis()
         val currentFrameMidiNote = if (noteIndex != NOTE_INDEX_NOT_AVAILABLE && octave != OCTAVE_NOT_AVAILABLE) {
             noteIndex + (octave + 1) * 12
@@ -313,123 +700,277 @@ class TunerViewModel(application: Application) : AndroidViewModel(application) {
         lastDetectedMidiNote = currentFrameMidiNote // Update class property (use with caution)
         val offsetAvailable = abs(centsOffsetVsDetectedChromatic - CENTS_NOT_AVAILABLE) > 1e-5
 
-        viewModelScope.launch(Dispatchers.Main) {
-            val stateAtStart = _uiState.value // Capture state at coroutine start for consistency
-
-            // --- Auto-Select Target Pitch for Instrument Modes ---
-            val currentTuning = Tunings.ALL_TUNINGS.find { it.name == stateAtStart.selectedTuningModeName }
-            val isInstrumentModeAutoSelect = currentTuning != null &&
-                    stateAtStart.selectedTuningModeName != CHROMATIC_MODE_NAME &&
-                    stateAtStart.selectedTuningModeName != FREE_SINGING_MODE_NAME
-
-            // Use the state's target pitch captured at the start for consistency within this execution
-            var targetForCalculation: Pitch? = stateAtStart.targetPitch
-
-            if (isInstrumentModeAutoSelect && currentFrameMidiNote != null && currentTuning != null) {
-                var closestPitch: Pitch? = null
-                var minSemitoneDiff = Int.MAX_VALUE
-
-                if (!currentTuning.pitches.isNullOrEmpty()) {
-                    currentTuning.pitches.forEach { stringPitch ->
-                        val stringMidiNote = getMidiNoteFromPitch(stringPitch)
-                        if (stringMidiNote != null) {
-                            val diff = abs(currentFrameMidiNote - stringMidiNote)
-                            if (diff < minSemitoneDiff) {
-                                minSemitoneDiff = diff
-                                closestPitch = stringPitch
-                            }
+        val stateAtStart = _uiState.value // Capture state once for consistency
+
+        // --- Auto-Select Target Pitch for Instrument Modes ---
+        val currentTuning = Tunings.ALL_TUNINGS.find { it.name == stateAtStart.selectedTuningModeName }
+        val isInstrumentModeAutoSelect = currentTuning != null &&
+                stateAtStart.selectedTuningModeName != CHROMATIC_MODE_NAME &&
+                stateAtStart.selectedTuningModeName != FREE_SINGING_MODE_NAME
+
+        // Use the state's target pitch captured at the start for consistency within this execution
+        var targetForCalculation: Pitch? = stateAtStart.targetPitch
+
+        if (isInstrumentModeAutoSelect && currentFrameMidiNote != null && currentTuning != null) {
+            var closestPitch: Pitch? = null
+            var minSemitoneDiff = Int.MAX_VALUE
+
+            if (!currentTuning.pitches.isNullOrEmpty()) {
+                currentTuning.pitches.forEach { stringPitch ->
+                    val stringMidiNote = getMidiNoteFromPitch(stringPitch)
+                    if (stringMidiNote != null) {
+                        val diff = abs(currentFrameMidiNote - stringMidiNote)
+                        if (diff < minSemitoneDiff) {
+                            minSemitoneDiff = diff
+                            closestPitch = stringPitch
                         }
                     }
                 }
+            }
 
-                // Auto-select if close enough and different from current target
-                if (minSemitoneDiff <= AUTO_SELECT_SEMITONE_THRESHOLD && closestPitch != stateAtStart.targetPitch) {
-                    Log.d("TunerViewModel", "Auto-selecting target: $closestPitch (Detected MIDI: ${currentFrameMidiNote}, String MIDI: ${getMidiNoteFromPitch(closestPitch!!)}, Diff: $minSemitoneDiff)")
-                    targetForCalculation = closestPitch
-                    // Only update the state's target pitch here if it changed via auto-select
-                    if (stateAtStart.targetPitch != targetForCalculation) {
-                        _uiState.update { it.copy(targetPitch = targetForCalculation) }
-                    }
+            // Auto-select if close enough and different from current target
+            if (minSemitoneDiff <= AUTO_SELECT_SEMITONE_THRESHOLD && closestPitch != stateAtStart.targetPitch) {
+                Log.d("TunerViewModel", "Auto-selecting target: $closestPitch (Detected MIDI: ${currentFrameMidiNote}, String MIDI: ${getMidiNoteFromPitch(closestPitch!!)}, Diff: $minSemitoneDiff)")
+                targetForCalculation = closestPitch
+                // Only update the state's target pitch here if it changed via auto-select
+                if (stateAtStart.targetPitch != targetForCalculation) {
+                    _uiState.update { it.copy(targetPitch = targetForCalculation) }
                 }
             }
-            // --- End Auto-Select ---
-
-            val noteDetected = currentFrameMidiNote != null
-            cancelNoDetectionTimer() // Cancel any pending reset timer
-
-            if (noteDetected && offsetAvailable) {
-                val detectedPitch = getPitchFromMidiNote(currentFrameMidiNote!!)!!
-                val a4 = stateAtStart.a4Frequency
-                val detectedExactFreq = calculateFrequency(detectedPitch, a4) * TWELFTH_ROOT_OF_TWO.pow(centsOffsetVsDetectedChromatic / 100f)
-
-                var finalNoteName: String? = detectedPitch.noteName
-                var finalOctave: Int? = detectedPitch.octave
-                var rangeIndicator: String? = null
-                var finalCentsOffset = centsOffsetVsDetectedChromatic // Default for Canto mode
-                var valueForHistory = centsOffsetVsDetectedChromatic  // Default for Canto mode
-
-                // Recalculate offset relative to target for Instrument/Chromatic modes
-                if (!stateAtStart.isGraphCenteringDynamic && targetForCalculation != null) {
-                    val targetMidiNote = getMidiNoteFromPitch(targetForCalculation)
-                    val targetFreq = calculateFrequency(targetForCalculation, a4)
-
-                    if (targetMidiNote != null && targetFreq > 1e-6f && detectedExactFreq > 1e-6f) {
-                        finalCentsOffset = 1200.0f * log2(detectedExactFreq / targetFreq)
-                        valueForHistory = finalCentsOffset // Use offset vs target for history in these modes
-
-                        // Adjust displayed note if too far from target (Instrument/Chromatic only)
-                        val deltaSemitones = currentFrameMidiNote - targetMidiNote
-                        when {
-                            deltaSemitones > DISPLAY_NOTE_BOUNDARY_SEMITONES -> {
-                                val boundaryPitch = getPitchFromMidiNote(targetMidiNote + DISPLAY_NOTE_BOUNDARY_SEMITONES)
-                                finalNoteName = boundaryPitch?.noteName; finalOctave = boundaryPitch?.octave; rangeIndicator = "+"
-                            }
-                            deltaSemitones < -DISPLAY_NOTE_BOUNDARY_SEMITONES -> {
-                                val boundaryPitch = getPitchFromMidiNote(targetMidiNote - DISPLAY_NOTE_BOUNDARY_SEMITONES)
-                                finalNoteName = boundaryPitch?.noteName; finalOctave = boundaryPitch?.octave; rangeIndicator = "-"
-                            }
-                            else -> {
-                                // Display the actually detected note if within range
-                                finalNoteName = detectedPitch.noteName; finalOctave = detectedPitch.octave; rangeIndicator = null
-                            }
+        }
+        // --- End Auto-Select ---
+
+        val noteDetected = currentFrameMidiNote != null
+        cancelNoDetectionTimer() // Cancel any pending reset timer
+
+        if (noteDetected && offsetAvailable) {
+            val detectedPitch = getPitchFromMidiNote(currentFrameMidiNote!!)!!
+            val a4 = stateAtStart.a4Frequency
+            val detectedExactFreq = calculateFrequency(detectedPitch, a4) * TWELFTH_ROOT_OF_TWO.pow(centsOffsetVsDetectedChromatic / 100f)
+
+            var finalNoteName: String? = detectedPitch.noteName
+            var finalOctave: Int? = detectedPitch.octave
+            var rangeIndicator: String? = null
+            var finalCentsOffset = centsOffsetVsDetectedChromatic // Default for Canto mode
+            var valueForHistory = centsOffsetVsDetectedChromatic  // Default for Canto mode
+
+            // Recalculate offset relative to target for Instrument/Chromatic modes
+            if (!stateAtStart.isGraphCenteringDynamic && targetForCalculation != null) {
+                val targetMidiNote = getMidiNoteFromPitch(targetForCalculation)
+                val targetFreq = calculateFrequency(targetForCalculation, a4)
+
+                if (targetMidiNote != null && targetFreq > 1e-6f && detectedExactFreq > 1e-6f) {
+                    finalCentsOffset = 1200.0f * log2(detectedExactFreq / targetFreq)
+                    valueForHistory = finalCentsOffset // Use offset vs target for history in these modes
+
+                    // Adjust displayed note if too far from target (Instrument/Chromatic only)
+                    val deltaSemitones = currentFrameMidiNote - targetMidiNote
+                    when {
+                        deltaSemitones > DISPLAY_NOTE_BOUNDARY_SEMITONES -> {
+                            val boundaryPitch = getPitchFromMidiNote(targetMidiNote + DISPLAY_NOTE_BOUNDARY_SEMITONES)
+                            finalNoteName = boundaryPitch?.noteName; finalOctave = boundaryPitch?.octave; rangeIndicator = "+"
+                        }
+                        deltaSemitones < -DISPLAY_NOTE_BOUNDARY_SEMITONES -> {
+                            val boundaryPitch = getPitchFromMidiNote(targetMidiNote - DISPLAY_NOTE_BOUNDARY_SEMITONES)
+                            finalNoteName = boundaryPitch?.noteName; finalOctave = boundaryPitch?.octave; rangeIndicator = "-"
+                        }
+                        else -> {
+                            // Display the actually detected note if within range
+                            finalNoteName = detectedPitch.noteName; finalOctave = detectedPitch.octave; rangeIndicator = null
                         }
-                    } else {
-                        // Fallback if target frequency calculation fails (shouldn't happen often)
-                        Log.w("TunerViewModel", "WARN: Fallback offset calculation used for non-dynamic mode!")
-                        finalCentsOffset = centsOffsetVsDetectedChromatic
-                        valueForHistory = centsOffsetVsDetectedChromatic
                     }
+                } else {
+                    // Fallback if target frequency calculation fails (shouldn't happen often)
+                    Log.w("TunerViewModel", "WARN: Fallback offset calculation used for non-dynamic mode!")
+                    finalCentsOffset = centsOffsetVsDetectedChromatic
+                    valueForHistory = centsOffsetVsDetectedChromatic
                 }
+            }
 
-                val normalizedValueForHistory = (valueForHistory / CENTS_RANGE_FOR_VISUALIZER).coerceIn(-1.0f, 1.0f)
-                addHistoryPoint(normalizedValueForHistory, currentTime)
-                val isTuned = abs(finalCentsOffset) <= CENTS_IN_TUNE_THRESHOLD
+            val normalizedValueForHistory = (valueForHistory / CENTS_RANGE_FOR_VISUALIZER).coerceIn(-1.0f, 1.0f)
+            addHistoryPoint(normalizedValueForHistory, currentTime)
+            val isTuned = abs(finalCentsOffset) <= CENTS_IN_TUNE_THRESHOLD
 
-                // Update the UI state based on calculated values
-                _uiState.update {
-                    // Use the potentially auto-updated target from earlier logic
-                    it.copy(
-                        targetPitch = targetForCalculation,
-                        displayedNoteName = finalNoteName,
-                        displayedOctave = finalOctave,
-                        outsideRangeIndicator = rangeIndicator,
-                        centsOffset = finalCentsOffset,
-                        isNoteDetected = true,
-                        isTuned = isTuned
+            // Update the UI state based on calculated values
+            _uiState.update {
+                // Use the potentially auto-updated target from earlier logic
+                it.copy(
+                    targetPitch = targetForCalculation,
+                    displayedNoteName = finalNoteName,
+                    displayedOctave = finalOctave,
+                    outsideRangeIndicator = rangeIndicator,
+                    centsOffset = finalCentsOffset,
+                    isNoteDetected = true,
+                    isTuned = isTuned
+                )
+            }
+
+        } else { // No valid detection or offset wasn't available from native code
+            startNoDetectionTimer() // Start timer to potentially clear display
+            addHistoryPoint(null, currentTime) // Add gap to history
+            // Only update if state was previously showing detection
+            if (stateAtStart.isNoteDetected) {
+                _uiState.update { it.copy(isNoteDetected = false, isTuned = false) }
+            }
+        }
+    }
+
+    // --- Result Mailbox Polling (mailbox delivery mode) ---
+
+    private fun startMailboxPolling() {
+        if (isPollingMailbox) return
+        lastMailboxSequence = 0 // Native resets the mailboxes on every start
+        lastStrumMailboxSequence = 0
+        lastStrobeMailboxSequence = 0
+        isPollingMailbox = true
+        Choreographer.getInstance().postFrameCallback(mailboxFrameCallback)
+    }
+
+    private fun stopMailboxPolling() {
+        if (!isPollingMailbox) return
+        isPollingMailbox = false
+        Choreographer.getInstance().removeFrameCallback(mailboxFrameCallback)
+    }
+
+    // Latest result through the native seqlock read. Returns null when nothing new was published
+    // since the previous frame, or the writer kept updating (the next frame picks it up).
+    private fun readResultMailbox(): NativeResult? {
+        val sequence = readMailboxNative(resultMailbox, TUNER_LANE, lastMailboxSequence, resultPayload)
+        if (sequence == lastMailboxSequence) return null
+        lastMailboxSequence = sequence
+        return NativeResult(
+            noteIndex = resultPayloadView.getInt(RESULT_PAYLOAD_NOTE_INDEX),
+            octave = resultPayloadView.getInt(RESULT_PAYLOAD_OCTAVE),
+            frequencyHz = resultPayloadView.getFloat(RESULT_PAYLOAD_FREQUENCY),
+            centsOffset = resultPayloadView.getFloat(RESULT_PAYLOAD_CENTS),
+            confidence = resultPayloadView.getFloat(RESULT_PAYLOAD_CONFIDENCE),
+            rms = resultPayloadView.getFloat(RESULT_PAYLOAD_RMS),
+            timestampNanos = resultPayloadView.getLong(RESULT_PAYLOAD_TIMESTAMP)
+        )
+    }
+
+    // Latest strum batch through the native seqlock read. Returns the per-string entries as
+    // (flags, cents) pairs, or null when nothing new was published.
+    private fun readStrumMailbox(): List<Pair<Int, Float>>? {
+        val sequence = readMailboxNative(strumMailbox, TUNER_LANE, lastStrumMailboxSequence, strumPayload)
+        if (sequence == lastStrumMailboxSequence) return null
+        lastStrumMailboxSequence = sequence
+        val count = strumPayloadView.getInt(STRUM_PAYLOAD_STRING_COUNT).coerceIn(0, MAX_STRUM_STRINGS)
+        return List(count) { index ->
+            val offset = STRUM_PAYLOAD_STRINGS + index * STRUM_PAYLOAD_STRING_SIZE
+            strumPayloadView.getInt(offset + STRUM_STRING_OFFSET_FLAGS) to
+                    strumPayloadView.getFloat(offset + STRUM_STRING_OFFSET_CENTS)
+        }
+    }
+
+    // Applies one strum analysis: strings heard in it take the new reading, the others keep theirs
+    // for STRUM_HOLD_MS (high strings die away long before the low ones). Main thread only.
+    private fun processStrumResult(strings: List<Pair<Int, Float>>) {
+        val now = System.currentTimeMillis()
+        _uiState.update { state ->
+            if (!state.isStrumMode || strings.size != state.strumStrings.size) return@update state
+            state.copy(strumStrings = state.strumStrings.mapIndexed { index, current ->
+                val (flags, cents) = strings[index]
+                when {
+                    (flags and STRUM_STRING_DETECTED) != 0 -> current.copy(
+                        centsOffset = cents,
+                        isTuned = abs(cents) < CENTS_IN_TUNE_THRESHOLD,
+                        isShared = (flags and STRUM_STRING_SHARED) != 0,
+                        lastHeardMillis = now
                     )
+                    current.centsOffset != null && now - current.lastHeardMillis > STRUM_HOLD_MS -> StringTuning(current.pitch)
+                    else -> current
                 }
+            })
+        }
+    }
 
-            } else { // No valid detection or offset wasn't available from native code
-                startNoDetectionTimer() // Start timer to potentially clear display
-                addHistoryPoint(null, currentTime) // Add gap to history
-                // Only update if state was previously showing detection
-                if (stateAtStart.isNoteDetected) {
-                    _uiState.update { it.copy(isNoteDetected = false, isTuned = false) }
-                }
-            }
-        } // End coroutine launch
+    // Latest strobe reading through the native seqlock read. Returns null when nothing new was
+    // published.
+    private fun readStrobeMailbox(): StrobeReading? {
+        val sequence = readMailboxNative(strobeMailbox, TUNER_LANE, lastStrobeMailboxSequence, strobePayload)
+        if (sequence == lastStrobeMailboxSequence) return null
+        lastStrobeMailboxSequence = sequence
+        val isLocked = (strobePayloadView.getInt(STROBE_PAYLOAD_FLAGS) and STROBE_MAILBOX_LOCKED) != 0
+        val bandCount = strobePayloadView.getInt(STROBE_PAYLOAD_BAND_COUNT).coerceIn(0, STROBE_MAX_HARMONICS)
+        return StrobeReading(
+            isLocked = isLocked,
+            centsOffset = if (isLocked) strobePayloadView.getFloat(STROBE_PAYLOAD_CENTS) else null,
+            phase = strobePayloadView.getFloat(STROBE_PAYLOAD_PHASE),
+            phaseVelocity = strobePayloadView.getFloat(STROBE_PAYLOAD_PHASE_VELOCITY),
+            timestampNanos = strobePayloadView.getLong(STROBE_PAYLOAD_TIMESTAMP),
+            bandLevels = List(bandCount) { strobePayloadView.getFloat(STROBE_PAYLOAD_BAND_LEVELS + 4 * it) }
+        )
+    }
+
+    // Applies one strobe reading. Main thread only.
+    private fun processStrobeResult(reading: StrobeReading) {
+        _uiState.update { state ->
+            if (!state.isStrobeMode) return@update state
+            val cents = reading.centsOffset
+            state.copy(strobe = reading.copy(isTuned = cents != null && abs(cents) <= STROBE_CENTS_IN_TUNE_THRESHOLD))
+        }
     }
 
+    // --- Input Capture ---
+
+    // Records the raw microphone input of the next runs (the newest INPUT_CAPTURE_SECONDS) into
+    // 'file', for reproducing field reports on a host with afinador_replay. Null turns it off.
+    // Takes effect at the next start; the file is complete once the engine stops.
+    fun setInputCapture(file: File?) {
+        val path = file?.absolutePath
+        onEngine { setInputCaptureNative(it, path, INPUT_CAPTURE_SECONDS) }
+    }
+
+    // --- Engine Metrics ---
+
+    // Snapshot of the native engine's timing and counters; the values of the last run remain
+    // available after it stops. Null if the native side returned nothing usable.
+    fun readEngineMetrics(): EngineMetrics? {
+        if (engineReleased) return null // Main thread, like onCleared
+        val snapshot = getEngineMetricsNative(engineHandle, TUNER_LANE) ?: return null
+        if (snapshot.size != METRICS_FIELD_COUNT) return null
+        return EngineMetrics(
+            sampleRate = snapshot[METRICS_SAMPLE_RATE].toInt(),
+            framesPerBurst = snapshot[METRICS_FRAMES_PER_BURST].toInt(),
+            framesPerCallback = snapshot[METRICS_FRAMES_PER_CALLBACK].toInt(),
+            bufferSizeFrames = snapshot[METRICS_BUFFER_SIZE_FRAMES].toInt(),
+            isSharedStream = snapshot[METRICS_SHARING_MODE] == 1L, // oboe::SharingMode::Shared
+            isAAudio = snapshot[METRICS_AUDIO_API] == 2L,          // oboe::AudioApi::AAudio
+            xRunCount = snapshot[METRICS_XRUN_COUNT].toInt(),
+            droppedInputFrames = snapshot[METRICS_DROPPED_INPUT_FRAMES],
+            skippedBacklogs = snapshot[METRICS_SKIPPED_BACKLOGS],
+            gatedWindows = snapshot[METRICS_GATED_WINDOWS],
+            aperiodicWindows = snapshot[METRICS_APERIODIC_WINDOWS],
+            detectedWindows = snapshot[METRICS_DETECTED_WINDOWS],
+            localSearchWindows = snapshot[METRICS_LOCAL_SEARCH_WINDOWS],
+            rejectedWindows = snapshot[METRICS_REJECTED_WINDOWS],
+            callback = readLatencyStats(snapshot, METRICS_CALLBACK_HISTOGRAM),
+            analysis = readLatencyStats(snapshot, METRICS_ANALYSIS_HISTOGRAM),
+            schedulerState = SchedulerState.entries.getOrElse(snapshot[METRICS_SCHEDULER_STATE].toInt()) {
+                SchedulerState.FULL
+            },
+            fullAnalysisRateHz = snapshot[METRICS_FULL_ANALYSIS_RATE_MILLIHZ] / 1000f,
+            analysisRateHz = snapshot[METRICS_ANALYSIS_RATE_MILLIHZ] / 1000f,
+            dutyCycledHops = snapshot[METRICS_DUTY_CYCLED_HOPS],
+            cpuSavedMillis = snapshot[METRICS_CPU_SAVED_NANOS] / 1e6f
+        )
+    }
+
+    private fun readLatencyStats(snapshot: LongArray, offset: Int): LatencyStats {
+        val count = snapshot[offset + HISTOGRAM_COUNT]
+        val totalNanos = snapshot[offset + HISTOGRAM_TOTAL_NANOS]
+        val totalBudgetNanos = snapshot[offset + HISTOGRAM_TOTAL_BUDGET_NANOS]
+        val bucketStart = offset + HISTOGRAM_BUCKETS
+        return LatencyStats(
+            count = count,
+            meanMicros = if (count > 0) totalNanos / 1000f / count else 0f,
+            maxMicros = snapshot[offset + HISTOGRAM_MAX_NANOS] / 1000f,
+            load = if (totalBudgetNanos > 0) totalNanos.toFloat() / totalBudgetNanos else 0f,
+            peakLoad = snapshot[offset + HISTOGRAM_PEAK_LOAD_PERMILLE] / 1000f,
+            buckets = snapshot.copyOfRange(bucketStart, bucketStart + LATENCY_HISTOGRAM_BUCKETS).toList()
+        )
+    }
 
     // --- History, Timers, and State Reset ---
 
@@ -521,9 +1062,37 @@ class TunerViewModel(application: Application) : AndroidViewModel(application) {
 
 
     // --- JNI Declarations & Native Library Loading ---
-    private external fun startNativeAudioEngine(sampleRate: Int, bufferSize: Int): Boolean
-    private external fun stopNativeAudioEngine()
-    private external fun setA4Native(frequency: Float)
+    private external fun createNativeEngine(): Long // 0 on failure
+    private external fun destroyNativeEngine(handle: Long)
+    private external fun startNativeAudioEngine(
+        handle: Long,
+        deviceId: Int,
+        sampleRate: Int,
+        bufferSize: Int,
+        differenceMethod: Int,
+        windowSize: Int,
+        hopSize: Int,
+        lowRegisterDecimation: Int,
+        lowRegisterWindowSize: Int,
+        channelCount: Int,
+        channels: IntArray, // Input channel of each lane
+        resultDelivery: Int,
+        resultBuffer: ByteBuffer,
+        strumBuffer: ByteBuffer?,
+        strobeBuffer: ByteBuffer?
+    ): Boolean
+    private external fun stopNativeAudioEngine(handle: Long)
+    private external fun setA4Native(handle: Long, frequency: Float)
+    private external fun setCandidateRangesNative(handle: Long, lane: Int, ranges: FloatArray) // [min0, max0, min1, max1, ...] Hz
+    private external fun setStrumStringsNative(handle: Long, lane: Int, frequencies: FloatArray) // Hz, empty = single-note mode
+    private external fun setStrobeTargetNative(handle: Long, lane: Int, frequency: Float) // Hz, 0 = single-note mode
+    private external fun setDutyCycleNative(
+        handle: Long, lane: Int, enabled: Boolean, silentInterval: Int, heldInterval: Int, heldCents: Float,
+        settleSeconds: Float
+    )
+    private external fun setInputCaptureNative(handle: Long, path: String?, seconds: Float) // null = off
+    private external fun readMailboxNative(mailbox: ByteBuffer, lane: Int, lastSequence: Int, payload: ByteArray): Int
+    private external fun getEngineMetricsNative(handle: Long, lane: Int): LongArray? // METRICS_* layout
 
     companion object {
         init {
@@ -545,5 +1114,12 @@ class TunerViewModel(application: Application) : AndroidViewModel(application) {
         Log.i("TunerViewModel", "ViewModel cleared. Stopping audio processing.")
         stopAudioProcessing() // Ensure native engine is stopped
         cancelNoDetectionTimer() // Clean up any running timers
+        // Freed on the engine thread once the queued start or stop is done; nothing queued after
+        // this reaches the engine, and the thread ends with it
+        engineReleased = true
+        engineScope.launch {
+            if (engineHandle != 0L) destroyNativeEngine(engineHandle)
+            engineDispatcher.close()
+        }
     }
 }
\ No newline at end of file